@@ -0,0 +1,43 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/coroutine/all.hpp>
+
+void fibonacci( int n, long & result)
+{
+    if ( n < 2)
+    {
+        result = n;
+        return;
+    }
+    long x = 0, y = 0;
+    // fib(n-1) runs now, the rest of this function can be
+    // stolen by another worker
+    boost::coroutines::fork_join_pool::spawn(
+        boost::bind( fibonacci, n - 1, boost::ref( x) ) );
+    fibonacci( n - 2, y);
+    boost::coroutines::fork_join_pool::sync();
+    result = x + y;
+}
+
+int main()
+{
+    boost::coroutines::fork_join_pool pool;
+    for ( int i = 0; i < 10; ++i)
+    {
+        long result = 0;
+        pool.run( boost::bind( fibonacci, i, boost::ref( result) ) );
+        std::cout << result << " ";
+    }
+
+    std::cout << "\nDone" << std::endl;
+
+    return EXIT_SUCCESS;
+}
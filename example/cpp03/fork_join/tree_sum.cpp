@@ -0,0 +1,76 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/coroutine/all.hpp>
+
+#include "../asymmetric/tree.h"
+
+// sums the lengths of the leaf values; the left subtree is
+// forked, the right one is visited by the current task
+// raw pointers are passed to the children because the
+// reference count of node is not thread-safe
+class sum_visitor : public visitor
+{
+public:
+    std::size_t     result;
+
+    sum_visitor() :
+        result( 0)
+    {}
+
+    static void accept( node * n, sum_visitor & v)
+    { n->accept( v); }
+
+    void visit( branch & b)
+    {
+        sum_visitor l, r;
+        if ( b.left)
+            boost::coroutines::fork_join_pool::spawn(
+                boost::bind( & sum_visitor::accept, b.left.get(), boost::ref( l) ) );
+        if ( b.right) b.right->accept( r);
+        boost::coroutines::fork_join_pool::sync();
+        result = l.result + r.result;
+    }
+
+    void visit( leaf & l)
+    { result = l.value.size(); }
+};
+
+node::ptr_t create_tree( std::size_t depth, std::size_t & expected)
+{
+    if ( 0 == depth)
+    {
+        std::ostringstream os;
+        os << expected;
+        expected += os.str().size();
+        return leaf::create( os.str() );
+    }
+    node::ptr_t left( create_tree( depth - 1, expected) );
+    node::ptr_t right( create_tree( depth - 1, expected) );
+    return branch::create( left, right);
+}
+
+int main()
+{
+    std::size_t expected = 0;
+    node::ptr_t root( create_tree( 16, expected) );
+
+    sum_visitor v;
+    boost::coroutines::fork_join_pool pool;
+    pool.run( boost::bind( & sum_visitor::accept, root.get(), boost::ref( v) ) );
+    std::cout << "sum of leaf lengths: " << v.result
+              << " (expected " << expected << ")" << std::endl;
+
+    std::cout << "Done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
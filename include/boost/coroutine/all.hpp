@@ -8,14 +8,41 @@
 #define BOOST_COROUTINES_ALL_H
 
 #include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/barrier.hpp>
+#include <boost/coroutine/channel.hpp>
+#include <boost/coroutine/channel_op_status.hpp>
 #include <boost/coroutine/coroutine.hpp>
+#include <boost/coroutine/coroutine_condition_variable.hpp>
+#include <boost/coroutine/coroutine_mutex.hpp>
+#include <boost/coroutine/counting_semaphore.hpp>
 #include <boost/coroutine/exceptions.hpp>
 #include <boost/coroutine/flags.hpp>
+#include <boost/coroutine/fork_join_pool.hpp>
+#include <boost/coroutine/hooks.hpp>
+#include <boost/coroutine/latch.hpp>
+#include <boost/coroutine/offload_pool.hpp>
 #include <boost/coroutine/protected_stack_allocator.hpp>
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+# include <boost/coroutine/io_engine.hpp>
+# include <boost/coroutine/reactor.hpp>
+#endif
+#if defined(BOOST_COROUTINES_HAS_PROFILER)
+# include <boost/coroutine/profiler.hpp>
+#endif
+#include <boost/coroutine/registry.hpp>
+#include <boost/coroutine/scheduler.hpp>
 #include <boost/coroutine/segmented_stack_allocator.hpp>
+#include <boost/coroutine/select.hpp>
 #include <boost/coroutine/stack_allocator.hpp>
 #include <boost/coroutine/stack_context.hpp>
 #include <boost/coroutine/stack_traits.hpp>
 #include <boost/coroutine/standard_stack_allocator.hpp>
+#include <boost/coroutine/task_group.hpp>
+#include <boost/coroutine/task_handle.hpp>
+#include <boost/coroutine/trace.hpp>
+#include <boost/coroutine/unwind.hpp>
+#if defined(BOOST_COROUTINES_HAS_WATCHDOG)
+# include <boost/coroutine/watchdog.hpp>
+#endif
 
 #endif // BOOST_COROUTINES_ALL_H
@@ -0,0 +1,396 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_ASIO_H
+#define BOOST_COROUTINES_ASIO_H
+
+#include <cstddef>
+#include <new>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/type_traits/decay.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// reference counted control block of a spawned coroutine; the
+// references are held by the pending completion handlers
+struct spawn_base
+{
+    std::size_t     use_count;
+
+    spawn_base() BOOST_NOEXCEPT :
+        use_count( 0)
+    {}
+
+    virtual ~spawn_base() {}
+
+    virtual void destroy() = 0;
+};
+
+inline
+void intrusive_ptr_add_ref( spawn_base * p) BOOST_NOEXCEPT
+{ ++p->use_count; }
+
+inline
+void intrusive_ptr_release( spawn_base * p)
+{ if ( 0 == --p->use_count) p->destroy(); }
+
+template< typename T >
+class yield_handler;
+
+template< typename Fn, typename StackAllocator >
+class spawn_object;
+
+}
+
+// completion token suspending the current coroutine until the
+// completion handler runs; the handler resumes the coroutine inline
+// - the I/O object's executor invokes the handler, nothing is posted
+// an error is thrown as boost::system::system_error unless an
+// error_code is bound via operator[]
+// all handlers of a coroutine must run on the thread of the coroutine
+class yield_context
+{
+private:
+    template< typename T >
+    friend class detail::yield_handler;
+
+    template< typename Fn, typename StackAllocator >
+    friend class detail::spawn_object;
+
+    void                    *   suspend_obj_;
+    void                    (*  suspend_)( void *);
+    void                    *   resume_obj_;
+    void                    (*  resume_)( void *);
+    detail::spawn_base      *   owner_;
+    system::error_code      *   ec_;
+
+    template< typename T >
+    static void invoke_( void * p)
+    { ( * static_cast< T * >( p) )(); }
+
+    template< typename Suspend, typename Resume >
+    yield_context( Suspend & suspend, Resume & resume, detail::spawn_base * owner) BOOST_NOEXCEPT :
+        suspend_obj_( & suspend), suspend_( & yield_context::invoke_< Suspend >),
+        resume_obj_( & resume), resume_( & yield_context::invoke_< Resume >),
+        owner_( owner), ec_( 0)
+    {}
+
+public:
+    // suspend() suspends the current coroutine (push_type of a
+    // pull_type, pull_type of a push_type or yield_type of a
+    // call_type), resume() resumes it (the pull_type, push_type or
+    // call_type itself); both must outlive the pending operations
+    template< typename Suspend, typename Resume >
+    yield_context( Suspend & suspend, Resume & resume) BOOST_NOEXCEPT :
+        suspend_obj_( & suspend), suspend_( & yield_context::invoke_< Suspend >),
+        resume_obj_( & resume), resume_( & yield_context::invoke_< Resume >),
+        owner_( 0), ec_( 0)
+    {}
+
+    // errors are stored in ec instead of being thrown
+    yield_context operator[]( system::error_code & ec) const BOOST_NOEXCEPT
+    {
+        yield_context tmp( * this);
+        tmp.ec_ = & ec;
+        return tmp;
+    }
+};
+
+namespace detail {
+
+// result of one operation, lives on the stack of the suspended
+// coroutine (inside of async_result)
+class yield_state
+{
+private:
+    template< typename T >
+    friend class yield_handler;
+
+    system::error_code          ec_;
+    system::error_code      *   target_;
+    void                    *   suspend_obj_;
+    void                    (*  suspend_)( void *);
+    bool                        done_;
+    bool                        suspended_;
+
+public:
+    yield_state() BOOST_NOEXCEPT :
+        ec_(), target_( 0), suspend_obj_( 0), suspend_( 0),
+        done_( false), suspended_( false)
+    {}
+
+    // suspends unless the handler has already run
+    void wait()
+    {
+        if ( ! done_)
+        {
+            suspended_ = true;
+            suspend_( suspend_obj_);
+            suspended_ = false;
+        }
+        BOOST_ASSERT( done_);
+        if ( 0 != target_) * target_ = ec_;
+        else if ( ec_) boost::throw_exception( system::system_error( ec_) );
+    }
+};
+
+template< typename T >
+class yield_handler
+{
+private:
+    yield_context                   ctx_;
+    intrusive_ptr< spawn_base >     owner_;
+
+public:
+    T                           *   value;
+    yield_state                 *   state;
+
+    explicit yield_handler( yield_context const& ctx) :
+        ctx_( ctx), owner_( ctx.owner_), value( 0), state( 0)
+    {}
+
+    void bind( yield_state & s, T & v) BOOST_NOEXCEPT
+    {
+        s.target_ = ctx_.ec_;
+        s.suspend_obj_ = ctx_.suspend_obj_;
+        s.suspend_ = ctx_.suspend_;
+        state = & s;
+        value = & v;
+    }
+
+    void operator()( system::error_code const& ec, T v)
+    {
+        * value = boost::move( v);
+        state->ec_ = ec;
+        state->done_ = true;
+        // the coroutine runs until its next suspension
+        if ( state->suspended_) ctx_.resume_( ctx_.resume_obj_);
+    }
+};
+
+template<>
+class yield_handler< void >
+{
+private:
+    yield_context                   ctx_;
+    intrusive_ptr< spawn_base >     owner_;
+
+public:
+    yield_state                 *   state;
+
+    explicit yield_handler( yield_context const& ctx) :
+        ctx_( ctx), owner_( ctx.owner_), state( 0)
+    {}
+
+    void bind( yield_state & s) BOOST_NOEXCEPT
+    {
+        s.target_ = ctx_.ec_;
+        s.suspend_obj_ = ctx_.suspend_obj_;
+        s.suspend_ = ctx_.suspend_;
+        state = & s;
+    }
+
+    void operator()( system::error_code const& ec)
+    {
+        state->ec_ = ec;
+        state->done_ = true;
+        if ( state->suspended_) ctx_.resume_( ctx_.resume_obj_);
+    }
+
+    void operator()()
+    { ( * this)( system::error_code() ); }
+};
+
+// hands the stack below the control block to the coroutine
+struct preallocated_stack
+{
+    stack_context   stack_ctx;
+
+    explicit preallocated_stack( stack_context const& stack_ctx_) BOOST_NOEXCEPT :
+        stack_ctx( stack_ctx_)
+    {}
+
+    void allocate( stack_context & ctx, std::size_t) BOOST_NOEXCEPT
+    { ctx = stack_ctx; }
+
+    void deallocate( stack_context &) BOOST_NOEXCEPT
+    {}
+};
+
+template< typename Fn, typename StackAllocator >
+class spawn_object : public spawn_base
+{
+private:
+    typedef asymmetric_coroutine< void >::push_type     coroutine_t;
+    typedef asymmetric_coroutine< void >::pull_type     source_t;
+
+    struct entry
+    {
+        spawn_object    *   self;
+
+        explicit entry( spawn_object * self_) BOOST_NOEXCEPT :
+            self( self_)
+        {}
+
+        void operator()( source_t & source) const
+        {
+            yield_context yield( source, self->coro_, self);
+            self->fn_( yield);
+        }
+    };
+
+    Fn                  fn_;
+    StackAllocator      stack_alloc_;
+    stack_context       stack_ctx_;
+    coroutine_t         coro_;
+
+public:
+    spawn_object( Fn fn, attributes const& attrs, StackAllocator stack_alloc,
+                  stack_context const& stack_ctx, stack_context const& internal_stack_ctx) :
+        spawn_base(),
+        fn_( fn),
+        stack_alloc_( stack_alloc),
+        stack_ctx_( stack_ctx),
+        coro_( entry( this), attrs, preallocated_stack( internal_stack_ctx) )
+    {}
+
+    void start()
+    { coro_(); }
+
+    void destroy()
+    {
+        // handlers copied while the stack is unwound must not
+        // destroy the object again
+        ++use_count;
+        StackAllocator stack_alloc( stack_alloc_);
+        stack_context stack_ctx( stack_ctx_);
+        this->~spawn_object();
+        stack_alloc.deallocate( stack_ctx);
+    }
+};
+
+}
+
+// runs fn( yield_context) in a new coroutine until its first
+// suspension; the coroutine is owned by its pending completion
+// handlers and destroyed (its stack unwound) with the last of them
+// the control block lives on top of the stack - with a
+// pooled_stack_allocator spawning does not allocate
+// exceptions escaping from fn are re-thrown by spawn() resp. by
+// the completion handler resuming the coroutine
+template< typename Fn, typename StackAllocator >
+void spawn( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+{
+    typedef detail::spawn_object< Fn, StackAllocator > object_t;
+
+    stack_context stack_ctx;
+    stack_alloc.allocate( stack_ctx, attrs.size);
+    BOOST_ASSERT( 0 != stack_ctx.sp);
+    // reserve space on top of coroutine-stack for the control block
+    stack_context internal_stack_ctx( stack_ctx);
+    internal_stack_ctx.sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    internal_stack_ctx.size = stack_ctx.size - sizeof( object_t);
+    BOOST_ASSERT( 0 < internal_stack_ctx.size);
+    intrusive_ptr< detail::spawn_base > obj(
+        new ( internal_stack_ctx.sp) object_t( fn, attrs, stack_alloc, stack_ctx, internal_stack_ctx) );
+    static_cast< object_t * >( obj.get() )->start();
+}
+
+template< typename Fn >
+void spawn( Fn fn, attributes const& attrs = attributes() )
+{ spawn( fn, attrs, stack_allocator() ); }
+
+}
+
+namespace asio {
+
+template< typename ReturnType >
+class async_result< coroutines::yield_context, ReturnType() >
+{
+private:
+    coroutines::detail::yield_state     state_;
+
+public:
+    typedef coroutines::detail::yield_handler< void >   completion_handler_type;
+    typedef void                                        return_type;
+
+    explicit async_result( completion_handler_type & h) :
+        state_()
+    { h.bind( state_); }
+
+    void get()
+    { state_.wait(); }
+};
+
+template< typename ReturnType >
+class async_result< coroutines::yield_context, ReturnType( system::error_code) >
+{
+private:
+    coroutines::detail::yield_state     state_;
+
+public:
+    typedef coroutines::detail::yield_handler< void >   completion_handler_type;
+    typedef void                                        return_type;
+
+    explicit async_result( completion_handler_type & h) :
+        state_()
+    { h.bind( state_); }
+
+    void get()
+    { state_.wait(); }
+};
+
+template< typename ReturnType, typename Arg >
+class async_result< coroutines::yield_context, ReturnType( system::error_code, Arg) >
+{
+public:
+    typedef typename decay< Arg >::type                 value_type;
+    typedef coroutines::detail::yield_handler<
+        value_type
+    >                                                   completion_handler_type;
+    typedef value_type                                  return_type;
+
+    explicit async_result( completion_handler_type & h) :
+        state_(), value_()
+    { h.bind( state_, value_); }
+
+    return_type get()
+    {
+        state_.wait();
+        return boost::move( value_);
+    }
+
+private:
+    coroutines::detail::yield_state     state_;
+    value_type                          value_;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_ASIO_H
@@ -132,6 +132,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -271,6 +288,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -410,6 +444,23 @@ public:
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     inline void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -706,6 +757,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -1174,6 +1242,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -1638,6 +1723,23 @@ public:
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     inline void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
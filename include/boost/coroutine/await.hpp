@@ -0,0 +1,104 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_AWAIT_H
+#define BOOST_COROUTINES_AWAIT_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/thread/future.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#if ! defined(BOOST_THREAD_PROVIDES_FUTURE_CONTINUATION)
+# error "await() requires future continuations (BOOST_THREAD_VERSION 4 or BOOST_THREAD_PROVIDES_FUTURE_CONTINUATION)"
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// continuation registered by await(): runs on the thread making
+// the future ready, stores it on the stack of the waiting task and
+// hands the task to its scheduler
+template< typename Future >
+struct await_continuation
+{
+    typedef void    result_type;
+
+    scheduler   *   sched;
+    task_base   *   task;
+    Future      *   result;
+
+    void operator()( Future f)
+    {
+        * result = boost::move( f);
+        sched->schedule_remote( task);
+    }
+};
+
+// suspends the active task until f is ready
+template< typename Future >
+void await_ready( Future & f)
+{
+    if ( f.is_ready() ) return;
+
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    task_base * self = sched->active();
+    BOOST_ASSERT( 0 != self);
+    BOOST_ASSERT( self->force_unwind() );
+
+    if ( sched->cancellation_requested() ) throw forced_unwind();
+    Future result;
+    await_continuation< Future > c = { sched, self, & result };
+    // the continuation might run inline (f became ready meanwhile);
+    // the scheduler takes the remote wakeup not before suspend()
+    f.then( launch::sync, boost::move( c) );
+    sched->expect_remote();
+    try
+    { self->suspend(); }
+    catch ( forced_unwind const&)
+    {
+        // the continuation still refers to the stack
+        sched->join_remote();
+        throw;
+    }
+    f = boost::move( result);
+    if ( sched->cancellation_requested() ) throw forced_unwind();
+}
+
+}
+
+namespace this_coroutine {
+
+// suspends the active task (not the thread) until f is ready and
+// returns its value (re-throws its exception); the task is resumed
+// by its own scheduler, whichever thread makes f ready
+// no allocation besides the continuation state of Boost.Thread
+template< typename T >
+T await( BOOST_THREAD_FUTURE< T > & f)
+{
+    detail::await_ready( f);
+    return f.get();
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_AWAIT_H
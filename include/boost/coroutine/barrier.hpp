@@ -0,0 +1,62 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_BARRIER_H
+#define BOOST_COROUTINES_BARRIER_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/spinlock.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// reusable barrier for tasks of one or more schedulers; the last
+// of `count` arriving tasks resets the barrier, makes the others
+// ready on their schedulers and continues without suspending
+class BOOST_COROUTINES_DECL barrier : private noncopyable
+{
+private:
+    std::size_t             initial_;
+    // guarded by lock_ - an arrival and the reset of the phase
+    // must not interleave
+    std::size_t             count_;
+    detail::spinlock        lock_;
+    detail::task_queue      waiters_;
+
+public:
+    explicit barrier( std::size_t count) BOOST_NOEXCEPT :
+        initial_( count),
+        count_( count),
+        lock_(),
+        waiters_()
+    { BOOST_ASSERT( 0 < count); }
+
+    ~barrier()
+    { BOOST_ASSERT( waiters_.empty() ); }
+
+    // returns true for the task completing the phase
+    bool arrive_and_wait();
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_BARRIER_H
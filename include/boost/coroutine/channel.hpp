@@ -0,0 +1,156 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_CHANNEL_H
+#define BOOST_COROUTINES_CHANNEL_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/channel_op_status.hpp>
+#include <boost/coroutine/detail/channel_waiter.hpp>
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+class select;
+
+// FIFO channel for tasks of one scheduler
+// a channel with capacity 0 is a rendezvous channel: push()
+// suspends until a consumer takes the element
+// a blocked operation is completed by the task on the other
+// side (the element is copied directly from/to the waiter)
+template< typename T >
+class channel : private noncopyable
+{
+private:
+    friend class select;
+
+    circular_buffer< T >    buffer_;
+    bool                    closed_;
+    detail::waiter_list     pushers_;
+    detail::waiter_list     poppers_;
+
+    static channel_op_status try_push_( void * c, void * v)
+    { return static_cast< channel * >( c)->try_push( * static_cast< T const* >( v) ); }
+
+    static channel_op_status try_pop_( void * c, void * v)
+    { return static_cast< channel * >( c)->try_pop( * static_cast< T * >( v) ); }
+
+public:
+    typedef T   value_type;
+
+    explicit channel( std::size_t capacity = 0) :
+        buffer_( capacity),
+        closed_( false),
+        pushers_(),
+        poppers_()
+    {}
+
+    ~channel()
+    {
+        BOOST_ASSERT( 0 == pushers_.front() );
+        BOOST_ASSERT( 0 == poppers_.front() );
+    }
+
+    std::size_t capacity() const BOOST_NOEXCEPT
+    { return buffer_.capacity(); }
+
+    bool is_closed() const BOOST_NOEXCEPT
+    { return closed_; }
+
+    // wakes all blocked tasks with channel_op_closed; buffered
+    // elements can still be popped
+    void close() BOOST_NOEXCEPT
+    {
+        closed_ = true;
+        for ( detail::channel_waiter * w = poppers_.front(); 0 != w; w = poppers_.front() )
+        {
+            poppers_.erase( w);
+            w->state->fire( w->index, channel_op_closed);
+        }
+        for ( detail::channel_waiter * w = pushers_.front(); 0 != w; w = pushers_.front() )
+        {
+            pushers_.erase( w);
+            w->state->fire( w->index, channel_op_closed);
+        }
+    }
+
+    channel_op_status try_push( T const& v)
+    {
+        if ( closed_) return channel_op_closed;
+        // a consumer waits only if the buffer is empty
+        detail::channel_waiter * w = poppers_.front();
+        if ( 0 != w)
+        {
+            * static_cast< T * >( w->value) = v;
+            poppers_.erase( w);
+            w->state->fire( w->index, channel_op_success);
+            return channel_op_success;
+        }
+        if ( buffer_.full() ) return channel_op_full;
+        buffer_.push_back( v);
+        return channel_op_success;
+    }
+
+    channel_op_status try_pop( T & v)
+    {
+        detail::channel_waiter * w = pushers_.front();
+        if ( ! buffer_.empty() )
+        {
+            v = buffer_.front();
+            buffer_.pop_front();
+            // refill the slot from the first blocked producer
+            if ( 0 != w)
+            {
+                buffer_.push_back( * static_cast< T const* >( w->value) );
+                pushers_.erase( w);
+                w->state->fire( w->index, channel_op_success);
+            }
+            return channel_op_success;
+        }
+        if ( 0 != w)
+        {
+            v = * static_cast< T const* >( w->value);
+            pushers_.erase( w);
+            w->state->fire( w->index, channel_op_success);
+            return channel_op_success;
+        }
+        return closed_ ? channel_op_closed : channel_op_empty;
+    }
+
+    // suspends the active task while the channel is full
+    channel_op_status push( T const& v)
+    {
+        channel_op_status st = try_push( v);
+        if ( channel_op_full != st) return st;
+        return detail::channel_wait( pushers_, const_cast< T * >( & v) );
+    }
+
+    // suspends the active task while the channel is empty
+    channel_op_status pop( T & v)
+    {
+        channel_op_status st = try_pop( v);
+        if ( channel_op_empty != st) return st;
+        return detail::channel_wait( poppers_, & v);
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_CHANNEL_H
@@ -0,0 +1,35 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_CHANNEL_OP_STATUS_H
+#define BOOST_COROUTINES_CHANNEL_OP_STATUS_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+enum channel_op_status
+{
+    channel_op_success = 0,
+    channel_op_empty,
+    channel_op_full,
+    channel_op_closed,
+    channel_op_timeout
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_CHANNEL_OP_STATUS_H
@@ -0,0 +1,76 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_COROUTINE_CONDITION_VARIABLE_H
+#define BOOST_COROUTINES_COROUTINE_CONDITION_VARIABLE_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/coroutine_mutex.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// condition variable for tasks of one scheduler
+// LockType is any lockable wrapper (e.g. unique_lock< coroutine_mutex >)
+class BOOST_COROUTINES_DECL coroutine_condition_variable : private noncopyable
+{
+private:
+    detail::task_queue      waiters_;
+
+    void suspend_( detail::task_base *);
+
+public:
+    coroutine_condition_variable() BOOST_NOEXCEPT :
+        waiters_()
+    {}
+
+    ~coroutine_condition_variable()
+    { BOOST_ASSERT( waiters_.empty() ); }
+
+    template< typename LockType >
+    void wait( LockType & lk)
+    {
+        scheduler * sched = scheduler::instance();
+        BOOST_ASSERT( 0 != sched);
+        detail::task_base * self = sched->active();
+        BOOST_ASSERT( 0 != self);
+
+        waiters_.push( self);
+        lk.unlock();
+        // the lock is not re-acquired if the task gets unwound
+        suspend_( self);
+        lk.lock();
+    }
+
+    template< typename LockType, typename Pred >
+    void wait( LockType & lk, Pred pred)
+    {
+        while ( ! pred() )
+            wait( lk);
+    }
+
+    void notify_one() BOOST_NOEXCEPT;
+
+    void notify_all() BOOST_NOEXCEPT;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_COROUTINE_CONDITION_VARIABLE_H
@@ -0,0 +1,100 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_COROUTINE_MUTEX_H
+#define BOOST_COROUTINES_COROUTINE_MUTEX_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// mutex for tasks of one scheduler
+// a contending task is suspended (the thread is not blocked)
+// and appended to a FIFO of waiters; unlock() hands the
+// ownership directly to the first waiter
+class BOOST_COROUTINES_DECL coroutine_mutex : private noncopyable
+{
+private:
+    detail::task_base   *   owner_;
+    detail::task_queue      waiters_;
+
+    void lock_slow_( detail::task_base *);
+
+    void unlock_slow_() BOOST_NOEXCEPT;
+
+public:
+    coroutine_mutex() BOOST_NOEXCEPT :
+        owner_( 0),
+        waiters_()
+    {}
+
+    ~coroutine_mutex()
+    {
+        BOOST_ASSERT( 0 == owner_);
+        BOOST_ASSERT( waiters_.empty() );
+    }
+
+    void lock()
+    {
+        scheduler * sched = scheduler::instance();
+        BOOST_ASSERT( 0 != sched);
+        detail::task_base * self = sched->active();
+        BOOST_ASSERT( 0 != self);
+        BOOST_ASSERT_MSG( owner_ != self, "coroutine_mutex is not recursive");
+
+        // uncontended: no atomic operation required, all
+        // users of the mutex run on the same thread
+        if ( 0 == owner_)
+        {
+            owner_ = self;
+            return;
+        }
+        lock_slow_( self);
+    }
+
+    bool try_lock() BOOST_NOEXCEPT
+    {
+        scheduler * sched = scheduler::instance();
+        BOOST_ASSERT( 0 != sched);
+        detail::task_base * self = sched->active();
+        BOOST_ASSERT( 0 != self);
+
+        if ( 0 != owner_) return false;
+        owner_ = self;
+        return true;
+    }
+
+    void unlock() BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != owner_);
+
+        if ( waiters_.empty() )
+        {
+            owner_ = 0;
+            return;
+        }
+        unlock_slow_();
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_COROUTINE_MUTEX_H
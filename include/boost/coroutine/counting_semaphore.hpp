@@ -0,0 +1,80 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_COUNTING_SEMAPHORE_H
+#define BOOST_COROUTINES_COUNTING_SEMAPHORE_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// semaphore for tasks of one scheduler
+// release() passes a unit directly to the first waiter
+// (FIFO), the counter only holds units nobody waits for
+class BOOST_COROUTINES_DECL counting_semaphore : private noncopyable
+{
+private:
+    std::size_t             count_;
+    detail::task_queue      waiters_;
+
+    void acquire_slow_( detail::task_base *);
+
+public:
+    explicit counting_semaphore( std::size_t count = 0) BOOST_NOEXCEPT :
+        count_( count),
+        waiters_()
+    {}
+
+    ~counting_semaphore()
+    { BOOST_ASSERT( waiters_.empty() ); }
+
+    std::size_t value() const BOOST_NOEXCEPT
+    { return count_; }
+
+    void acquire()
+    {
+        if ( 0 < count_)
+        {
+            --count_;
+            return;
+        }
+        scheduler * sched = scheduler::instance();
+        BOOST_ASSERT( 0 != sched);
+        detail::task_base * self = sched->active();
+        BOOST_ASSERT( 0 != self);
+        acquire_slow_( self);
+    }
+
+    bool try_acquire() BOOST_NOEXCEPT
+    {
+        if ( 0 == count_) return false;
+        --count_;
+        return true;
+    }
+
+    void release( std::size_t n = 1) BOOST_NOEXCEPT;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_COUNTING_SEMAPHORE_H
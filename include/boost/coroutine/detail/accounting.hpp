@@ -0,0 +1,86 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_ACCOUNTING_H
+#define BOOST_COROUTINES_DETAIL_ACCOUNTING_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+// BOOST_COROUTINES_ACCOUNTING adds resume counters and on-CPU time to
+// the control blocks of the coroutines; without it the accounting is
+// compiled out entirely
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+
+#include <boost/cstdint.hpp>
+
+#if defined(BOOST_MSVC) && ( defined(_M_IX86) || defined(_M_X64) )
+# include <intrin.h>
+#elif ! ( defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) || defined(__aarch64__) ) )
+# include <boost/chrono/system_clocks.hpp>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// time stamp counter - not serialized, a few cycles per read
+inline
+uint64_t read_tsc() BOOST_NOEXCEPT
+{
+#if defined(BOOST_MSVC) && ( defined(_M_IX86) || defined(_M_X64) )
+    return __rdtsc();
+#elif defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+    return __builtin_ia32_rdtsc();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    uint64_t v;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (v) );
+    return v;
+#else
+    return chrono::high_resolution_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct accounting
+{
+    uint64_t    resumes;
+    uint64_t    ticks;
+    uint64_t    entered;
+
+    accounting() BOOST_NOEXCEPT :
+        resumes( 0), ticks( 0), entered( 0)
+    {}
+
+    // control is transferred to the coroutine
+    void enter() BOOST_NOEXCEPT
+    {
+        ++resumes;
+        entered = read_tsc();
+    }
+
+    // control leaves the coroutine
+    void leave() BOOST_NOEXCEPT
+    { ticks += read_tsc() - entered; }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+# define BOOST_COROUTINES_ACCOUNT_ENTER( acct) ( acct).enter()
+# define BOOST_COROUTINES_ACCOUNT_LEAVE( acct) ( acct).leave()
+#else
+# define BOOST_COROUTINES_ACCOUNT_ENTER( acct) ( ( void) 0)
+# define BOOST_COROUTINES_ACCOUNT_LEAVE( acct) ( ( void) 0)
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_ACCOUNTING_H
@@ -0,0 +1,146 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_CHANNEL_WAITER_H
+#define BOOST_COROUTINES_DETAIL_CHANNEL_WAITER_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/channel_op_status.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// shared by all waiters of one wait (blocking channel operation
+// or select); the first waiter firing wins, the others are stale
+// until the woken task unlinks them
+struct select_state
+{
+    static const std::size_t    npos = static_cast< std::size_t >( -1);
+
+    task_base               *   task;
+    std::size_t                 fired;
+    channel_op_status           status;
+
+    explicit select_state( task_base * task_ = 0) BOOST_NOEXCEPT :
+        task( task_), fired( npos), status( channel_op_success)
+    {}
+
+    bool is_fired() const BOOST_NOEXCEPT
+    { return npos != fired; }
+
+    bool fire( std::size_t index, channel_op_status st) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != task);
+
+        if ( is_fired() ) return false;
+        fired = index;
+        status = st;
+        task->owner()->schedule( task);
+        return true;
+    }
+};
+
+class waiter_list;
+
+// node of a channel's wait-list, allocated on the stack of
+// the waiting task; value points to the element to be pushed
+// or to the storage receiving the popped element
+struct channel_waiter
+{
+    channel_waiter      *   next;
+    channel_waiter      *   prev;
+    waiter_list         *   list;
+    select_state        *   state;
+    std::size_t             index;
+    void                *   value;
+
+    channel_waiter() BOOST_NOEXCEPT :
+        next( 0), prev( 0), list( 0), state( 0), index( 0), value( 0)
+    {}
+
+    channel_waiter( select_state * state_, std::size_t index_, void * value_) BOOST_NOEXCEPT :
+        next( 0), prev( 0), list( 0), state( state_), index( index_), value( value_)
+    {}
+
+    bool is_linked() const BOOST_NOEXCEPT
+    { return 0 != list; }
+};
+
+// intrusive FIFO of channel waiters - no allocation
+class waiter_list : private noncopyable
+{
+private:
+    channel_waiter  *   head_;
+    channel_waiter  *   tail_;
+
+public:
+    waiter_list() BOOST_NOEXCEPT :
+        head_( 0),
+        tail_( 0)
+    {}
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == head_; }
+
+    void push( channel_waiter * w) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != w);
+        BOOST_ASSERT( ! w->is_linked() );
+
+        w->list = this;
+        w->next = 0;
+        w->prev = tail_;
+        if ( 0 != tail_) tail_->next = w;
+        else head_ = w;
+        tail_ = w;
+    }
+
+    void erase( channel_waiter * w) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( this == w->list);
+
+        if ( 0 != w->prev) w->prev->next = w->next;
+        else head_ = w->next;
+        if ( 0 != w->next) w->next->prev = w->prev;
+        else tail_ = w->prev;
+        w->next = w->prev = 0;
+        w->list = 0;
+    }
+
+    // first waiter whose wait has not fired yet; stale
+    // waiters in front of it are unlinked
+    channel_waiter * front() BOOST_NOEXCEPT
+    {
+        while ( 0 != head_ && head_->state->is_fired() )
+            erase( head_);
+        return head_;
+    }
+};
+
+// suspends the active task on one wait-list until the waiter
+// fires; the operation has been completed by the firing side
+BOOST_COROUTINES_DECL
+channel_op_status channel_wait( waiter_list &, void *);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_CHANNEL_WAITER_H
@@ -0,0 +1,156 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_CHASE_LEV_DEQUE_H
+#define BOOST_COROUTINES_DETAIL_CHASE_LEV_DEQUE_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// work-stealing deque (Chase/Lev, memory orders as in Le et al.
+// "Correct and Efficient Work-Stealing for Weak Memory Models")
+// push() and pop() are called by the owning thread only (LIFO end),
+// steal() by any thread (FIFO end)
+// arrays replaced by grow_() are kept until destruction because a
+// concurrent thief might still read from them
+template< typename T >
+class chase_lev_deque : private noncopyable
+{
+private:
+    class array
+    {
+    private:
+        std::size_t         mask_;
+        atomic< T * >   *   items_;
+
+    public:
+        explicit array( std::size_t capacity) :
+            mask_( capacity - 1),
+            items_( new atomic< T * >[capacity])
+        { BOOST_ASSERT( 0 == ( capacity & mask_) ); }
+
+        ~array()
+        { delete [] items_; }
+
+        std::size_t capacity() const BOOST_NOEXCEPT
+        { return mask_ + 1; }
+
+        T * get( std::ptrdiff_t i) const BOOST_NOEXCEPT
+        { return items_[i & mask_].load( memory_order_relaxed); }
+
+        void put( std::ptrdiff_t i, T * t) BOOST_NOEXCEPT
+        { items_[i & mask_].store( t, memory_order_relaxed); }
+    };
+
+    atomic< std::ptrdiff_t >    top_;
+    atomic< std::ptrdiff_t >    bottom_;
+    atomic< array * >           array_;
+    std::vector< array * >      old_;
+
+    array * grow_( array * a, std::ptrdiff_t t, std::ptrdiff_t b)
+    {
+        array * tmp = new array( 2 * a->capacity() );
+        for ( std::ptrdiff_t i = t; i != b; ++i)
+            tmp->put( i, a->get( i) );
+        old_.push_back( a);
+        array_.store( tmp, memory_order_release);
+        return tmp;
+    }
+
+public:
+    explicit chase_lev_deque( std::size_t capacity = 64) :
+        top_( 0),
+        bottom_( 0),
+        array_( new array( capacity) ),
+        old_()
+    {}
+
+    ~chase_lev_deque()
+    {
+        delete array_.load( memory_order_relaxed);
+        for ( std::size_t i = 0; i < old_.size(); ++i)
+            delete old_[i];
+    }
+
+    bool empty() const BOOST_NOEXCEPT
+    {
+        return bottom_.load( memory_order_relaxed) <=
+               top_.load( memory_order_relaxed);
+    }
+
+    void push( T * t)
+    {
+        std::ptrdiff_t b = bottom_.load( memory_order_relaxed);
+        std::ptrdiff_t tp = top_.load( memory_order_acquire);
+        array * a = array_.load( memory_order_relaxed);
+        if ( b - tp > static_cast< std::ptrdiff_t >( a->capacity() ) - 1)
+            a = grow_( a, tp, b);
+        a->put( b, t);
+        atomic_thread_fence( memory_order_release);
+        bottom_.store( b + 1, memory_order_relaxed);
+    }
+
+    T * pop() BOOST_NOEXCEPT
+    {
+        std::ptrdiff_t b = bottom_.load( memory_order_relaxed) - 1;
+        array * a = array_.load( memory_order_relaxed);
+        bottom_.store( b, memory_order_relaxed);
+        atomic_thread_fence( memory_order_seq_cst);
+        std::ptrdiff_t t = top_.load( memory_order_relaxed);
+        if ( t > b)
+        {
+            // empty
+            bottom_.store( b + 1, memory_order_relaxed);
+            return 0;
+        }
+        T * x = a->get( b);
+        if ( t == b)
+        {
+            // last item - race against thieves
+            if ( ! top_.compare_exchange_strong( t, t + 1,
+                        memory_order_seq_cst, memory_order_relaxed) )
+                x = 0;
+            bottom_.store( b + 1, memory_order_relaxed);
+        }
+        return x;
+    }
+
+    T * steal() BOOST_NOEXCEPT
+    {
+        std::ptrdiff_t t = top_.load( memory_order_acquire);
+        atomic_thread_fence( memory_order_seq_cst);
+        std::ptrdiff_t b = bottom_.load( memory_order_acquire);
+        if ( t >= b) return 0;
+        array * a = array_.load( memory_order_acquire);
+        T * x = a->get( t);
+        if ( ! top_.compare_exchange_strong( t, t + 1,
+                    memory_order_seq_cst, memory_order_relaxed) )
+            return 0;
+        return x;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_CHASE_LEV_DEQUE_H
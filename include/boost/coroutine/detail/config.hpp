@@ -43,6 +43,20 @@
 # define BOOST_COROUTINES_SEGMENTS 10
 #endif
 
+#if ! defined(BOOST_NO_CXX11_THREAD_LOCAL)
+# define BOOST_COROUTINES_THREAD_LOCAL thread_local
+#elif defined(BOOST_MSVC)
+# define BOOST_COROUTINES_THREAD_LOCAL __declspec(thread)
+#else
+# define BOOST_COROUTINES_THREAD_LOCAL __thread
+#endif
+
+#if defined(__linux__)
+# define BOOST_COROUTINES_HAS_EPOLL
+# define BOOST_COROUTINES_HAS_PROFILER
+# define BOOST_COROUTINES_HAS_WATCHDOG
+#endif
+
 #define BOOST_COROUTINES_UNIDIRECT
 #define BOOST_COROUTINES_SYMMETRIC
 
@@ -34,6 +34,8 @@ class BOOST_COROUTINES_DECL coroutine_context
 private:
     stack_context           stack_ctx_;
     context::fcontext_t     ctx_;
+    char const          *   label_;
+    void                **  entry_;
 #ifdef BOOST_COROUTINE_USE_FIBER
     void                    (*fn_)(intptr_t);
     intptr_t                param_;
@@ -61,11 +63,59 @@ public:
     stack_context & stack_ctx()
     { return stack_ctx_; }
 
+    // bytes of the stack in use at the last suspension (0 if unknown)
+    std::size_t stack_used() const;
+
+    char const* label() const
+    { return label_; }
+
+    void label( char const* label)
+    { label_ = label; }
+
+    // execution-context of the coroutine running on the current
+    // thread (0 outside of coroutines); recorded only while tracked,
+    // 0 before the first switch since track_active( true)
+    static coroutine_context * active() BOOST_NOEXCEPT;
+
+    // counted: the samplers calling active() track while they run
+    static void track_active( bool) BOOST_NOEXCEPT;
+
+    // called by the trampoline of the coroutine just entered with its
+    // frame (saved frame pointer, return address): the frame pointer
+    // chain ends there, or continues into the resumer (parent link)
+    static void entry_frame( void ** frame) BOOST_NOEXCEPT;
+
+    static void link_parent( bool) BOOST_NOEXCEPT;
+
+    static bool parent_linked() BOOST_NOEXCEPT;
+
     void destory();
 };
 
 }}}
 
+// marks the frame of a trampoline as the outermost frame of the coroutine
+// stack - for DWARF unwinders (gdb, perf --call-graph dwarf) the return
+// address is undefined, for frame pointer unwinders (perf -g) the chain
+// ends or is linked to the resumer
+#if defined(__GNUC__) && ! defined(BOOST_COROUTINE_USE_FIBER) && \
+    ( defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) )
+# if defined(__x86_64__)
+#  define BOOST_COROUTINES_CFI_UNDEFINED_RA ".cfi_undefined rip"
+# elif defined(__i386__)
+#  define BOOST_COROUTINES_CFI_UNDEFINED_RA ".cfi_undefined eip"
+# else
+#  define BOOST_COROUTINES_CFI_UNDEFINED_RA ".cfi_undefined x30"
+# endif
+# define BOOST_COROUTINES_HAS_ENTRY_FRAME
+# define BOOST_COROUTINES_ENTRY_FRAME() \
+    __asm__ __volatile__ ( BOOST_COROUTINES_CFI_UNDEFINED_RA); \
+    ::boost::coroutines::detail::coroutine_context::entry_frame( \
+        static_cast< void ** >( __builtin_frame_address( 0) ) )
+#else
+# define BOOST_COROUTINES_ENTRY_FRAME() ( ( void) 0)
+#endif
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_SUFFIX
 #endif
@@ -24,7 +24,8 @@ enum flag_t
     flag_complete       = 1 << 3,
     flag_unwind_stack   = 1 << 4,
     flag_force_unwind   = 1 << 5,
-    flag_preserve_fpu   = 1 << 6
+    flag_preserve_fpu   = 1 << 6,
+    flag_remote_wakeup  = 1 << 7
 };
 
 struct unwind_t
@@ -0,0 +1,98 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_FORK_JOIN_TASK_H
+#define BOOST_COROUTINES_DETAIL_FORK_JOIN_TASK_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+class fork_join_pool;
+
+namespace detail {
+
+// completion record of a task submitted by fork_join_pool::run()
+struct fork_join_root
+{
+    bool                done;
+    exception_ptr       except;
+
+    fork_join_root() :
+        done( false), except()
+    {}
+};
+
+// control block of a fork-join task, lives on top of its stack
+// join_ counts the outstanding children plus one token held by
+// the task itself until it waits in sync(); whoever drops the
+// counter to zero resumes the task
+class fork_join_task : private noncopyable
+{
+public:
+    fork_join_task( coroutine_context::ctx_fn fn,
+                    stack_context const& stack_ctx,
+                    bool preserve_fpu) BOOST_NOEXCEPT :
+        ctx_( fn, stack_ctx),
+        parent_( 0),
+        root_( 0),
+        join_( 1),
+        failed_( false),
+        except_(),
+        preserve_fpu_( preserve_fpu)
+    {}
+
+    virtual ~fork_join_task() {}
+
+    bool preserve_fpu() const BOOST_NOEXCEPT
+    { return preserve_fpu_; }
+
+    // records the first exception of this task or of its children
+    void set_exception( exception_ptr const& except) BOOST_NOEXCEPT
+    {
+        if ( ! failed_.exchange( true, memory_order_acq_rel) )
+            except_ = except;
+    }
+
+    virtual void run() = 0;
+
+    virtual void destroy() = 0;
+
+protected:
+    friend class coroutines::fork_join_pool;
+
+    coroutine_context           ctx_;
+    fork_join_task          *   parent_;
+    fork_join_root          *   root_;
+    atomic< std::size_t >       join_;
+    atomic< bool >              failed_;
+    exception_ptr               except_;
+    bool                        preserve_fpu_;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_FORK_JOIN_TASK_H
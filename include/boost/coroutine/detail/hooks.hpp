@@ -0,0 +1,148 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_HOOKS_H
+#define BOOST_COROUTINES_DETAIL_HOOKS_H
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/hooks.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+// lifecycle hooks of the asymmetric and symmetric coroutines, selected
+// at compile time:
+//   (default)                       compiled out entirely
+//   BOOST_COROUTINES_HOOKS=T        static member functions of class T
+//                                   (declared in BOOST_COROUTINES_HOOKS_HEADER)
+//   BOOST_COROUTINES_RUNTIME_HOOKS  the coroutine_hooks installed at runtime
+#if defined(BOOST_COROUTINES_HOOKS) && defined(BOOST_COROUTINES_HOOKS_HEADER)
+# include BOOST_COROUTINES_HOOKS_HEADER
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+extern BOOST_COROUTINES_DECL atomic< coroutine_hooks * > hooks_installed;
+
+// synthesized asymmetric coroutines (the other end, inside of the
+// coroutine) have no stack of their own - their transfers of control
+// are not reported
+template< typename Hooks >
+struct static_hook_dispatch
+{
+    static void create( void const* coro, stack_context const& stack)
+    { Hooks::on_create( coro, stack); }
+
+    static void resume( void const* coro)
+    { Hooks::on_resume( coro); }
+
+    static void suspend( void const* coro)
+    { Hooks::on_suspend( coro); }
+
+    static void complete( void const* coro)
+    { Hooks::on_complete( coro); }
+
+    static void destroy( void const* coro, stack_context const& stack)
+    { Hooks::on_destroy( coro, stack); }
+
+    static void enter( void const* coro, coroutine_context * callee)
+    { if ( 0 != callee->stack_ctx().sp) Hooks::on_resume( coro); }
+
+    static void leave( void const* coro, coroutine_context * callee, bool complete)
+    {
+        if ( 0 == callee->stack_ctx().sp) return;
+        if ( complete) Hooks::on_complete( coro);
+        else Hooks::on_suspend( coro);
+    }
+};
+
+// one acquire load (pairs with the release store of install()) and a
+// branch per event without installed hooks
+struct runtime_hook_dispatch
+{
+    static void create( void const* coro, stack_context const& stack)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h) h->on_create( coro, stack);
+    }
+
+    static void resume( void const* coro)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h) h->on_resume( coro);
+    }
+
+    static void suspend( void const* coro)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h) h->on_suspend( coro);
+    }
+
+    static void complete( void const* coro)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h) h->on_complete( coro);
+    }
+
+    static void destroy( void const* coro, stack_context const& stack)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h) h->on_destroy( coro, stack);
+    }
+
+    static void enter( void const* coro, coroutine_context * callee)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 != h && 0 != callee->stack_ctx().sp) h->on_resume( coro);
+    }
+
+    static void leave( void const* coro, coroutine_context * callee, bool complete)
+    {
+        coroutine_hooks * h = hooks_installed.load( memory_order_acquire);
+        if ( 0 == h || 0 == callee->stack_ctx().sp) return;
+        if ( complete) h->on_complete( coro);
+        else h->on_suspend( coro);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+# define BOOST_COROUTINES_HOOK_DISPATCH ::boost::coroutines::detail::runtime_hook_dispatch
+#elif defined(BOOST_COROUTINES_HOOKS)
+# define BOOST_COROUTINES_HOOK_DISPATCH ::boost::coroutines::detail::static_hook_dispatch< BOOST_COROUTINES_HOOKS >
+#endif
+
+#if defined(BOOST_COROUTINES_HOOK_DISPATCH)
+# define BOOST_COROUTINES_HOOK_CREATE( coro, stack) BOOST_COROUTINES_HOOK_DISPATCH::create( coro, stack)
+# define BOOST_COROUTINES_HOOK_RESUME( coro) BOOST_COROUTINES_HOOK_DISPATCH::resume( coro)
+# define BOOST_COROUTINES_HOOK_SUSPEND( coro) BOOST_COROUTINES_HOOK_DISPATCH::suspend( coro)
+# define BOOST_COROUTINES_HOOK_COMPLETE( coro) BOOST_COROUTINES_HOOK_DISPATCH::complete( coro)
+# define BOOST_COROUTINES_HOOK_DESTROY( coro, stack) BOOST_COROUTINES_HOOK_DISPATCH::destroy( coro, stack)
+# define BOOST_COROUTINES_HOOK_ENTER( coro, callee) BOOST_COROUTINES_HOOK_DISPATCH::enter( coro, callee)
+# define BOOST_COROUTINES_HOOK_LEAVE( coro, callee, complete) BOOST_COROUTINES_HOOK_DISPATCH::leave( coro, callee, complete)
+#else
+# define BOOST_COROUTINES_HOOK_CREATE( coro, stack) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_RESUME( coro) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_SUSPEND( coro) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_COMPLETE( coro) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_DESTROY( coro, stack) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_ENTER( coro, callee) ( ( void) 0)
+# define BOOST_COROUTINES_HOOK_LEAVE( coro, callee, complete) ( ( void) 0)
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_HOOKS_H
@@ -0,0 +1,48 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_POLLER_H
+#define BOOST_COROUTINES_DETAIL_POLLER_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/timer_queue.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// source of events (e.g. I/O readiness) polled by the scheduler;
+// poll() moves the tasks waiting for an occurred event to the
+// ready-queue of the scheduler
+class poller
+{
+public:
+    virtual ~poller() {}
+
+    // true if no task waits for an event
+    virtual bool empty() const BOOST_NOEXCEPT = 0;
+
+    // waits for events until deadline (forever if 0); a
+    // deadline in the past polls without blocking
+    virtual void poll( clock_type::time_point const* deadline) = 0;
+
+    // thread-safe: a blocking poll() returns as soon as possible;
+    // if no poll() is in progress the next one does not block
+    virtual void interrupt() BOOST_NOEXCEPT = 0;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_POLLER_H
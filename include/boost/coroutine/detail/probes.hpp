@@ -0,0 +1,44 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_PROBES_H
+#define BOOST_COROUTINES_DETAIL_PROBES_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+// USDT probes (provider boost_coroutine) for systemtap, bpftrace, perf:
+// a single nop each, patched by the tracer when attached
+//   create(ctx, top, size)         execution context with a stack built
+//   switch_out(ctx, to, sp)        context left, sp of its caller
+//   switch_in(ctx, from, sp)       context entered, its saved sp
+//   complete(ctx)                  coroutine function returned
+//   unwind(ctx)                    stack of a suspended coroutine unwound
+//   stack_allocate(top, size)      stack mapped by a stack allocator
+//   stack_deallocate(top, size)    stack released by a stack allocator
+// enabled if <sys/sdt.h> is available, BOOST_COROUTINES_NO_PROBES
+// compiles them out
+#if ! defined(BOOST_COROUTINES_NO_PROBES) && defined(__linux__) && defined(__has_include)
+# if __has_include(<sys/sdt.h>)
+#  define BOOST_COROUTINES_HAS_PROBES
+# endif
+#endif
+
+#if defined(BOOST_COROUTINES_HAS_PROBES)
+# include <sys/sdt.h>
+# define BOOST_COROUTINES_PROBE1( name, a1) \
+    DTRACE_PROBE1( boost_coroutine, name, a1)
+# define BOOST_COROUTINES_PROBE2( name, a1, a2) \
+    DTRACE_PROBE2( boost_coroutine, name, a1, a2)
+# define BOOST_COROUTINES_PROBE3( name, a1, a2, a3) \
+    DTRACE_PROBE3( boost_coroutine, name, a1, a2, a3)
+#else
+# define BOOST_COROUTINES_PROBE1( name, a1) ( ( void) 0)
+# define BOOST_COROUTINES_PROBE2( name, a1, a2) ( ( void) 0)
+# define BOOST_COROUTINES_PROBE3( name, a1, a2, a3) ( ( void) 0)
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_PROBES_H
@@ -13,10 +13,14 @@
 #include <boost/throw_exception.hpp>
 #include <boost/utility.hpp>
 
+#include <boost/coroutine/detail/accounting.hpp>
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/registry.hpp>
 #include <boost/coroutine/detail/trampoline_pull.hpp>
 #include <boost/coroutine/exceptions.hpp>
 
@@ -39,6 +43,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
     R                   *   result_;
 
 public:
@@ -55,6 +63,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_pull, & flags_, callee_);
     }
 
     pull_coroutine_impl( coroutine_context * caller,
@@ -69,6 +78,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_pull, & flags_, callee_);
     }
 
     virtual ~pull_coroutine_impl() {}
@@ -91,16 +101,32 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -114,12 +140,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         result_ = from->data;
         if ( from->do_unwind) throw forced_unwind();
@@ -156,6 +186,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
     R                   *   result_;
 
 public:
@@ -172,6 +206,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_pull, & flags_, callee_);
     }
 
     pull_coroutine_impl( coroutine_context * caller,
@@ -186,6 +221,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_pull, & flags_, callee_);
     }
 
     virtual ~pull_coroutine_impl() {}
@@ -208,16 +244,32 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -231,12 +283,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         result_ = from->data;
         if ( from->do_unwind) throw forced_unwind();
@@ -273,6 +329,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
 
 public:
     typedef parameters< void >      param_type;
@@ -287,6 +347,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_pull, & flags_, callee_);
     }
 
     virtual ~pull_coroutine_impl() {}
@@ -309,16 +370,32 @@ public:
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     inline void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -332,12 +409,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
         if ( except_) rethrow_exception( except_);
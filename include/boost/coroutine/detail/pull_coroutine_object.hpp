@@ -16,6 +16,8 @@
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
+#include <boost/coroutine/detail/probes.hpp>
 #include <boost/coroutine/detail/pull_coroutine_impl.hpp>
 #include <boost/coroutine/detail/trampoline_pull.hpp>
 #include <boost/coroutine/exceptions.hpp>
@@ -65,6 +67,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -86,7 +89,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -105,7 +108,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run()
     {
@@ -125,6 +128,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
@@ -156,6 +160,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -177,7 +182,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -196,7 +201,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run()
     {
@@ -216,6 +221,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
@@ -247,6 +253,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -268,7 +275,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -287,7 +294,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run()
     {
@@ -307,6 +314,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
@@ -13,10 +13,14 @@
 #include <boost/throw_exception.hpp>
 #include <boost/utility.hpp>
 
+#include <boost/coroutine/detail/accounting.hpp>
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/registry.hpp>
 #include <boost/coroutine/detail/trampoline_push.hpp>
 #include <boost/coroutine/exceptions.hpp>
 
@@ -39,6 +43,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
 
 public:
     typedef parameters< Arg >                           param_type;
@@ -53,6 +61,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_push, & flags_, callee_);
     }
 
     bool force_unwind() const BOOST_NOEXCEPT
@@ -73,16 +82,32 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -96,12 +121,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( const_cast< Arg * >( & arg), this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
         if ( except_) rethrow_exception( except_);
@@ -114,12 +143,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( const_cast< Arg * >( & arg), this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
         if ( except_) rethrow_exception( except_);
@@ -136,6 +169,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
 
 public:
     typedef parameters< Arg & >                         param_type;
@@ -150,6 +187,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_push, & flags_, callee_);
     }
 
     bool force_unwind() const BOOST_NOEXCEPT
@@ -170,16 +208,32 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -193,12 +247,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( & arg, this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
         if ( except_) rethrow_exception( except_);
@@ -215,6 +273,10 @@ protected:
     exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    registry_hook           hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting              acct_;
+#endif
 
 public:
     typedef parameters< void >                          param_type;
@@ -229,6 +291,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_push, & flags_, callee_);
     }
 
     inline bool force_unwind() const BOOST_NOEXCEPT
@@ -249,16 +312,32 @@ public:
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     inline void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, callee_);
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_->jump(
                 * callee_,
                 reinterpret_cast< intptr_t >( & to),
                 preserve_fpu() );
+            BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+            BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
             flags_ &= ~flag_unwind_stack;
 
             BOOST_ASSERT( is_complete() );
@@ -272,12 +351,16 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
+        BOOST_COROUTINES_HOOK_ENTER( this, callee_);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 caller_->jump(
                     * callee_,
                     reinterpret_cast< intptr_t >( & to),
                     preserve_fpu() ) ) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_LEAVE( this, callee_, is_complete() );
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
         if ( except_) rethrow_exception( except_);
@@ -16,6 +16,8 @@
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
+#include <boost/coroutine/detail/probes.hpp>
 #include <boost/coroutine/detail/push_coroutine_impl.hpp>
 #include <boost/coroutine/detail/trampoline_push.hpp>
 #include <boost/coroutine/exceptions.hpp>
@@ -77,6 +79,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -98,7 +101,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -117,7 +120,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run( R * result)
     {
@@ -137,6 +140,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
@@ -168,6 +172,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -189,7 +194,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -208,7 +213,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run( R * result)
     {
@@ -228,6 +233,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
@@ -259,6 +265,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< base_t * >( obj), stack_ctx);
 #ifdef BOOST_COROUTINE_USE_FIBER
         obj->callee.destory();
 #endif
@@ -280,7 +287,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -299,7 +306,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< base_t * >( this), stack_ctx_); }
 
     void run()
     {
@@ -319,6 +326,7 @@ public:
         { base_t::except_ = current_exception(); }
 
         base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee);
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
         this->callee.jump(
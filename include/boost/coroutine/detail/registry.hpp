@@ -0,0 +1,86 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_REGISTRY_H
+#define BOOST_COROUTINES_DETAIL_REGISTRY_H
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+enum registry_kind
+{
+    registry_task = 0,
+    registry_pull,
+    registry_push,
+    registry_symmetric
+};
+
+struct registry_list;
+
+extern BOOST_COROUTINES_DECL atomic< bool > registry_on;
+
+// member of a control block: links the coroutine into the registry
+// list of the creating thread while the registry is enabled
+class BOOST_COROUTINES_DECL registry_hook : private noncopyable
+{
+public:
+    registry_hook() BOOST_NOEXCEPT :
+        next_( 0), prev_( 0), list_( 0), flags_( 0), ctx_( 0),
+        created_( 0), kind_( registry_task)
+    {}
+
+    ~registry_hook() BOOST_NOEXCEPT
+    { if ( 0 != list_) unlink_(); }
+
+    // ctx is the execution context of the coroutine - coroutines
+    // without a stack of their own (synthesized) are not registered
+    void link( registry_kind kind, int const* flags, coroutine_context * ctx) BOOST_NOEXCEPT
+    {
+        ctx_ = ctx;
+        if ( registry_on.load( memory_order_relaxed) && 0 != ctx->stack_ctx().sp)
+            link_( kind, flags);
+    }
+
+    // stored in the execution context (read by the registry and the
+    // profiler); the label must outlive the coroutine
+    void label( char const* label) BOOST_NOEXCEPT
+    { if ( 0 != ctx_->stack_ctx().sp) ctx_->label( label); }
+
+private:
+    friend struct registry_list;
+
+    registry_hook       *   next_;
+    registry_hook       *   prev_;
+    registry_list       *   list_;
+    int const           *   flags_;
+    coroutine_context   *   ctx_;
+    uint64_t                created_;
+    registry_kind           kind_;
+
+    void link_( registry_kind, int const*) BOOST_NOEXCEPT;
+
+    void unlink_() BOOST_NOEXCEPT;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_REGISTRY_H
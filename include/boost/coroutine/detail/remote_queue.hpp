@@ -0,0 +1,80 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_REMOTE_QUEUE_H
+#define BOOST_COROUTINES_DETAIL_REMOTE_QUEUE_H
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// lock-free multi-producer/single-consumer queue of tasks made
+// ready by other threads, linked through the remote hook of the
+// control blocks - no allocation
+// producers push onto a LIFO with one CAS; the consumer takes all
+// entries with one exchange and restores the FIFO order
+class remote_queue : private noncopyable
+{
+private:
+    atomic< task_base * >   head_;
+
+public:
+    remote_queue() BOOST_NOEXCEPT :
+        head_( 0)
+    {}
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == head_.load( memory_order_relaxed); }
+
+    // thread-safe; returns true if the queue was empty - only
+    // this push has to wake the consumer
+    bool push( task_base * t) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != t);
+
+        task_base * head = head_.load( memory_order_relaxed);
+        do
+        { t->remote_next_ = head; }
+        while ( ! head_.compare_exchange_weak( head, t, memory_order_release, memory_order_relaxed) );
+        return 0 == head;
+    }
+
+    // consumer only: removes all tasks and returns them in the
+    // order of the pushes, linked through remote_next()
+    task_base * take() BOOST_NOEXCEPT
+    {
+        if ( empty() ) return 0;
+        task_base * t = head_.exchange( 0, memory_order_acquire);
+        task_base * prev = 0;
+        while ( 0 != t)
+        {
+            task_base * next = t->remote_next_;
+            t->remote_next_ = prev;
+            prev = t;
+            t = next;
+        }
+        return prev;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_REMOTE_QUEUE_H
@@ -0,0 +1,53 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_SPINLOCK_H
+#define BOOST_COROUTINES_DETAIL_SPINLOCK_H
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// guards the wait-queues of the synchronization primitives against
+// tasks of other schedulers; held for a few pointer updates only
+class spinlock : private noncopyable
+{
+private:
+    atomic< bool >  locked_;
+
+public:
+    spinlock() BOOST_NOEXCEPT :
+        locked_( false)
+    {}
+
+    void lock() BOOST_NOEXCEPT
+    {
+        while ( locked_.exchange( true, memory_order_acquire) )
+            while ( locked_.load( memory_order_relaxed) )
+                this_thread::yield();
+    }
+
+    void unlock() BOOST_NOEXCEPT
+    { locked_.store( false, memory_order_release); }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_SPINLOCK_H
@@ -0,0 +1,43 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_STACK_SAMPLE_H
+#define BOOST_COROUTINES_DETAIL_STACK_SAMPLE_H
+
+#include <cstddef>
+#include <string>
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// called from a signal handler (async-signal-safe): the interrupted
+// instruction of `ucontext` followed by the return addresses of the
+// frames on the stack of `ctx`, walked along the frame pointers - on
+// the stack of a thread (`ctx` 0) only the interrupted instruction
+BOOST_COROUTINES_DECL std::size_t sample_stack(
+        void * ucontext, coroutine_context * ctx,
+        void const** pcs, std::size_t n) BOOST_NOEXCEPT;
+
+// demangled name of the function containing `pc` (dladdr()), the
+// module and offset if not exported
+BOOST_COROUTINES_DECL std::string symbol_name( void const* pc);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_STACK_SAMPLE_H
@@ -276,6 +276,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -536,6 +553,23 @@ public:
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -796,6 +830,23 @@ public:
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // labels the coroutine in the registry; the label must outlive it
+    void label( char const* label) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( impl_);
+        impl_->label( label);
+    }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    // transfers of control to the coroutine
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->resumes() : 0; }
+
+    // time stamp counter ticks spent inside the coroutine
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return 0 != impl_ ? impl_->cpu_ticks() : 0; }
+#endif
+
     inline void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
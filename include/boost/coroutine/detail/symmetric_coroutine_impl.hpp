@@ -12,10 +12,14 @@
 #include <boost/cstdint.hpp>
 #include <boost/utility.hpp>
 
+#include <boost/coroutine/detail/accounting.hpp>
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/registry.hpp>
 #include <boost/coroutine/detail/trampoline.hpp>
 #include <boost/coroutine/exceptions.hpp>
 #include <boost/coroutine/stack_context.hpp>
@@ -42,6 +46,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_symmetric, & flags_, & callee_);
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -64,13 +69,27 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, & callee_);
             flags_ |= flag_running;
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_RESUME( this);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_.jump(
                 callee_,
                 reinterpret_cast< intptr_t >( & to),
@@ -95,6 +114,8 @@ public:
 
         flags_ &= ~flag_running;
         param_type to;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -139,6 +160,10 @@ protected:
     int                 flags_;
     coroutine_context   caller_;
     coroutine_context   callee_;
+    registry_hook       hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting          acct_;
+#endif
 
     void resume_( param_type * to) BOOST_NOEXCEPT
     {
@@ -146,6 +171,8 @@ protected:
         BOOST_ASSERT( ! is_complete() );
 
         flags_ |= flag_running;
+        BOOST_COROUTINES_HOOK_RESUME( this);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         caller_.jump(
             callee_,
             reinterpret_cast< intptr_t >( to),
@@ -163,6 +190,10 @@ protected:
 
         other->caller_ = caller_;
         flags_ &= ~flag_running;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_RESUME( other);
+        BOOST_COROUTINES_ACCOUNT_ENTER( other->acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -190,6 +221,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_symmetric, & flags_, & callee_);
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -212,13 +244,27 @@ public:
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, & callee_);
             flags_ |= flag_running;
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_RESUME( this);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_.jump(
                 callee_,
                 reinterpret_cast< intptr_t >( & to),
@@ -243,6 +289,8 @@ public:
 
         flags_ &= ~flag_running;
         param_type to;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -287,6 +335,10 @@ protected:
     int                 flags_;
     coroutine_context   caller_;
     coroutine_context   callee_;
+    registry_hook       hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting          acct_;
+#endif
 
     void resume_( param_type * to) BOOST_NOEXCEPT
     {
@@ -294,6 +346,8 @@ protected:
         BOOST_ASSERT( ! is_complete() );
 
         flags_ |= flag_running;
+        BOOST_COROUTINES_HOOK_RESUME( this);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         caller_.jump(
             callee_,
             reinterpret_cast< intptr_t >( to),
@@ -311,6 +365,10 @@ protected:
 
         other->caller_ = caller_;
         flags_ &= ~flag_running;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_RESUME( other);
+        BOOST_COROUTINES_ACCOUNT_ENTER( other->acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -338,6 +396,7 @@ public:
     {
         if ( unwind) flags_ |= flag_force_unwind;
         if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_symmetric, & flags_, & callee_);
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -360,13 +419,27 @@ public:
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    uint64_t resumes() const BOOST_NOEXCEPT
+    { return acct_.resumes; }
+
+    uint64_t cpu_ticks() const BOOST_NOEXCEPT
+    { return acct_.ticks; }
+#endif
+
     inline void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
         {
             flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, & callee_);
             flags_ |= flag_running;
             param_type to( unwind_t::force_unwind);
+            BOOST_COROUTINES_HOOK_RESUME( this);
+            BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
             caller_.jump(
                 callee_,
                 reinterpret_cast< intptr_t >( & to),
@@ -385,6 +458,8 @@ public:
 
         param_type to( this);
         flags_ |= flag_running;
+        BOOST_COROUTINES_HOOK_RESUME( this);
+        BOOST_COROUTINES_ACCOUNT_ENTER( acct_);
         caller_.jump(
             callee_,
             reinterpret_cast< intptr_t >( & to),
@@ -399,6 +474,8 @@ public:
 
         flags_ &= ~flag_running;
         param_type to;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -441,6 +518,10 @@ protected:
     int                 flags_;
     coroutine_context   caller_;
     coroutine_context   callee_;
+    registry_hook       hook_;
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+    accounting          acct_;
+#endif
 
     template< typename Other >
     void yield_to_( Other * other, typename Other::param_type * to)
@@ -452,6 +533,10 @@ protected:
 
         other->caller_ = caller_;
         flags_ &= ~flag_running;
+        BOOST_COROUTINES_HOOK_SUSPEND( this);
+        BOOST_COROUTINES_ACCOUNT_LEAVE( acct_);
+        BOOST_COROUTINES_HOOK_RESUME( other);
+        BOOST_COROUTINES_ACCOUNT_ENTER( other->acct_);
         param_type * from(
             reinterpret_cast< param_type * >(
                 callee_.jump(
@@ -11,8 +11,11 @@
 #include <boost/config.hpp>
 #include <boost/move/move.hpp>
 
+#include <boost/coroutine/detail/accounting.hpp>
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/hooks.hpp>
+#include <boost/coroutine/detail/probes.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_impl.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_yield.hpp>
 #include <boost/coroutine/exceptions.hpp>
@@ -45,6 +48,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< impl_t * >( obj), stack_ctx);
         obj->~obj_t();
         stack_alloc.deallocate( stack_ctx);
     }
@@ -61,7 +65,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 #endif
 
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -78,7 +82,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 
     void run( R * r) BOOST_NOEXCEPT
     {
@@ -97,8 +101,11 @@ public:
         { std::terminate(); }
 
         impl_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee_);
         impl_t::flags_ &= ~flag_running;
         typename impl_t::param_type to;
+        BOOST_COROUTINES_HOOK_COMPLETE( static_cast< impl_t * >( this) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( impl_t::acct_);
         impl_t::callee_.jump(
             impl_t::caller_, 
             reinterpret_cast< intptr_t >( & to),
@@ -126,6 +133,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< impl_t * >( obj), stack_ctx);
         obj->~obj_t();
         stack_alloc.deallocate( stack_ctx);
     }
@@ -142,7 +150,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 #endif
 
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -159,7 +167,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 
     void run( R * r) BOOST_NOEXCEPT
     {
@@ -178,8 +186,11 @@ public:
         { std::terminate(); }
 
         impl_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee_);
         impl_t::flags_ &= ~flag_running;
         typename impl_t::param_type to;
+        BOOST_COROUTINES_HOOK_COMPLETE( static_cast< impl_t * >( this) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( impl_t::acct_);
         impl_t::callee_.jump(
             impl_t::caller_, 
             reinterpret_cast< intptr_t >( & to),
@@ -207,6 +218,7 @@ private:
         stack_context stack_ctx( obj->stack_ctx_);
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
+        BOOST_COROUTINES_HOOK_DESTROY( static_cast< impl_t * >( obj), stack_ctx);
         obj->~obj_t();
         stack_alloc.deallocate( stack_ctx);
     }
@@ -223,7 +235,7 @@ public:
         fn_( fn),
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 #endif
 
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
@@ -240,7 +252,7 @@ public:
 #endif
         stack_ctx_( stack_ctx),
         stack_alloc_( stack_alloc)
-    {}
+    { BOOST_COROUTINES_HOOK_CREATE( static_cast< impl_t * >( this), stack_ctx_); }
 
     void run() BOOST_NOEXCEPT
     {
@@ -259,8 +271,11 @@ public:
         { std::terminate(); }
 
         impl_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee_);
         impl_t::flags_ &= ~flag_running;
         typename impl_t::param_type to;
+        BOOST_COROUTINES_HOOK_COMPLETE( static_cast< impl_t * >( this) );
+        BOOST_COROUTINES_ACCOUNT_LEAVE( impl_t::acct_);
         impl_t::callee_.jump(
             impl_t::caller_, 
             reinterpret_cast< intptr_t >( & to),
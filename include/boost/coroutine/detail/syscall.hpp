@@ -0,0 +1,58 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_SYSCALL_H
+#define BOOST_COROUTINES_DETAIL_SYSCALL_H
+
+#include <cstddef>
+
+extern "C" {
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// Linux only: the reactor and the io_engine operate on descriptors
+// they own - the calls bypass the replacements of read(), write() and
+// connect() installed by boost_coroutine_interpose; close() is left to
+// libc, the replacement forgets the state of the descriptor
+
+inline ssize_t sys_read( int fd, void * buf, std::size_t size) BOOST_NOEXCEPT
+{ return static_cast< ssize_t >( ::syscall( SYS_read, fd, buf, size) ); }
+
+inline ssize_t sys_write( int fd, void const* buf, std::size_t size) BOOST_NOEXCEPT
+{ return static_cast< ssize_t >( ::syscall( SYS_write, fd, buf, size) ); }
+
+inline int sys_connect( int fd, sockaddr const* addr, socklen_t len) BOOST_NOEXCEPT
+{
+#if defined(SYS_connect)
+    return static_cast< int >( ::syscall( SYS_connect, fd, addr, len) );
+#else
+    // multiplexed by socketcall() (i386 before Linux 4.3) - the
+    // replacement passes descriptors of the reactor through
+    return ::connect( fd, addr, len);
+#endif
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_SYSCALL_H
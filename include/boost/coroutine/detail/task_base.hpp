@@ -0,0 +1,203 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_TASK_BASE_H
+#define BOOST_COROUTINES_DETAIL_TASK_BASE_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/registry.hpp>
+#include <boost/coroutine/detail/trampoline.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+class scheduler;
+class task_group;
+
+namespace detail {
+
+class remote_queue;
+class task_queue;
+
+// control block of a coroutine driven by a scheduler
+// the block lives on top of the coroutine-stack; the hooks
+// make it a member of exactly one queue (ready-queue of the
+// scheduler or wait-queue of a synchronization primitive)
+class task_base : private noncopyable
+{
+public:
+    typedef parameters< void >                          param_type;
+
+    task_base( stack_context const& stack_ctx,
+               bool unwind, bool preserve_fpu) BOOST_NOEXCEPT :
+        flags_( 0),
+        except_(),
+        owner_( 0),
+        group_( 0),
+        caller_(),
+        callee_( trampoline_void< task_base >, stack_ctx),
+        next_( 0),
+        prev_( 0),
+        queue_( 0),
+        live_next_( 0),
+        live_prev_( 0),
+        group_next_( 0),
+        group_prev_( 0),
+        remote_next_( 0)
+    {
+        if ( unwind) flags_ |= flag_force_unwind;
+        if ( preserve_fpu) flags_ |= flag_preserve_fpu;
+        hook_.link( registry_task, & flags_, & callee_);
+    }
+
+    virtual ~task_base() {}
+
+    bool force_unwind() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_force_unwind); }
+
+    bool unwind_requested() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_unwind_stack); }
+
+    bool preserve_fpu() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_preserve_fpu); }
+
+    bool is_started() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_started); }
+
+    bool is_running() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_running); }
+
+    bool is_complete() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_complete); }
+
+    void label( char const* label) BOOST_NOEXCEPT
+    { hook_.label( label); }
+
+    bool is_linked() const BOOST_NOEXCEPT
+    { return 0 != queue_; }
+
+    // true while the task waits to be scheduled by another thread
+    bool remote_wakeup_pending() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_remote_wakeup); }
+
+    scheduler * owner() const BOOST_NOEXCEPT
+    { return owner_; }
+
+    void owner( scheduler * sched) BOOST_NOEXCEPT
+    { owner_ = sched; }
+
+    task_group * group() const BOOST_NOEXCEPT
+    { return group_; }
+
+    exception_ptr exception() const
+    { return except_; }
+
+    void unwind_stack() BOOST_NOEXCEPT
+    {
+        if ( is_started() && ! is_complete() && force_unwind() )
+        {
+            flags_ |= flag_unwind_stack;
+            BOOST_COROUTINES_PROBE1( unwind, & callee_);
+            flags_ |= flag_running;
+            param_type to( unwind_t::force_unwind);
+            caller_.jump(
+                callee_,
+                reinterpret_cast< intptr_t >( & to),
+                preserve_fpu() );
+            flags_ &= ~flag_running;
+            flags_ &= ~flag_unwind_stack;
+
+            BOOST_ASSERT( is_complete() );
+        }
+    }
+
+    // called by the scheduler: enter the coroutine until it
+    // suspends or completes
+    void resume() BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( ! is_running() );
+        BOOST_ASSERT( ! is_complete() );
+
+        flags_ |= flag_running;
+        param_type to( this);
+        caller_.jump(
+            callee_,
+            reinterpret_cast< intptr_t >( & to),
+            preserve_fpu() );
+        flags_ &= ~flag_running;
+    }
+
+    // called from inside the coroutine: return to the scheduler
+    void suspend()
+    {
+        BOOST_ASSERT( is_running() );
+        BOOST_ASSERT( ! is_complete() );
+
+        param_type to;
+        param_type * from(
+            reinterpret_cast< param_type * >(
+                callee_.jump(
+                    caller_,
+                    reinterpret_cast< intptr_t >( & to),
+                    preserve_fpu() ) ) );
+        if ( from->do_unwind) throw forced_unwind();
+    }
+
+    virtual void run() = 0;
+
+    virtual void destroy() = 0;
+
+protected:
+    friend class remote_queue;
+    friend class task_queue;
+    friend class coroutines::scheduler;
+    friend class coroutines::task_group;
+
+    int                 flags_;
+    exception_ptr       except_;
+    scheduler       *   owner_;
+    task_group      *   group_;
+    coroutine_context   caller_;
+    coroutine_context   callee_;
+    registry_hook       hook_;
+
+private:
+    // hooks of ready- or wait-queue
+    task_base       *   next_;
+    task_base       *   prev_;
+    task_queue      *   queue_;
+    // hooks of the scheduler's list of live tasks
+    task_base       *   live_next_;
+    task_base       *   live_prev_;
+    // hooks of the task_group's list of children
+    task_base       *   group_next_;
+    task_base       *   group_prev_;
+    // hook of the scheduler's queue of remotely scheduled tasks
+    task_base       *   remote_next_;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_TASK_BASE_H
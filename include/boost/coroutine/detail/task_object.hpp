@@ -0,0 +1,101 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_TASK_OBJECT_H
+#define BOOST_COROUTINES_DETAIL_TASK_OBJECT_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/flags.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+template< typename Fn, typename StackAllocator >
+class task_object : public task_base
+{
+private:
+    typedef task_base                               base_t;
+    typedef task_object< Fn, StackAllocator >       obj_t;
+
+    Fn                  fn_;
+    stack_context       stack_ctx_;
+    StackAllocator      stack_alloc_;
+
+    static void deallocate_( obj_t * obj)
+    {
+        stack_context stack_ctx( obj->stack_ctx_);
+        StackAllocator stack_alloc( obj->stack_alloc_);
+        obj->unwind_stack();
+#ifdef BOOST_COROUTINE_USE_FIBER
+        obj->callee_.destory();
+#endif
+        obj->~obj_t();
+        stack_alloc.deallocate( stack_ctx);
+    }
+
+public:
+    template< typename F >
+    task_object( BOOST_FWD_REF( F) fn, attributes const& attrs,
+                 stack_context const& stack_ctx,
+                 stack_context const& internal_stack_ctx,
+                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
+        base_t( internal_stack_ctx,
+                stack_unwind == attrs.do_unwind,
+                fpu_preserved == attrs.preserve_fpu),
+        fn_( boost::forward< F >( fn) ),
+        stack_ctx_( stack_ctx),
+        stack_alloc_( stack_alloc)
+    {}
+
+    void run()
+    {
+        BOOST_ASSERT( ! base_t::unwind_requested() );
+
+        base_t::flags_ |= flag_started;
+        try
+        { fn_(); }
+        catch ( forced_unwind const&)
+        {}
+        catch (...)
+        { base_t::except_ = current_exception(); }
+
+        base_t::flags_ |= flag_complete;
+        BOOST_COROUTINES_PROBE1( complete, & this->callee_);
+        param_type to;
+        base_t::callee_.jump(
+            base_t::caller_,
+            reinterpret_cast< intptr_t >( & to),
+            base_t::preserve_fpu() );
+        BOOST_ASSERT_MSG( false, "task is complete");
+    }
+
+    void destroy()
+    { deallocate_( this); }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_TASK_OBJECT_H
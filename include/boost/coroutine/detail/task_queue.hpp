@@ -0,0 +1,101 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_TASK_QUEUE_H
+#define BOOST_COROUTINES_DETAIL_TASK_QUEUE_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// intrusive FIFO of tasks, linked through the hooks
+// of the control blocks - no allocation
+class task_queue : private noncopyable
+{
+private:
+    task_base   *   head_;
+    task_base   *   tail_;
+    std::size_t     size_;
+
+public:
+    task_queue() BOOST_NOEXCEPT :
+        head_( 0),
+        tail_( 0),
+        size_( 0)
+    {}
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == head_; }
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return size_; }
+
+    task_base * front() const BOOST_NOEXCEPT
+    { return head_; }
+
+    bool contains( task_base * t) const BOOST_NOEXCEPT
+    { return this == t->queue_; }
+
+    void push( task_base * t) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != t);
+        BOOST_ASSERT( ! t->is_linked() );
+
+        t->queue_ = this;
+        t->next_ = 0;
+        t->prev_ = tail_;
+        if ( 0 != tail_) tail_->next_ = t;
+        else head_ = t;
+        tail_ = t;
+        ++size_;
+    }
+
+    task_base * pop() BOOST_NOEXCEPT
+    {
+        task_base * t = head_;
+        if ( 0 != t) erase( t);
+        return t;
+    }
+
+    void erase( task_base * t) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( contains( t) );
+
+        if ( 0 != t->prev_) t->prev_->next_ = t->next_;
+        else head_ = t->next_;
+        if ( 0 != t->next_) t->next_->prev_ = t->prev_;
+        else tail_ = t->prev_;
+        t->next_ = t->prev_ = 0;
+        t->queue_ = 0;
+        --size_;
+    }
+
+    void splice( task_queue & other) BOOST_NOEXCEPT
+    {
+        while ( ! other.empty() )
+            push( other.pop() );
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_TASK_QUEUE_H
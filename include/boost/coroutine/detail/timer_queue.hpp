@@ -0,0 +1,267 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_TIMER_QUEUE_H
+#define BOOST_COROUTINES_DETAIL_TIMER_QUEUE_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+// granularity of the timing wheel; deadlines expire at most
+// one tick late, never early
+#ifndef BOOST_COROUTINES_TIMER_RESOLUTION_US
+# define BOOST_COROUTINES_TIMER_RESOLUTION_US 1000
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+typedef chrono::steady_clock                clock_type;
+
+// deadline registered at a scheduler; owned by the waiting
+// coroutine (lives on its stack), fn is invoked on expiry
+struct timer_node
+{
+    clock_type::time_point      deadline;
+    void                    (*  fn)( timer_node *);
+    timer_node              *   next;
+    timer_node             **   pprev;
+    uint64_t                    tick;
+    unsigned                    slot;
+
+    timer_node() BOOST_NOEXCEPT :
+        deadline(), fn( 0), next( 0), pprev( 0), tick( 0), slot( 0)
+    {}
+
+    timer_node( clock_type::time_point const& deadline_,
+                void (* fn_)( timer_node *) ) BOOST_NOEXCEPT :
+        deadline( deadline_), fn( fn_), next( 0), pprev( 0), tick( 0), slot( 0)
+    {}
+
+    bool is_linked() const BOOST_NOEXCEPT
+    { return 0 != pprev; }
+};
+
+// hierarchical timing wheel: levels of 64 slots, a slot of level
+// L spans 64^L ticks; a node is linked into the slot of the lowest
+// level whose span contains its tick, hence push() and erase()
+// are O(1); when the wheel enters a slot of a higher level its
+// nodes cascade down (at most once per level)
+// the occupied slots are tracked by one bitmap per level, advancing
+// over a long idle period jumps directly to the next occupied slot
+class timer_queue : private noncopyable
+{
+private:
+    enum
+    {
+        slot_bits = 6,
+        slots = 1 << slot_bits,
+        levels = 6,
+        // nodes already due resp. beyond the span of the top level
+        due_slot = levels * slots,
+        overflow_slot = due_slot + 1
+    };
+
+    clock_type::time_point      origin_;
+    uint64_t                    now_;
+    std::size_t                 size_;
+    uint64_t                    bitmaps_[levels];
+    timer_node              *   heads_[levels * slots + 2];
+
+    static clock_type::duration resolution_() BOOST_NOEXCEPT
+    { return chrono::microseconds( BOOST_COROUTINES_TIMER_RESOLUTION_US); }
+
+    static unsigned ctz_( uint64_t x) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != x);
+#if defined(__GNUC__)
+        return static_cast< unsigned >( __builtin_ctzll( x) );
+#else
+        unsigned n = 0;
+        for ( ; 0 == ( x & 1); x >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    // ticks since origin_; deadlines round up, the clock rounds down
+    uint64_t ticks_( clock_type::time_point const& tp, bool round_up) const BOOST_NOEXCEPT
+    {
+        if ( tp <= origin_) return 0;
+        clock_type::duration::rep d = ( tp - origin_).count();
+        clock_type::duration::rep r = resolution_().count();
+        return static_cast< uint64_t >( round_up ? d / r + ( 0 != d % r ? 1 : 0) : d / r);
+    }
+
+    clock_type::time_point time_point_( uint64_t tick) const BOOST_NOEXCEPT
+    { return origin_ + resolution_() * static_cast< clock_type::duration::rep >( tick); }
+
+    void link_( timer_node * n) BOOST_NOEXCEPT
+    {
+        unsigned slot = due_slot;
+        if ( n->tick > now_)
+        {
+            // the highest digit in which tick and now_ differ
+            // selects the level
+            uint64_t x = n->tick ^ now_;
+            if ( 0 != ( x >> ( slot_bits * levels) ) ) slot = overflow_slot;
+            else
+            {
+                unsigned level = 0;
+                while ( 0 != ( x >> ( slot_bits * ( level + 1) ) ) ) ++level;
+                unsigned pos = static_cast< unsigned >(
+                        ( n->tick >> ( slot_bits * level) ) & ( slots - 1) );
+                slot = level * slots + pos;
+                bitmaps_[level] |= static_cast< uint64_t >( 1) << pos;
+            }
+        }
+        n->slot = slot;
+        n->pprev = & heads_[slot];
+        n->next = heads_[slot];
+        if ( 0 != n->next) n->next->pprev = & n->next;
+        heads_[slot] = n;
+    }
+
+    void unlink_( timer_node * n) BOOST_NOEXCEPT
+    {
+        * n->pprev = n->next;
+        if ( 0 != n->next) n->next->pprev = n->pprev;
+        if ( n->slot < due_slot && 0 == heads_[n->slot])
+            bitmaps_[n->slot / slots] &= ~( static_cast< uint64_t >( 1) << ( n->slot % slots) );
+        n->next = 0;
+        n->pprev = 0;
+    }
+
+    // re-links the nodes of a slot relative to now_
+    void cascade_( unsigned slot) BOOST_NOEXCEPT
+    {
+        timer_node * n = heads_[slot];
+        heads_[slot] = 0;
+        if ( slot < due_slot)
+            bitmaps_[slot / slots] &= ~( static_cast< uint64_t >( 1) << ( slot % slots) );
+        while ( 0 != n)
+        {
+            timer_node * next = n->next;
+            link_( n);
+            n = next;
+        }
+    }
+
+    // first tick after now_ entering an occupied slot
+    uint64_t next_tick_() const BOOST_NOEXCEPT
+    {
+        for ( unsigned level = 0; level < levels; ++level)
+        {
+            unsigned shift = slot_bits * level;
+            unsigned pos = static_cast< unsigned >( ( now_ >> shift) & ( slots - 1) );
+            // slots behind the current position (2 << 63 wraps to 0)
+            uint64_t mask = bitmaps_[level] & ~( ( static_cast< uint64_t >( 2) << pos) - 1);
+            if ( 0 == mask) continue;
+            uint64_t base = ( now_ >> ( shift + slot_bits) ) << ( shift + slot_bits);
+            return base | ( static_cast< uint64_t >( ctz_( mask) ) << shift);
+        }
+        if ( 0 != heads_[overflow_slot])
+            return ( ( now_ >> ( slot_bits * levels) ) + 1) << ( slot_bits * levels);
+        return static_cast< uint64_t >( -1);
+    }
+
+    void advance_( uint64_t tick) BOOST_NOEXCEPT
+    {
+        now_ = tick;
+        if ( 0 == ( tick & ( ( static_cast< uint64_t >( 1) << ( slot_bits * levels) ) - 1) ) )
+            cascade_( overflow_slot);
+        for ( unsigned level = levels; 0 < level--; )
+        {
+            unsigned shift = slot_bits * level;
+            if ( 0 != ( tick & ( ( static_cast< uint64_t >( 1) << shift) - 1) ) ) continue;
+            cascade_( level * slots + static_cast< unsigned >( ( tick >> shift) & ( slots - 1) ) );
+        }
+    }
+
+public:
+    timer_queue() :
+        origin_( clock_type::now() ),
+        now_( 0),
+        size_( 0)
+    {
+        for ( unsigned i = 0; i < levels; ++i) bitmaps_[i] = 0;
+        for ( unsigned i = 0; i < levels * slots + 2; ++i) heads_[i] = 0;
+    }
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == size_; }
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return size_; }
+
+    // expiry of the earliest deadline rounded up to the tick; might
+    // be earlier if the node has not yet cascaded to the lowest level
+    clock_type::time_point deadline() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( ! empty() );
+        if ( 0 != heads_[due_slot]) return time_point_( now_);
+        return time_point_( next_tick_() );
+    }
+
+    void push( timer_node * n) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != n);
+        BOOST_ASSERT( ! n->is_linked() );
+
+        n->tick = ticks_( n->deadline, true);
+        link_( n);
+        ++size_;
+    }
+
+    void erase( timer_node * n) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( n->is_linked() );
+
+        unlink_( n);
+        --size_;
+    }
+
+    // invokes fn of all nodes with a deadline not after now
+    std::size_t expire( clock_type::time_point const& now)
+    {
+        uint64_t tick = ticks_( now, false);
+        std::size_t n = 0;
+        for (;;)
+        {
+            // fn might push or erase nodes
+            while ( 0 != heads_[due_slot])
+            {
+                timer_node * t = heads_[due_slot];
+                erase( t);
+                t->fn( t);
+                ++n;
+            }
+            if ( tick <= now_) break;
+            uint64_t next = next_tick_();
+            advance_( next < tick ? next : tick);
+        }
+        return n;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_TIMER_QUEUE_H
@@ -0,0 +1,54 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_TRACE_H
+#define BOOST_COROUTINES_DETAIL_TRACE_H
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+enum trace_event
+{
+    trace_create = 0,
+    trace_resume,
+    trace_suspend,
+    trace_complete
+};
+
+// fixed-size binary record of the per-thread ring buffers
+struct trace_record
+{
+    uint64_t        ts;     // nano seconds of clock_type
+    void const  *   task;
+    uint32_t        event;
+};
+
+extern BOOST_COROUTINES_DECL atomic< bool > trace_on;
+
+BOOST_COROUTINES_DECL void trace_append( trace_event, void const*) BOOST_NOEXCEPT;
+
+// a relaxed load and a branch while tracing is off
+inline
+void trace( trace_event e, void const* task) BOOST_NOEXCEPT
+{ if ( trace_on.load( memory_order_relaxed) ) trace_append( e, task); }
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_TRACE_H
@@ -12,6 +12,7 @@
 #include <boost/cstdint.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -24,6 +25,8 @@ namespace detail {
 template< typename Coro >
 void trampoline_pull( intptr_t vp)
 {
+    BOOST_COROUTINES_ENTRY_FRAME();
+
     typedef typename Coro::param_type   param_type;
 
     BOOST_ASSERT( 0 != vp);
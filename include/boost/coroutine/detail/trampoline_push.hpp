@@ -16,6 +16,7 @@
 #include <boost/move/move.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
 #include <boost/coroutine/detail/setup.hpp>
@@ -34,6 +35,8 @@ namespace detail {
 template< typename Coro >
 void trampoline_push( intptr_t vp)
 {
+    BOOST_COROUTINES_ENTRY_FRAME();
+
     typedef typename Coro::param_type   param_type;
 
     BOOST_ASSERT( vp);
@@ -53,6 +56,8 @@ void trampoline_push( intptr_t vp)
 template< typename Coro >
 void trampoline_push_void( intptr_t vp)
 {
+    BOOST_COROUTINES_ENTRY_FRAME();
+
     typedef typename Coro::param_type   param_type;
 
     BOOST_ASSERT( vp);
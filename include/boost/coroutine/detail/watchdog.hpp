@@ -0,0 +1,50 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_WATCHDOG_H
+#define BOOST_COROUTINES_DETAIL_WATCHDOG_H
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// the part of the state of a watched thread written on the switch path
+struct watch_slot
+{
+    // watchdog clock at the last switch into a coroutine, 0 after a
+    // switch to the context of the thread
+    atomic< uint64_t >  resumed;
+
+    watch_slot() :
+        resumed( 0)
+    {}
+};
+
+// milliseconds, advanced by the monitor thread of the watchdog
+extern BOOST_COROUTINES_DECL atomic< uint64_t > watch_clock;
+
+extern BOOST_COROUTINES_DECL atomic< bool > watch_on;
+
+// registers the calling thread with the watchdog (0 if out of memory);
+// kept until the process exits
+BOOST_COROUTINES_DECL watch_slot * watch_thread() BOOST_NOEXCEPT;
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_WATCHDOG_H
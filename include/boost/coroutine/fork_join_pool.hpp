@@ -0,0 +1,213 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_FORK_JOIN_POOL_H
+#define BOOST_COROUTINES_FORK_JOIN_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/type_traits/decay.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/fork_join_task.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+struct fork_join_worker;
+
+template< typename Fn >
+class fork_join_task_object;
+
+}
+
+// runs fork-join tasks on a set of worker threads
+// spawn() starts the child immediately on the current worker; the
+// continuation of the parent is pushed to the worker's deque and
+// can be stolen by an idle worker (work-first, Cilk-style)
+// each child runs on its own stack, so at most one stack per
+// nesting level and worker is live; stacks are cached per worker
+class BOOST_COROUTINES_DECL fork_join_pool : private noncopyable
+{
+private:
+    template< typename Fn >
+    friend class detail::fork_join_task_object;
+
+    std::vector< detail::fork_join_worker * >   workers_;
+    thread_group                                threads_;
+    attributes                                  attrs_;
+    mutex                                       mtx_;
+    condition_variable                          cond_;
+    std::deque< detail::fork_join_task * >      inject_;
+    atomic< std::size_t >                       active_;
+    atomic< bool >                              stop_;
+
+    static void entry_( intptr_t);
+
+    static detail::fork_join_worker * worker_() BOOST_NOEXCEPT;
+
+    static detail::fork_join_task * post_( detail::fork_join_worker *);
+
+    static bool allocate_( stack_context &);
+
+    static void deallocate_( stack_context &) BOOST_NOEXCEPT;
+
+    static void spawn_( detail::fork_join_task *);
+
+    static void wait_( detail::fork_join_task *) BOOST_NOEXCEPT;
+
+    static void complete_( detail::fork_join_task *) BOOST_NOEXCEPT;
+
+    void loop_( detail::fork_join_worker *);
+
+    detail::fork_join_task * steal_( detail::fork_join_worker *) BOOST_NOEXCEPT;
+
+    void submit_( detail::fork_join_task *, detail::fork_join_root &);
+
+    template< typename Fn >
+    static detail::fork_join_task * create_( BOOST_FWD_REF( Fn) fn,
+                                             stack_context const& stack_ctx,
+                                             bool preserve_fpu)
+    {
+        typedef detail::fork_join_task_object<
+            typename decay< Fn >::type
+        >                                                       object_t;
+        // reserve space on top of the stack for the task object
+        stack_context internal_stack_ctx;
+        internal_stack_ctx.sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        BOOST_ASSERT( 0 != internal_stack_ctx.sp);
+        internal_stack_ctx.size = stack_ctx.size - sizeof( object_t);
+        BOOST_ASSERT( 0 < internal_stack_ctx.size);
+        return new ( internal_stack_ctx.sp) object_t(
+                boost::forward< Fn >( fn), stack_ctx, internal_stack_ctx, preserve_fpu);
+    }
+
+public:
+    explicit fork_join_pool( std::size_t workers = thread::hardware_concurrency(),
+                             attributes const& attrs = attributes() );
+
+    ~fork_join_pool();
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return workers_.size(); }
+
+    // executes fn as root task on the workers and blocks the
+    // calling thread until fn and all its children are complete
+    // an exception escaping from fn (or from a child not joined
+    // by fn) is re-thrown
+    template< typename Fn >
+    void run( BOOST_FWD_REF( Fn) fn)
+    {
+        stack_context stack_ctx;
+        stack_allocator().allocate( stack_ctx, attrs_.size);
+        detail::fork_join_task * t = 0;
+        try
+        {
+            t = create_( boost::forward< Fn >( fn), stack_ctx,
+                         fpu_preserved == attrs_.preserve_fpu);
+        }
+        catch (...)
+        {
+            stack_allocator().deallocate( stack_ctx);
+            throw;
+        }
+        detail::fork_join_root root;
+        submit_( t, root);
+        if ( root.except) rethrow_exception( root.except);
+    }
+
+    // forks fn as child of the calling task; must be called
+    // from inside a task of a fork_join_pool
+    template< typename Fn >
+    static void spawn( BOOST_FWD_REF( Fn) fn)
+    {
+        stack_context stack_ctx;
+        bool preserve_fpu = allocate_( stack_ctx);
+        detail::fork_join_task * t = 0;
+        try
+        { t = create_( boost::forward< Fn >( fn), stack_ctx, preserve_fpu); }
+        catch (...)
+        {
+            deallocate_( stack_ctx);
+            throw;
+        }
+        spawn_( t);
+    }
+
+    // suspends the calling task until all children spawned by it
+    // are complete; re-throws the first exception of a child
+    static void sync();
+};
+
+namespace detail {
+
+template< typename Fn >
+class fork_join_task_object : public fork_join_task
+{
+private:
+    typedef fork_join_task_object< Fn >     obj_t;
+
+    Fn                  fn_;
+    stack_context       stack_ctx_;
+
+public:
+    template< typename F >
+    fork_join_task_object( BOOST_FWD_REF( F) fn,
+                           stack_context const& stack_ctx,
+                           stack_context const& internal_stack_ctx,
+                           bool preserve_fpu) :
+        fork_join_task( & fork_join_pool::entry_, internal_stack_ctx, preserve_fpu),
+        fn_( boost::forward< F >( fn) ),
+        stack_ctx_( stack_ctx)
+    {}
+
+    void run()
+    {
+        try
+        { fn_(); }
+        catch (...)
+        { set_exception( current_exception() ); }
+        // implicit sync - children might reference the stack
+        fork_join_pool::complete_( this);
+        BOOST_ASSERT_MSG( false, "task is complete");
+    }
+
+    void destroy()
+    {
+        stack_context stack_ctx( stack_ctx_);
+        this->~obj_t();
+        fork_join_pool::deallocate_( stack_ctx);
+    }
+};
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_FORK_JOIN_POOL_H
@@ -0,0 +1,62 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_HOOKS_H
+#define BOOST_COROUTINES_HOOKS_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// lifecycle events of the asymmetric and symmetric coroutines of code
+// compiled with BOOST_COROUTINES_RUNTIME_HOOKS; `coro` identifies the
+// coroutine from creation to destruction
+// called on the thread of the event - must not throw
+class coroutine_hooks
+{
+public:
+    virtual ~coroutine_hooks() {}
+
+    // the control block was constructed on the stack
+    virtual void on_create( void const*, stack_context const&) {}
+
+    // control is transferred to the coroutine
+    virtual void on_resume( void const*) {}
+
+    // control leaves the coroutine, which is not complete
+    virtual void on_suspend( void const*) {}
+
+    // the coroutine function returned (or the stack was unwound)
+    virtual void on_complete( void const*) {}
+
+    // the control block is destroyed, the stack deallocated next
+    virtual void on_destroy( void const*, stack_context const&) {}
+};
+
+namespace hooks {
+
+// installs the hooks of all threads (0 uninstalls); the hooks must
+// outlive the events dispatched to them
+BOOST_COROUTINES_DECL void install( coroutine_hooks *) BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL coroutine_hooks * installed() BOOST_NOEXCEPT;
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_HOOKS_H
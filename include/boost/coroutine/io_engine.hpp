@@ -0,0 +1,188 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_IO_ENGINE_H
+#define BOOST_COROUTINES_IO_ENGINE_H
+
+#include <cstddef>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/poller.hpp>
+#include <boost/coroutine/reactor.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+struct uring;
+struct uring_op;
+
+}
+
+enum io_backend
+{
+    io_backend_auto = 0,
+    io_backend_epoll
+};
+
+// completion-based I/O on io_uring; the active task submits an
+// operation and suspends, run() submits all pending operations and
+// reaps the completions in one io_uring_enter() and resumes the
+// completed tasks directly
+// if io_uring is not available (or io_backend_epoll is requested)
+// the operations are executed by a reactor (sockets) resp. by
+// pread()/pwrite() (regular files)
+class BOOST_COROUTINES_DECL io_engine : public detail::poller, private noncopyable
+{
+public:
+    typedef detail::clock_type                  clock_type;
+
+private:
+    scheduler               *   sched_;
+    detail::uring           *   ring_;
+    reactor                 *   reactor_;
+    detail::uring_op        *   inflight_;
+    // operations of inflight_ to be canceled
+    std::size_t                 cancels_;
+    // eventfd signalled by interrupt(), polled while waiting
+    int                         evfd_;
+    bool                        armed_;
+    std::vector< iovec >        buffers_;
+    std::vector< int >          files_;
+    // max. time an entry waits for its submission, start of the batch
+    clock_type::duration        latency_;
+    clock_type::time_point      batch_start_;
+
+    // submits an operation for the active task, suspends it
+    // until the completion and returns the result (-errno on error)
+    int execute_( int op, int fd, void const* addr, std::size_t len,
+                  uint64_t off, uint32_t op_flags, int buf_index);
+
+    // waits until fd is readable/writable (non-blocking descriptors)
+    int poll_fd_( int fd, uint32_t events);
+
+    // moves at most n completed operations from the completion
+    // queue to tasks; returns the number of tasks
+    std::size_t reap_( detail::task_base ** tasks, std::size_t n) BOOST_NOEXCEPT;
+
+    int buffer_( void const* buf, std::size_t size) const BOOST_NOEXCEPT;
+
+    // submits the poll of the eventfd unless already pending
+    void arm_();
+
+    // submits the cancellations requested by remove() - as many as
+    // the submission queue takes
+    void cancel_();
+
+    // submits the pending entries if the batch is older than latency_
+    void flush_();
+
+public:
+    explicit io_engine( scheduler & sched,
+                        io_backend backend = io_backend_auto,
+                        unsigned entries = 256);
+
+    // unwinds the tasks waiting for a completion
+    ~io_engine();
+
+    bool uses_io_uring() const BOOST_NOEXCEPT
+    { return 0 != ring_; }
+
+    // entries prepared by the tasks resumed during one tick of the
+    // scheduler are submitted together (one io_uring_enter()) before
+    // the scheduler waits; an entry prepared later than d after the
+    // first entry of the batch submits the batch at once
+    // zero submits each entry immediately, max() (the default) once
+    // per tick; without io_uring the setting has no effect
+    void batch_latency( clock_type::duration const& d) BOOST_NOEXCEPT
+    { latency_ = d; }
+
+    clock_type::duration batch_latency() const BOOST_NOEXCEPT
+    { return latency_; }
+
+    // prepares fd for the operations of the engine
+    void add( int fd, system::error_code & ec);
+
+    void add( int fd);
+
+    // pending operations on fd fail with operation_canceled; with a
+    // full submission queue the cancellations are submitted by the
+    // next poll()
+    void remove( int fd) BOOST_NOEXCEPT;
+
+    // registered buffers are used by async_read_at()/async_write_at()
+    // for transfers inside of them (READ_FIXED/WRITE_FIXED)
+    void register_buffers( iovec const* iov, std::size_t n, system::error_code & ec);
+
+    void register_buffers( iovec const* iov, std::size_t n);
+
+    void unregister_buffers() BOOST_NOEXCEPT;
+
+    // operations on registered descriptors use the fixed file table
+    void register_files( int const* fds, std::size_t n, system::error_code & ec);
+
+    void register_files( int const* fds, std::size_t n);
+
+    void unregister_files() BOOST_NOEXCEPT;
+
+    // reads at most size bytes; returns 0 at end of file
+    std::size_t async_read( int fd, void * buf, std::size_t size, system::error_code & ec);
+
+    std::size_t async_read( int fd, void * buf, std::size_t size);
+
+    // writes all size bytes unless an error occurs
+    std::size_t async_write( int fd, void const* buf, std::size_t size, system::error_code & ec);
+
+    std::size_t async_write( int fd, void const* buf, std::size_t size);
+
+    // positional variants, the file offset is not changed
+    std::size_t async_read_at( int fd, uint64_t offset, void * buf, std::size_t size,
+                               system::error_code & ec);
+
+    std::size_t async_read_at( int fd, uint64_t offset, void * buf, std::size_t size);
+
+    std::size_t async_write_at( int fd, uint64_t offset, void const* buf, std::size_t size,
+                                system::error_code & ec);
+
+    std::size_t async_write_at( int fd, uint64_t offset, void const* buf, std::size_t size);
+
+    // returns the accepted socket, already added to the engine
+    int async_accept( int fd, system::error_code & ec);
+
+    int async_accept( int fd);
+
+    void async_connect( int fd, sockaddr const* addr, socklen_t len, system::error_code & ec);
+
+    void async_connect( int fd, sockaddr const* addr, socklen_t len);
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == inflight_; }
+
+    void poll( detail::clock_type::time_point const* deadline);
+
+    void interrupt() BOOST_NOEXCEPT;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_IO_ENGINE_H
@@ -0,0 +1,73 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_LATCH_H
+#define BOOST_COROUTINES_LATCH_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/spinlock.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// single-use count-down for tasks of one or more schedulers; the
+// tasks waiting are made ready on their schedulers by the
+// count_down() reaching zero and may destroy the latch as soon as
+// wait() returns
+class BOOST_COROUTINES_DECL latch : private noncopyable
+{
+private:
+    mutable detail::spinlock    lock_;
+    std::size_t                 count_;
+    detail::task_queue          waiters_;
+
+public:
+    explicit latch( std::size_t count) BOOST_NOEXCEPT :
+        lock_(),
+        count_( count),
+        waiters_()
+    {}
+
+    ~latch()
+    { BOOST_ASSERT( waiters_.empty() ); }
+
+    void count_down( std::size_t n = 1) BOOST_NOEXCEPT;
+
+    bool try_wait() const BOOST_NOEXCEPT
+    {
+        lock_guard< detail::spinlock > lk( lock_);
+        return 0 == count_;
+    }
+
+    void wait();
+
+    void arrive_and_wait( std::size_t n = 1)
+    {
+        count_down( n);
+        wait();
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_LATCH_H
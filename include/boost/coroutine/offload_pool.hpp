@@ -0,0 +1,156 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_OFFLOAD_POOL_H
+#define BOOST_COROUTINES_OFFLOAD_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+#include <boost/utility/result_of.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// blocking call submitted to an offload_pool, lives on the stack
+// of the submitting task - no allocation
+struct offload_job
+{
+    offload_job         *   next;
+    void                (*  run)( offload_job *);
+    scheduler           *   sched;
+    task_base           *   task;
+    exception_ptr           except;
+
+    explicit offload_job( void (* run_)( offload_job *) ) BOOST_NOEXCEPT :
+        next( 0), run( run_), sched( 0), task( 0), except()
+    {}
+};
+
+template< typename Fn, typename R >
+struct offload_object : public offload_job
+{
+    Fn              fn;
+    optional< R >   result;
+
+    explicit offload_object( Fn fn_) :
+        offload_job( & offload_object::run_), fn( fn_), result()
+    {}
+
+    static void run_( offload_job * j)
+    {
+        offload_object * self = static_cast< offload_object * >( j);
+        try
+        { self->result = self->fn(); }
+        catch (...)
+        { self->except = current_exception(); }
+    }
+
+    R get()
+    {
+        if ( except) rethrow_exception( except);
+        return boost::move( * result);
+    }
+};
+
+template< typename Fn >
+struct offload_object< Fn, void > : public offload_job
+{
+    Fn              fn;
+
+    explicit offload_object( Fn fn_) :
+        offload_job( & offload_object::run_), fn( fn_)
+    {}
+
+    static void run_( offload_job * j)
+    {
+        offload_object * self = static_cast< offload_object * >( j);
+        try
+        { self->fn(); }
+        catch (...)
+        { self->except = current_exception(); }
+    }
+
+    void get()
+    { if ( except) rethrow_exception( except); }
+};
+
+}
+
+// fixed set of worker threads executing blocking calls (regular
+// file I/O, fsync(), getaddrinfo() ...) on behalf of tasks
+// the submitting task suspends - its thread keeps running the other
+// tasks - and is resumed by its own scheduler; completions are
+// handed back through the lock-free remote queue of the scheduler,
+// a burst of completions costs one wakeup (eventfd write)
+// calls submitted faster than the workers execute them are queued
+class BOOST_COROUTINES_DECL offload_pool : private noncopyable
+{
+private:
+    detail::offload_job     *   head_;
+    detail::offload_job     *   tail_;
+    bool                        stop_;
+    mutex                       mtx_;
+    condition_variable          cond_;
+    std::vector< thread * >     workers_;
+
+    void worker_();
+
+    // stops the workers after the queue has been drained
+    void join_();
+
+    // suspends the active task until j has been executed
+    void execute_( detail::offload_job * j);
+
+public:
+    explicit offload_pool( std::size_t threads = 4);
+
+    // executes the calls already submitted, then joins the workers
+    ~offload_pool();
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return workers_.size(); }
+
+    // executes fn() on a worker thread and returns its result
+    // (re-throws its exception); outside of a task fn() is
+    // executed by the calling thread
+    // a task cancelled meanwhile is unwound not before fn()
+    // has returned - fn might refer to the stack
+    template< typename Fn >
+    typename result_of< Fn() >::type execute( Fn fn)
+    {
+        typedef typename result_of< Fn() >::type                result_type;
+        typedef detail::offload_object< Fn, result_type >      object_t;
+
+        object_t o( fn);
+        execute_( & o);
+        return o.get();
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_OFFLOAD_POOL_H
@@ -0,0 +1,135 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_POOLED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_POOLED_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+#include <boost/coroutine/standard_stack_allocator.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// caches released stacks of one size and hands them out again;
+// all copies share the cache (reference counted), the cache is
+// freed with the last copy - including the copies held by the
+// coroutines using a stack of the pool
+// not thread-safe: the coroutines of a pool must be created and
+// destroyed on one thread
+template< typename traitsT, typename StackAllocator = basic_standard_stack_allocator< traitsT > >
+class basic_pooled_stack_allocator
+{
+private:
+    struct storage
+    {
+        std::size_t                     use_count;
+        std::size_t                     stack_size;
+        std::size_t                     max_cached;
+        // size of the stacks returned by the underlying allocator
+        // for stack_size (might be rounded to pages)
+        std::size_t                     pooled_size;
+        std::vector< stack_context >    stacks;
+        StackAllocator                  alloc;
+
+        storage( std::size_t stack_size_, std::size_t max_cached_, StackAllocator const& alloc_) :
+            use_count( 1), stack_size( stack_size_), max_cached( max_cached_),
+            pooled_size( 0), stacks(), alloc( alloc_)
+        { stacks.reserve( max_cached); }
+
+        ~storage()
+        {
+            for ( std::size_t i = 0; i < stacks.size(); ++i)
+                alloc.deallocate( stacks[i]);
+        }
+    };
+
+    storage *   storage_;
+
+    void release_() BOOST_NOEXCEPT
+    { if ( 0 == --storage_->use_count) delete storage_; }
+
+public:
+    typedef traitsT traits_type;
+
+    explicit basic_pooled_stack_allocator( std::size_t stack_size = traits_type::default_size(),
+                                           std::size_t max_cached = 1024,
+                                           StackAllocator const& alloc = StackAllocator() ) :
+        storage_( new storage( stack_size, max_cached, alloc) )
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= stack_size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= stack_size) );
+    }
+
+    basic_pooled_stack_allocator( basic_pooled_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_)
+    { ++storage_->use_count; }
+
+    basic_pooled_stack_allocator & operator=( basic_pooled_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        ++other.storage_->use_count;
+        release_();
+        storage_ = other.storage_;
+        return * this;
+    }
+
+    ~basic_pooled_stack_allocator()
+    { release_(); }
+
+    // requests larger than the stack size of the pool are
+    // passed to the underlying allocator
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        if ( storage_->stack_size < size)
+        {
+            storage_->alloc.allocate( ctx, size);
+            return;
+        }
+        if ( ! storage_->stacks.empty() )
+        {
+            ctx = storage_->stacks.back();
+            storage_->stacks.pop_back();
+            return;
+        }
+        storage_->alloc.allocate( ctx, storage_->stack_size);
+        storage_->pooled_size = ctx.size;
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+
+        if ( storage_->pooled_size == ctx.size &&
+             storage_->stacks.size() < storage_->max_cached)
+            storage_->stacks.push_back( ctx);
+        else
+            storage_->alloc.deallocate( ctx);
+    }
+
+    // number of stacks in the cache
+    std::size_t cached() const BOOST_NOEXCEPT
+    { return storage_->stacks.size(); }
+};
+
+typedef basic_pooled_stack_allocator< stack_traits >  pooled_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_POOLED_STACK_ALLOCATOR_H
@@ -13,6 +13,7 @@
 #include <boost/config.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/probes.hpp>
 #include <boost/coroutine/stack_context.hpp>
 #include <boost/coroutine/stack_traits.hpp>
 
@@ -52,10 +53,14 @@ struct basic_segmented_stack_allocator
 
         int off = 0;
         __splitstack_block_signals_context( ctx.segments_ctx, & off, 0);
+        BOOST_COROUTINES_PROBE2( stack_allocate, ctx.sp, ctx.size);
     }
 
     void deallocate( stack_context & ctx)
-    { __splitstack_releasecontext( ctx.segments_ctx); }
+    {
+        BOOST_COROUTINES_PROBE2( stack_deallocate, ctx.sp, ctx.size);
+        __splitstack_releasecontext( ctx.segments_ctx);
+    }
 };
 
 typedef basic_segmented_stack_allocator< stack_traits > segmented_stack_allocator;
@@ -0,0 +1,56 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_PROFILER_H
+#define BOOST_COROUTINES_PROFILER_H
+
+#include <cstddef>
+#include <iosfwd>
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace profiler {
+
+// samples the thread consuming CPU `frequency` times per second of
+// process CPU time (ITIMER_PROF/SIGPROF): the execution context running
+// and its call stack, walked along the frame pointers within the bounds
+// of the coroutine stack - on the stack of a thread only the
+// interrupted instruction is recorded
+// installs a handler for SIGPROF (kept after stop())
+BOOST_COROUTINES_DECL void start( unsigned int frequency = 99);
+
+BOOST_COROUTINES_DECL void stop() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL bool running() BOOST_NOEXCEPT;
+
+// discards the samples; not while running
+BOOST_COROUTINES_DECL void clear() BOOST_NOEXCEPT;
+
+// samples recorded and samples dropped because the buffer was full
+BOOST_COROUTINES_DECL std::size_t samples() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL std::size_t dropped() BOOST_NOEXCEPT;
+
+// writes the samples as folded stacks (flamegraph.pl, speedscope): one
+// line per distinct stack, rooted at the label of the coroutine
+// ([coroutine] if unlabeled, [thread] outside of coroutines) - with
+// `by_coroutine` the root also names the execution context
+BOOST_COROUTINES_DECL void write_folded( std::ostream &, bool by_coroutine = false);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_PROFILER_H
@@ -0,0 +1,185 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_REACTOR_H
+#define BOOST_COROUTINES_REACTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/poller.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// edge-triggered epoll reactor polled by a scheduler
+// each operation tries the syscall first; only if it would block
+// the active task registers as reader or writer of the descriptor
+// and suspends until the descriptor becomes ready
+// at most one reading and one writing task per descriptor
+class BOOST_COROUTINES_DECL reactor : public detail::poller, private noncopyable
+{
+public:
+    typedef detail::clock_type                  clock_type;
+
+private:
+    struct descriptor
+    {
+        detail::task_base   *   reader;
+        detail::task_base   *   writer;
+        bool                    registered;
+
+        descriptor() BOOST_NOEXCEPT :
+            reader( 0), writer( 0), registered( false)
+        {}
+    };
+
+    // deadline of a waiting operation, lives on the stack
+    // of the waiting task
+    struct timer_t : public detail::timer_node
+    {
+        reactor                     *   r;
+        int                             fd;
+        detail::task_base           *   task;
+        detail::task_base * descriptor::* waiter;
+        bool                            expired;
+
+        timer_t( clock_type::time_point const& tp, reactor * r_, int fd_,
+                 detail::task_base * task_, detail::task_base * descriptor::* waiter_) BOOST_NOEXCEPT :
+            detail::timer_node( tp, & reactor::expired_),
+            r( r_), fd( fd_), task( task_), waiter( waiter_), expired( false)
+        {}
+    };
+
+    scheduler                   *   sched_;
+    int                             epfd_;
+    // eventfd signalled by interrupt()
+    int                             evfd_;
+    std::vector< descriptor >       descriptors_;
+    std::size_t                     waiting_;
+
+    static void expired_( detail::timer_node *) BOOST_NOEXCEPT;
+
+    bool wait_( int, detail::task_base * descriptor::*,
+                clock_type::time_point const&, system::error_code &);
+
+    void wake_( detail::task_base * &) BOOST_NOEXCEPT;
+
+    // waits for the side of a transfer between in_fd and out_fd
+    // which is not ready
+    bool wait_transfer_( int in_fd, int out_fd,
+                         clock_type::time_point const&, system::error_code &);
+
+public:
+    explicit reactor( scheduler & sched);
+
+    // unwinds the tasks waiting for a descriptor
+    ~reactor();
+
+    // switches fd to non-blocking mode and registers it
+    void add( int fd, system::error_code & ec);
+
+    void add( int fd);
+
+    // deregisters fd; waiting operations fail with operation_canceled
+    void remove( int fd) BOOST_NOEXCEPT;
+
+    // reads at most size bytes; returns 0 at end of file
+    std::size_t async_read( int fd, void * buf, std::size_t size, system::error_code & ec);
+
+    std::size_t async_read( int fd, void * buf, std::size_t size);
+
+    // the overloads taking a deadline fail with timed_out if the
+    // operation is not complete before the deadline
+    std::size_t async_read( int fd, void * buf, std::size_t size,
+                            clock_type::time_point const& deadline, system::error_code & ec);
+
+    // writes all size bytes unless an error occurs
+    std::size_t async_write( int fd, void const* buf, std::size_t size, system::error_code & ec);
+
+    std::size_t async_write( int fd, void const* buf, std::size_t size);
+
+    std::size_t async_write( int fd, void const* buf, std::size_t size,
+                             clock_type::time_point const& deadline, system::error_code & ec);
+
+    // returns the accepted socket, already added to the reactor
+    int async_accept( int fd, system::error_code & ec);
+
+    int async_accept( int fd);
+
+    int async_accept( int fd, clock_type::time_point const& deadline, system::error_code & ec);
+
+    void async_connect( int fd, sockaddr const* addr, socklen_t len, system::error_code & ec);
+
+    void async_connect( int fd, sockaddr const* addr, socklen_t len);
+
+    void async_connect( int fd, sockaddr const* addr, socklen_t len,
+                        clock_type::time_point const& deadline, system::error_code & ec);
+
+    // zero-copy transfers, the data does not pass user space
+    // sends size bytes of file in_fd starting at offset to out_fd;
+    // returns fewer bytes only at end of file or on error
+    std::size_t async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size,
+                                system::error_code & ec);
+
+    std::size_t async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size);
+
+    std::size_t async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size,
+                                clock_type::time_point const& deadline, system::error_code & ec);
+
+    // moves at most size bytes from in_fd to out_fd, one of them a
+    // pipe; returns 0 at end of file
+    std::size_t async_splice( int in_fd, int out_fd, std::size_t size, system::error_code & ec);
+
+    std::size_t async_splice( int in_fd, int out_fd, std::size_t size);
+
+    std::size_t async_splice( int in_fd, int out_fd, std::size_t size,
+                              clock_type::time_point const& deadline, system::error_code & ec);
+
+    // duplicates at most size bytes of pipe in_fd to pipe out_fd
+    // without consuming them; returns 0 at end of file
+    std::size_t async_tee( int in_fd, int out_fd, std::size_t size, system::error_code & ec);
+
+    std::size_t async_tee( int in_fd, int out_fd, std::size_t size);
+
+    std::size_t async_tee( int in_fd, int out_fd, std::size_t size,
+                           clock_type::time_point const& deadline, system::error_code & ec);
+
+    // suspends the active task until fd becomes readable resp.
+    // writable; edge-triggered - fd must have been found not ready
+    // (EAGAIN) after its last event
+    void async_wait_readable( int fd, clock_type::time_point const& deadline, system::error_code & ec);
+
+    void async_wait_writable( int fd, clock_type::time_point const& deadline, system::error_code & ec);
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == waiting_; }
+
+    void poll( detail::clock_type::time_point const* deadline);
+
+    void interrupt() BOOST_NOEXCEPT;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_REACTOR_H
@@ -0,0 +1,91 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_REGISTRY_H
+#define BOOST_COROUTINES_REGISTRY_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// state of a live coroutine at the time of the snapshot
+struct coroutine_info
+{
+    enum kind_t
+    {
+        task = 0,
+        pull,
+        push,
+        symmetric
+    };
+
+    kind_t                              kind;
+    bool                                started;
+    bool                                running;
+    bool                                complete;
+    // id of the thread the coroutine was created on
+    uint32_t                            thread;
+    // top and size of the stack
+    void const                      *   stack;
+    std::size_t                         stack_size;
+    // stack in use at the last suspension (0 if unknown)
+    std::size_t                         stack_used;
+    chrono::steady_clock::time_point    created;
+    std::string                         label;
+};
+
+namespace registry {
+
+// tracks the coroutines (tasks, asymmetric and symmetric coroutines)
+// created while the registry is enabled, in one list per thread
+BOOST_COROUTINES_DECL void enable() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL void disable() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL bool enabled() BOOST_NOEXCEPT;
+
+// the live coroutines, oldest first; the state of coroutines running
+// on other threads is approximate
+BOOST_COROUTINES_DECL std::vector< coroutine_info > snapshot();
+
+// writes a summary and one line per live coroutine
+BOOST_COROUTINES_DECL void dump( std::ostream &);
+
+#if ! defined(BOOST_WINDOWS)
+// dumps to stderr each time the signal is received (from a thread of
+// its own, the signal handler only wakes it)
+BOOST_COROUTINES_DECL void dump_on_signal( int sig);
+#endif
+
+}
+
+namespace this_coroutine {
+
+// labels the active task in the registry; the label must outlive it
+BOOST_COROUTINES_DECL void label( char const* label) BOOST_NOEXCEPT;
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_REGISTRY_H
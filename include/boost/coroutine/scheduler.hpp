@@ -0,0 +1,301 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_SCHEDULER_H
+#define BOOST_COROUTINES_SCHEDULER_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/type_traits/decay.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/poller.hpp>
+#include <boost/coroutine/detail/remote_queue.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_object.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/detail/timer_queue.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+class io_engine;
+class reactor;
+class task_group;
+
+// runs coroutines cooperatively on the thread calling run()
+// a coroutine (task) suspends only itself - the thread keeps
+// running the other ready tasks
+class BOOST_COROUTINES_DECL scheduler : private noncopyable
+{
+public:
+    typedef detail::clock_type                  clock_type;
+
+private:
+    friend class io_engine;
+    friend class reactor;
+    friend class task_group;
+
+    detail::task_queue      ready_;
+    detail::timer_queue     timers_;
+    detail::poller      *   poller_;
+    detail::task_base   *   active_;
+    detail::task_base   *   live_;
+    std::size_t             size_;
+    // tasks made ready by other threads
+    detail::remote_queue    remote_;
+    // number of tasks waiting for a remote wakeup (owner only)
+    std::size_t             remote_pending_;
+    // threads inside of schedule_remote()
+    atomic< std::size_t >   remote_producers_;
+    // guard the wakeup of the blocked owner thread
+    mutex                   remote_mtx_;
+    condition_variable      remote_cond_;
+    detail::poller      *   remote_poller_;
+
+    void attach_( detail::task_base *) BOOST_NOEXCEPT;
+
+    void detach_( detail::task_base *) BOOST_NOEXCEPT;
+
+    void resume_( detail::task_base *);
+
+    // unwinds the stack of a suspended task and destroys it
+    void unwind_( detail::task_base *) BOOST_NOEXCEPT;
+
+    bool cancelled_() const BOOST_NOEXCEPT;
+
+    // moves the remotely scheduled tasks to the ready-queue
+    void take_remote_() BOOST_NOEXCEPT;
+
+    // blocks until a task is scheduled remotely or deadline
+    // (if not 0) has expired
+    void wait_remote_( clock_type::time_point const* deadline);
+
+    // polls the poller; the poll is interrupted by a remote wakeup
+    void poll_( clock_type::time_point const* deadline);
+
+    template< typename Fn, typename StackAllocator >
+    detail::task_base * create_( BOOST_FWD_REF( Fn) fn,
+                                 attributes const& attrs,
+                                 StackAllocator stack_alloc)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        stack_alloc.allocate( stack_ctx, attrs.size);
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal task-type
+        typedef detail::task_object<
+            typename decay< Fn >::type, StackAllocator
+        >                                                       object_t;
+        // reserve space on top of coroutine-stack for internal task-type
+        stack_context internal_stack_ctx;
+        internal_stack_ctx.sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        BOOST_ASSERT( 0 != internal_stack_ctx.sp);
+        internal_stack_ctx.size = stack_ctx.size - sizeof( object_t);
+        BOOST_ASSERT( 0 < internal_stack_ctx.size);
+        // placement new for internal task
+        detail::task_base * t = new ( internal_stack_ctx.sp) object_t(
+                boost::forward< Fn >( fn), attrs, stack_ctx, internal_stack_ctx, stack_alloc);
+        BOOST_ASSERT( t);
+        return t;
+    }
+
+public:
+    scheduler();
+
+    ~scheduler();
+
+    // returns the scheduler running on the current thread
+    // or 0 if the thread is not inside of run()
+    static scheduler * instance() BOOST_NOEXCEPT;
+
+    template< typename Fn >
+    void spawn( BOOST_FWD_REF( Fn) fn,
+                attributes const& attrs = attributes() )
+    { spawn( boost::forward< Fn >( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void spawn( BOOST_FWD_REF( Fn) fn,
+                attributes const& attrs,
+                StackAllocator stack_alloc)
+    {
+        detail::task_base * t = create_( boost::forward< Fn >( fn), attrs, stack_alloc);
+        attach_( t);
+        schedule( t);
+    }
+
+    // resumes ready tasks until none is left; while tasks are
+    // waiting only for a deadline or an event of the poller the
+    // thread blocks until the earliest deadline expires or an
+    // event occurs
+    void run();
+
+    // number of tasks not yet complete
+    std::size_t size() const BOOST_NOEXCEPT
+    { return size_; }
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == size_; }
+
+    // task currently executed by this scheduler
+    detail::task_base * active() const BOOST_NOEXCEPT
+    { return active_; }
+
+    // marks a suspended task as ready
+    void schedule( detail::task_base * t) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != t);
+        BOOST_ASSERT( this == t->owner() );
+
+        ready_.push( t);
+    }
+
+    // registers a deadline; fn of the node is invoked by run()
+    // after the deadline has expired
+    void add_timer( detail::timer_node * n)
+    {
+        BOOST_ASSERT( 0 != n);
+        BOOST_ASSERT( 0 != n->fn);
+
+        timers_.push( n);
+    }
+
+    void cancel_timer( detail::timer_node * n) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != n);
+
+        if ( n->is_linked() ) timers_.erase( n);
+    }
+
+    // source of events polled by run(), at most one per scheduler
+    detail::poller * poller() const BOOST_NOEXCEPT
+    { return poller_; }
+
+    void poller( detail::poller * p);
+
+    // announces that the active task suspends until another thread
+    // passes it to schedule_remote(); run() does not return while
+    // a remote wakeup is pending
+    void expect_remote() BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != active_);
+        BOOST_ASSERT( ! active_->remote_wakeup_pending() );
+
+        active_->flags_ |= detail::flag_remote_wakeup;
+        ++remote_pending_;
+    }
+
+    // thread-safe: marks a task announced by expect_remote() as
+    // ready; the owner thread is woken only by the push into an
+    // empty queue
+    void schedule_remote( detail::task_base * t);
+
+    // blocks the thread until the remote wakeup of the active task
+    // has arrived - a task with a pending wakeup must call it before
+    // its stack is unwound
+    void join_remote();
+
+    // withdraws expect_remote() of the active task, which is not going
+    // to be passed to schedule_remote()
+    void withdraw_remote() BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != active_);
+        BOOST_ASSERT( active_->remote_wakeup_pending() );
+
+        active_->flags_ &= ~detail::flag_remote_wakeup;
+        --remote_pending_;
+    }
+
+    // moves the tasks announced by expect_remote() from the wait-queue
+    // of a synchronization primitive to a chain, linked through the
+    // hook of the remote-queue (unused while a task waits); called
+    // with the lock of the primitive held
+    static detail::task_base * detach( detail::task_queue & waiters) BOOST_NOEXCEPT;
+
+    // marks the tasks of a chain returned by detach() as ready: directly
+    // on the thread running their scheduler, else through
+    // schedule_remote(); called after the lock of the primitive was
+    // released - a woken task might destroy the primitive
+    static void wake( detail::task_base * chain);
+
+    // suspends the active task until it gets scheduled again
+    // throws detail::forced_unwind (unwinding the task) before and
+    // after the suspension if the task_group of the task has been
+    // cancelled
+    void suspend();
+
+    // suspends the active task and appends it to the ready-queue
+    void yield();
+
+    // suspends the active task until tp has expired; the other
+    // tasks keep running
+    void sleep_until( clock_type::time_point const& tp);
+
+    template< typename Rep, typename Period >
+    void sleep_for( chrono::duration< Rep, Period > const& d)
+    { sleep_until( clock_type::now() + d); }
+
+    // true if the task_group of the active task has been cancelled
+    bool cancellation_requested() const BOOST_NOEXCEPT
+    { return 0 != active_ && cancelled_(); }
+};
+
+namespace this_coroutine {
+
+inline
+void yield()
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    sched->yield();
+}
+
+inline
+void sleep_until( scheduler::clock_type::time_point const& tp)
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    sched->sleep_until( tp);
+}
+
+template< typename Rep, typename Period >
+void sleep_for( chrono::duration< Rep, Period > const& d)
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    sched->sleep_for( d);
+}
+
+inline
+bool cancellation_requested() BOOST_NOEXCEPT
+{
+    scheduler * sched = scheduler::instance();
+    return 0 != sched && sched->cancellation_requested();
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_SCHEDULER_H
@@ -0,0 +1,139 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_SELECT_H
+#define BOOST_COROUTINES_SELECT_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/channel.hpp>
+#include <boost/coroutine/channel_op_status.hpp>
+#include <boost/coroutine/detail/channel_waiter.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/timer_queue.hpp>
+
+#ifndef BOOST_COROUTINES_SELECT_MAX_CASES
+# define BOOST_COROUTINES_SELECT_MAX_CASES 8
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// waits for the first of several channel operations and
+// deadlines; the cases are stored inside the select object
+// (on the stack of the waiting task), nothing is allocated
+// per wait and the cases not fired are unlinked in O(k)
+// referenced channels and elements must outlive wait()
+class BOOST_COROUTINES_DECL select : private noncopyable
+{
+public:
+    typedef detail::clock_type                  clock_type;
+
+    static const std::size_t    max_cases = BOOST_COROUTINES_SELECT_MAX_CASES;
+
+private:
+    struct timer_case : public detail::timer_node
+    {
+        detail::select_state    *   state;
+        std::size_t                 case_index;
+
+        timer_case() BOOST_NOEXCEPT :
+            detail::timer_node(), state( 0), case_index( 0)
+        {}
+    };
+
+    struct case_t
+    {
+        channel_op_status       (*  try_op)( void *, void *);
+        void                    *   chan;
+        detail::waiter_list     *   list;
+        detail::channel_waiter      waiter;
+        timer_case                  timer;
+    };
+
+    case_t                  cases_[max_cases];
+    std::size_t             size_;
+    detail::select_state    state_;
+
+    static void expired_( detail::timer_node *) BOOST_NOEXCEPT;
+
+    std::size_t add_( channel_op_status (* try_op)( void *, void *),
+                      void * chan, detail::waiter_list * list, void * value) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT_MSG( size_ < max_cases, "too many select cases");
+
+        case_t & c = cases_[size_];
+        c.try_op = try_op;
+        c.chan = chan;
+        c.list = list;
+        c.waiter = detail::channel_waiter( & state_, size_, value);
+        return size_++;
+    }
+
+    void cancel_() BOOST_NOEXCEPT;
+
+public:
+    select() BOOST_NOEXCEPT :
+        size_( 0),
+        state_()
+    {}
+
+    // case pushing v into ch; returns the index of the case
+    template< typename T >
+    std::size_t push( channel< T > & ch, T const& v) BOOST_NOEXCEPT
+    {
+        return add_( & channel< T >::try_push_, & ch,
+                     & ch.pushers_, const_cast< T * >( & v) );
+    }
+
+    // case popping an element of ch into v
+    template< typename T >
+    std::size_t pop( channel< T > & ch, T & v) BOOST_NOEXCEPT
+    { return add_( & channel< T >::try_pop_, & ch, & ch.poppers_, & v); }
+
+    // case completing with channel_op_timeout at tp
+    std::size_t deadline( clock_type::time_point const& tp) BOOST_NOEXCEPT
+    {
+        std::size_t i = add_( 0, 0, 0, 0);
+        cases_[i].timer.deadline = tp;
+        return i;
+    }
+
+    template< typename Rep, typename Period >
+    std::size_t timeout( chrono::duration< Rep, Period > const& d) BOOST_NOEXCEPT
+    { return deadline( clock_type::now() + d); }
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return size_; }
+
+    // completes the first ready case - in the order the cases were
+    // added - or suspends the active task until one case fires
+    // returns the index of the completed case
+    std::size_t wait();
+
+    // index and status of the case completed by the last wait()
+    std::size_t index() const BOOST_NOEXCEPT
+    { return state_.fired; }
+
+    channel_op_status status() const BOOST_NOEXCEPT
+    { return state_.status; }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_SELECT_H
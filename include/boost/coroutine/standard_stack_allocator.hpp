@@ -19,6 +19,7 @@
 #include <boost/config.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/probes.hpp>
 #include <boost/coroutine/stack_context.hpp>
 #include <boost/coroutine/stack_traits.hpp>
 
@@ -47,6 +48,7 @@ struct basic_standard_stack_allocator
 #if defined(BOOST_USE_VALGRIND)
         ctx.valgrind_stack_id = VALGRIND_STACK_REGISTER( ctx.sp, limit);
 #endif
+        BOOST_COROUTINES_PROBE2( stack_allocate, ctx.sp, ctx.size);
     }
 
     void deallocate( stack_context & ctx)
@@ -54,6 +56,7 @@ struct basic_standard_stack_allocator
         BOOST_ASSERT( ctx.sp);
         BOOST_ASSERT( traits_type::minimum_size() <= ctx.size);
         BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= ctx.size) );
+        BOOST_COROUTINES_PROBE2( stack_deallocate, ctx.sp, ctx.size);
 
 #if defined(BOOST_USE_VALGRIND)
         VALGRIND_STACK_DEREGISTER( ctx.valgrind_stack_id);
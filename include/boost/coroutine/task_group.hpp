@@ -0,0 +1,125 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_TASK_GROUP_H
+#define BOOST_COROUTINES_TASK_GROUP_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/detail/timer_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// structured group of tasks (nursery) of one scheduler
+// cancel() - called explicitly, by an exception escaping from a
+// child, by an expired deadline or by the destructor - unwinds
+// all suspended children in one pass; a child running at this
+// moment observes the cancellation at its next suspension point
+// (scheduler::suspend()/yield() throw detail::forced_unwind)
+// children must be created with stack unwinding (the default)
+class BOOST_COROUTINES_DECL task_group : private noncopyable
+{
+public:
+    typedef detail::clock_type                  clock_type;
+
+private:
+    friend class scheduler;
+
+    struct timer_t : public detail::timer_node
+    {
+        task_group  *   group;
+
+        timer_t( task_group * group_) BOOST_NOEXCEPT :
+            detail::timer_node(), group( group_)
+        {}
+    };
+
+    scheduler           *   sched_;
+    detail::task_base   *   children_;
+    std::size_t             size_;
+    bool                    cancelled_;
+    exception_ptr           except_;
+    detail::task_queue      waiters_;
+    timer_t                 timer_;
+
+    static void expired_( detail::timer_node *) BOOST_NOEXCEPT;
+
+    void link_( detail::task_base *) BOOST_NOEXCEPT;
+
+    void unlink_( detail::task_base *) BOOST_NOEXCEPT;
+
+    void complete_( detail::task_base *, exception_ptr const&) BOOST_NOEXCEPT;
+
+    void wake_() BOOST_NOEXCEPT;
+
+public:
+    explicit task_group( scheduler & sched);
+
+    // group of the scheduler running on the current thread
+    task_group();
+
+    ~task_group();
+
+    // creates a child task; ignored if the group is cancelled
+    template< typename Fn >
+    void spawn( BOOST_FWD_REF( Fn) fn,
+                attributes const& attrs = attributes() )
+    {
+        BOOST_ASSERT( stack_unwind == attrs.do_unwind);
+
+        if ( cancelled_) return;
+        detail::task_base * t = sched_->create_(
+                boost::forward< Fn >( fn), attrs, stack_allocator() );
+        link_( t);
+        sched_->attach_( t);
+        sched_->schedule( t);
+    }
+
+    // suspends the active task until all children are complete;
+    // re-throws the first exception escaping from a child
+    void wait();
+
+    void cancel() BOOST_NOEXCEPT;
+
+    // cancels the group when tp expires
+    void cancel_at( clock_type::time_point const& tp);
+
+    template< typename Rep, typename Period >
+    void cancel_after( chrono::duration< Rep, Period > const& d)
+    { cancel_at( clock_type::now() + d); }
+
+    bool is_cancelled() const BOOST_NOEXCEPT
+    { return cancelled_; }
+
+    // number of children not yet complete
+    std::size_t size() const BOOST_NOEXCEPT
+    { return size_; }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_TASK_GROUP_H
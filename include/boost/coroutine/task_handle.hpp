@@ -0,0 +1,105 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_TASK_HANDLE_H
+#define BOOST_COROUTINES_TASK_HANDLE_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// refers to a task suspended by this_coroutine::suspend_until_resumed();
+// passed to the thread (completion callback ...) resuming the task
+class task_handle
+{
+private:
+    friend void resume_on_owner( task_handle const&);
+
+    scheduler           *   sched_;
+    detail::task_base   *   task_;
+
+public:
+    task_handle() BOOST_NOEXCEPT :
+        sched_( 0), task_( 0)
+    {}
+
+    task_handle( scheduler * sched, detail::task_base * task) BOOST_NOEXCEPT :
+        sched_( sched), task_( task)
+    {}
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == task_; }
+
+    bool operator==( task_handle const& other) const BOOST_NOEXCEPT
+    { return task_ == other.task_; }
+
+    bool operator!=( task_handle const& other) const BOOST_NOEXCEPT
+    { return task_ != other.task_; }
+};
+
+// thread-safe: pushes the task onto the lock-free inbox of its
+// scheduler, which resumes it on its own thread; only the push into
+// an empty inbox wakes the scheduler (eventfd write of its poller or
+// condition variable) - a burst of resumptions costs one wakeup
+// must be called exactly once per suspension
+inline
+void resume_on_owner( task_handle const& h)
+{
+    BOOST_ASSERT( ! h.empty() );
+
+    h.sched_->schedule_remote( h.task_);
+}
+
+namespace this_coroutine {
+
+// suspends the active task (not the thread) until resume_on_owner()
+// is called with the handle passed to fn; fn is invoked before the
+// suspension and must not throw after it has passed the handle on
+// a task cancelled meanwhile is unwound not before it has been
+// resumed - the resuming thread might refer to its stack
+template< typename Fn >
+void suspend_until_resumed( Fn fn)
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    detail::task_base * self = sched->active();
+    BOOST_ASSERT( 0 != self);
+    BOOST_ASSERT( self->force_unwind() );
+
+    if ( sched->cancellation_requested() ) throw detail::forced_unwind();
+    // the scheduler takes the resumption not before suspend(), even
+    // if fn resumes the task at once
+    fn( task_handle( sched, self) );
+    sched->expect_remote();
+    try
+    { self->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        sched->join_remote();
+        throw;
+    }
+    if ( sched->cancellation_requested() ) throw detail::forced_unwind();
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_TASK_HANDLE_H
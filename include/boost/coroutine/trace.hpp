@@ -0,0 +1,46 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_TRACE_H
+#define BOOST_COROUTINES_TRACE_H
+
+#include <iosfwd>
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace trace {
+
+// starts recording create/resume/suspend/complete events of the
+// tasks of all schedulers; each thread appends to its own ring buffer
+// (allocated at its first event) - the oldest records are overwritten
+BOOST_COROUTINES_DECL void start() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL void stop() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL bool enabled() BOOST_NOEXCEPT;
+
+// discards the recorded events; not while threads are recording
+BOOST_COROUTINES_DECL void clear() BOOST_NOEXCEPT;
+
+// writes the recorded events as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev): one slice per resumption on the thread running the
+// task; records overwritten while writing are skipped
+BOOST_COROUTINES_DECL void write_chrome_json( std::ostream &);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_TRACE_H
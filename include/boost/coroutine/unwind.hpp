@@ -0,0 +1,40 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_UNWIND_H
+#define BOOST_COROUTINES_UNWIND_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace unwind {
+
+// the outermost frame of a coroutine stack ends the frame pointer chain
+// (clean root) - linked, the frame is updated at each resumption to
+// continue into the stack of the resumer, as if the coroutine function
+// were called there (stitched); set before coroutines are created
+inline
+void link_parent( bool link) BOOST_NOEXCEPT
+{ detail::coroutine_context::link_parent( link); }
+
+inline
+bool parent_linked() BOOST_NOEXCEPT
+{ return detail::coroutine_context::parent_linked(); }
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_UNWIND_H
@@ -0,0 +1,78 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_WAIT_GROUP_H
+#define BOOST_COROUTINES_WAIT_GROUP_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/spinlock.hpp>
+#include <boost/coroutine/detail/task_base.hpp>
+#include <boost/coroutine/detail/task_queue.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// joins a dynamic number of child tasks: add() before spawning
+// a child, done() when the child has finished, wait() suspends
+// the joining task until the counter drops to zero
+// the children may run on other schedulers: the last done() makes
+// the joiners ready on their own schedulers (through
+// scheduler::schedule_remote() from another thread) - nothing is
+// allocated per child
+// run() of a scheduler does not return while one of its tasks waits
+// the joiner may destroy the wait_group as soon as wait() returns
+class BOOST_COROUTINES_DECL wait_group : private noncopyable
+{
+private:
+    mutable detail::spinlock    lock_;
+    std::size_t                 count_;
+    detail::task_queue          waiters_;
+
+public:
+    explicit wait_group( std::size_t count = 0) BOOST_NOEXCEPT :
+        lock_(),
+        count_( count),
+        waiters_()
+    {}
+
+    ~wait_group()
+    { BOOST_ASSERT( waiters_.empty() ); }
+
+    std::size_t count() const BOOST_NOEXCEPT
+    {
+        lock_guard< detail::spinlock > lk( lock_);
+        return count_;
+    }
+
+    void add( std::size_t n = 1) BOOST_NOEXCEPT
+    {
+        lock_guard< detail::spinlock > lk( lock_);
+        count_ += n;
+    }
+
+    void done() BOOST_NOEXCEPT;
+
+    void wait();
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_WAIT_GROUP_H
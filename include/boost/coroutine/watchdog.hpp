@@ -0,0 +1,63 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_WATCHDOG_H
+#define BOOST_COROUTINES_WATCHDOG_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/chrono/duration.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// a coroutine that held its thread longer than the threshold
+struct coroutine_stall
+{
+    // execution context of the coroutine (0 if the thread was not sampled)
+    void const                  *   coroutine;
+    std::string                     label;
+    // since the coroutine was entered, at the resolution of the watchdog
+    chrono::milliseconds            held;
+    // symbolized call stack sampled on the stalled thread, innermost first
+    std::vector< std::string >      frames;
+};
+
+namespace watchdog {
+
+typedef void( * stall_handler)( coroutine_stall const&);
+
+// a monitor thread checks every `threshold` / 4 which threads run the
+// same coroutine since more than `threshold` and samples each of them
+// once per stall (BOOST_COROUTINES_WATCHDOG_SIGNAL, SIGURG by default);
+// `handler` is called on the monitor thread - without it the stall is
+// written to stderr
+// threads are watched from their first switch while running; on the
+// switch path the time of each switch is stored
+BOOST_COROUTINES_DECL void start( chrono::milliseconds threshold, stall_handler handler = 0);
+
+BOOST_COROUTINES_DECL void stop() BOOST_NOEXCEPT;
+
+BOOST_COROUTINES_DECL bool running() BOOST_NOEXCEPT;
+
+// stalls reported since the process started
+BOOST_COROUTINES_DECL std::size_t stalls() BOOST_NOEXCEPT;
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_WATCHDOG_H
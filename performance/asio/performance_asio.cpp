@@ -0,0 +1,291 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/asio.hpp>
+#include <boost/coroutine/pooled_stack_allocator.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+// counts the calls of operator new - heap allocations per request
+std::size_t allocations = 0;
+
+void * operator new( std::size_t size)
+{
+    ++allocations;
+    void * p = std::malloc( size ? size : 1);
+    if ( 0 == p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete( void * p) BOOST_NOEXCEPT
+{ std::free( p); }
+
+void operator delete( void * p, std::size_t) BOOST_NOEXCEPT
+{ std::free( p); }
+
+typedef boost::asio::local::stream_protocol::socket     socket_t;
+
+boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
+std::size_t connections = 100;
+std::size_t requests = 1000;
+std::size_t size = 64;
+std::size_t jobs = 100000;
+perf_counters counters;
+
+// `name` without the padding
+std::string label( char const* name)
+{
+    std::string s( name);
+    s.erase( s.find_last_not_of(" :") + 1);
+    return s;
+}
+
+// client side, identical for both servers: writes a request and
+// reads the echo, requests times
+class client
+{
+private:
+    socket_t                &   s_;
+    std::vector< char >         buf_;
+    std::size_t                 left_;
+
+    void write_()
+    {
+        boost::asio::async_write( s_, boost::asio::buffer( buf_),
+            boost::bind( & client::on_write_, this, boost::asio::placeholders::error) );
+    }
+
+    void on_write_( boost::system::error_code const& ec)
+    {
+        if ( ec) return;
+        boost::asio::async_read( s_, boost::asio::buffer( buf_),
+            boost::bind( & client::on_read_, this, boost::asio::placeholders::error) );
+    }
+
+    void on_read_( boost::system::error_code const& ec)
+    {
+        if ( ec) return;
+        if ( 0 < --left_) write_();
+        else s_.shutdown( socket_t::shutdown_send);
+    }
+
+public:
+    explicit client( socket_t & s) :
+        s_( s), buf_( size, 'x'), left_( requests)
+    { write_(); }
+};
+
+// stackless server session: a chain of completion handlers
+class session
+{
+private:
+    socket_t                &   s_;
+    std::vector< char >         buf_;
+
+    void read_()
+    {
+        s_.async_read_some( boost::asio::buffer( buf_),
+            boost::bind( & session::on_read_, this,
+                         boost::asio::placeholders::error,
+                         boost::asio::placeholders::bytes_transferred) );
+    }
+
+    void on_read_( boost::system::error_code const& ec, std::size_t n)
+    {
+        if ( ec) return;
+        boost::asio::async_write( s_, boost::asio::buffer( & buf_[0], n),
+            boost::bind( & session::on_write_, this, boost::asio::placeholders::error) );
+    }
+
+    void on_write_( boost::system::error_code const& ec)
+    {
+        if ( ! ec) read_();
+    }
+
+public:
+    explicit session( socket_t & s) :
+        s_( s), buf_( size)
+    { read_(); }
+};
+
+// stackful server session: one coroutine per connection
+void fn_session( socket_t & s, boost::coroutines::yield_context yield)
+{
+    std::vector< char > buf( size);
+    boost::system::error_code ec;
+    for (;;)
+    {
+        std::size_t n = s.async_read_some( boost::asio::buffer( buf), yield[ec]);
+        if ( ec) break;
+        boost::asio::async_write( s, boost::asio::buffer( & buf[0], n), yield[ec]);
+        if ( ec) break;
+    }
+}
+
+void fn_empty( boost::coroutines::yield_context)
+{}
+
+void fn_handler()
+{}
+
+template< typename StackAllocator >
+void measure_echo( char const* name, bool stackful, StackAllocator alloc)
+{
+    boost::asio::io_context ioc;
+    std::vector< socket_t * > sockets;
+    std::vector< client * > clients;
+    std::vector< session * > sessions;
+    for ( std::size_t i = 0; i < connections; ++i)
+    {
+        sockets.push_back( new socket_t( ioc) );
+        sockets.push_back( new socket_t( ioc) );
+        boost::asio::local::connect_pair( * sockets[2 * i], * sockets[2 * i + 1]);
+    }
+    std::size_t before = allocations;
+    counters.start();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < connections; ++i)
+    {
+        if ( stackful)
+            boost::coroutines::spawn(
+                boost::bind( fn_session, boost::ref( * sockets[2 * i + 1]), _1),
+                boost::coroutines::attributes( preserve_fpu), alloc);
+        else
+            sessions.push_back( new session( * sockets[2 * i + 1]) );
+        clients.push_back( new client( * sockets[2 * i]) );
+    }
+    ioc.run();
+    duration_type elapsed = clock_type::now() - start;
+    counters.stop();
+    std::size_t allocated = allocations - before;
+
+    std::size_t n = connections * requests;
+    std::cout << "  " << name
+              << static_cast< boost::uint64_t >( n / boost::chrono::duration_cast<
+                      boost::chrono::duration< double > >( elapsed).count() )
+              << " requests/sec, " << double( allocated) / n << " allocations per request"
+              << std::endl;
+    print_counters( std::cout, "  " + label( name), counters, n, "request");
+
+    for ( std::size_t i = 0; i < clients.size(); ++i) delete clients[i];
+    for ( std::size_t i = 0; i < sessions.size(); ++i) delete sessions[i];
+    for ( std::size_t i = 0; i < sockets.size(); ++i) delete sockets[i];
+}
+
+template< typename StackAllocator >
+void measure_spawn( char const* name, StackAllocator alloc)
+{
+    // warm up the pool
+    boost::coroutines::spawn( fn_empty, boost::coroutines::attributes( preserve_fpu), alloc);
+    std::size_t before = allocations;
+    counters.start();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i)
+        boost::coroutines::spawn( fn_empty, boost::coroutines::attributes( preserve_fpu), alloc);
+    duration_type elapsed = clock_type::now() - start;
+    counters.stop();
+    std::size_t allocated = allocations - before;
+    std::cout << "  " << name << ( elapsed / jobs).count() << " nano seconds, "
+              << double( allocated) / jobs << " allocations" << std::endl;
+    print_counters( std::cout, "  " + label( name), counters, jobs, "spawn");
+}
+
+void measure_post()
+{
+    boost::asio::io_context ioc;
+    boost::asio::post( ioc, fn_handler);
+    ioc.run();
+    ioc.restart();
+    std::size_t before = allocations;
+    counters.start();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i)
+    {
+        boost::asio::post( ioc, fn_handler);
+        ioc.run_one();
+    }
+    duration_type elapsed = clock_type::now() - start;
+    counters.stop();
+    std::size_t allocated = allocations - before;
+    std::cout << "  post + run_one (stackless):  " << ( elapsed / jobs).count() << " nano seconds, "
+              << double( allocated) / jobs << " allocations" << std::endl;
+    print_counters( std::cout, "  post + run_one (stackless)", counters, jobs, "post");
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool preserve = false, bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("connections,c", boost::program_options::value< std::size_t >( & connections), "concurrent connections")
+            ("requests,r", boost::program_options::value< std::size_t >( & requests), "requests per connection")
+            ("size,s", boost::program_options::value< std::size_t >( & size), "bytes per request")
+            ("jobs,j", boost::program_options::value< std::size_t >( & jobs), "coroutines to spawn");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
+        if ( bind) bind_to_processor( 0);
+        if ( 0 == connections || 0 == requests || 0 == size || 0 == jobs)
+            throw std::invalid_argument("connections, requests, size and jobs must not be 0");
+
+        boost::coroutines::pooled_stack_allocator pool;
+        print_counters_unavailable( std::cout, counters);
+        std::cout << "spawn:" << std::endl;
+        measure_spawn( "standard stacks:             ", boost::coroutines::stack_allocator() );
+        measure_spawn( "pooled stacks:               ", pool);
+        measure_post();
+
+        std::cout << "echo (" << connections << " connections, " << size << " bytes):" << std::endl;
+        measure_echo( "stackless handlers:          ", false, pool);
+        measure_echo( "coroutines, standard stacks: ", true, boost::coroutines::stack_allocator() );
+        measure_echo( "coroutines, pooled stacks:   ", true, pool);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,318 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <list>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include "clock.hpp"
+
+// log-linear histogram (HDR-style): values below 128 are counted exactly,
+// above in 64 linear sub-buckets per power of two (< 1.6% error)
+class histogram
+{
+private:
+    enum
+    {
+        sub_bits = 7,
+        half = 1 << ( sub_bits - 1)
+    };
+
+    std::vector< boost::uint64_t >  counts_;
+    boost::uint64_t                 count_;
+    boost::uint64_t                 min_;
+    boost::uint64_t                 max_;
+    double                          sum_;
+
+    static std::size_t index_( boost::uint64_t v)
+    {
+        unsigned int shift = 0;
+        while ( ( v >> shift) >= ( 1u << sub_bits) ) ++shift;
+        return shift * half + static_cast< std::size_t >( v >> shift);
+    }
+
+    // highest value counted in bucket `i`
+    static boost::uint64_t value_( std::size_t i)
+    {
+        if ( i < ( 1u << sub_bits) ) return i;
+        unsigned int shift = static_cast< unsigned int >( i / half - 1);
+        boost::uint64_t sub = i - shift * half;
+        return ( ( sub + 1) << shift) - 1;
+    }
+
+public:
+    histogram() :
+        counts_( ( 64 - sub_bits + 2) * half, 0),
+        count_( 0), min_( 0), max_( 0), sum_( 0)
+    {}
+
+    void record( boost::uint64_t v)
+    {
+        ++counts_[index_( v)];
+        if ( 0 == count_ || v < min_) min_ = v;
+        if ( v > max_) max_ = v;
+        ++count_;
+        sum_ += static_cast< double >( v);
+    }
+
+    void merge( histogram const& other)
+    {
+        for ( std::size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+        if ( 0 != other.count_ && ( 0 == count_ || other.min_ < min_) ) min_ = other.min_;
+        max_ = ( std::max)( max_, other.max_);
+        count_ += other.count_;
+        sum_ += other.sum_;
+    }
+
+    boost::uint64_t count() const
+    { return count_; }
+
+    boost::uint64_t min() const
+    { return min_; }
+
+    boost::uint64_t max() const
+    { return max_; }
+
+    double mean() const
+    { return 0 == count_ ? 0 : sum_ / count_; }
+
+    // smallest recorded value (bucket) at or above `p` percent of the samples
+    boost::uint64_t percentile( double p) const
+    {
+        if ( 0 == count_) return 0;
+        boost::uint64_t rank = static_cast< boost::uint64_t >( p / 100 * count_ + 0.5);
+        if ( 0 == rank) rank = 1;
+        boost::uint64_t seen = 0;
+        for ( std::size_t i = 0; i < counts_.size(); ++i)
+        {
+            seen += counts_[i];
+            if ( seen >= rank) return ( std::min)( value_( i), max_);
+        }
+        return max_;
+    }
+};
+
+enum output_format
+{
+    output_text = 0,
+    output_json,
+    output_csv
+};
+
+inline
+output_format parse_format( std::string const& s)
+{
+    if ( "text" == s) return output_text;
+    if ( "json" == s) return output_json;
+    if ( "csv" == s) return output_csv;
+    throw std::invalid_argument("format must be text, json or csv");
+}
+
+// latency of one operation measured with clock_type: median of back-to-back
+// reads, subtracted from each sample
+inline
+boost::uint64_t clock_floor()
+{
+    std::vector< boost::uint64_t > v( 1001);
+    for ( std::size_t i = 0; i < v.size(); ++i)
+    {
+        time_point_type start( clock_type::now() );
+        v[i] = ( clock_type::now() - start).count();
+    }
+    std::nth_element( v.begin(), v.begin() + v.size() / 2, v.end() );
+    return v[v.size() / 2];
+}
+
+inline
+boost::uint64_t elapsed( time_point_type start, time_point_type end, boost::uint64_t floor)
+{
+    boost::uint64_t d = ( end - start).count();
+    return d > floor ? d - floor : 0;
+}
+
+// histograms of the latencies of a benchmark, one per series (e.g.
+// `create`, `destroy`) and repetition
+class latency_report
+{
+private:
+    struct series
+    {
+        std::string                 name;
+        std::deque< histogram >     repetitions;
+    };
+
+    std::string             benchmark_;
+    std::list< series >     series_;
+
+    static void stats_json_( std::ostream & os, histogram const& h)
+    {
+        os << "{\"count\": " << h.count()
+           << ", \"min\": " << h.min()
+           << ", \"mean\": " << h.mean()
+           << ", \"p50\": " << h.percentile( 50)
+           << ", \"p90\": " << h.percentile( 90)
+           << ", \"p99\": " << h.percentile( 99)
+           << ", \"p99.9\": " << h.percentile( 99.9)
+           << ", \"max\": " << h.max() << "}";
+    }
+
+    void stats_csv_( std::ostream & os, std::string const& name, std::string const& rep, histogram const& h) const
+    {
+        os << benchmark_ << ',' << name << ',' << rep << ','
+           << h.count() << ',' << h.min() << ',' << h.mean() << ','
+           << h.percentile( 50) << ',' << h.percentile( 90) << ','
+           << h.percentile( 99) << ',' << h.percentile( 99.9) << ','
+           << h.max() << '\n';
+    }
+
+public:
+    latency_report( std::string const& benchmark) :
+        benchmark_( benchmark), series_()
+    {}
+
+    // histogram of `name` in repetition `rep`; stays valid
+    histogram & at( std::string const& name, std::size_t rep)
+    {
+        std::list< series >::iterator it = series_.begin();
+        while ( series_.end() != it && it->name != name) ++it;
+        if ( series_.end() == it)
+        {
+            it = series_.insert( series_.end(), series() );
+            it->name = name;
+        }
+        if ( it->repetitions.size() <= rep)
+            it->repetitions.resize( rep + 1);
+        return it->repetitions[rep];
+    }
+
+    // values in nano seconds; each series with its repetitions merged
+    // (text), and each repetition separately (json, csv)
+    void write( std::ostream & os, output_format format) const
+    {
+        if ( output_json == format)
+        {
+            os << "{\"benchmark\": \"" << benchmark_ << "\", \"unit\": \"ns\", \"series\": [";
+            for ( std::list< series >::const_iterator it = series_.begin(); it != series_.end(); ++it)
+            {
+                histogram all;
+                os << ( series_.begin() == it ? "" : ", ") << "{\"name\": \"" << it->name << "\", \"repetitions\": [";
+                for ( std::size_t j = 0; j < it->repetitions.size(); ++j)
+                {
+                    if ( 0 != j) os << ", ";
+                    stats_json_( os, it->repetitions[j]);
+                    all.merge( it->repetitions[j]);
+                }
+                os << "], \"all\": ";
+                stats_json_( os, all);
+                os << "}";
+            }
+            os << "]}" << std::endl;
+        }
+        else if ( output_csv == format)
+        {
+            os << "benchmark,series,repetition,count,min,mean,p50,p90,p99,p99.9,max\n";
+            for ( std::list< series >::const_iterator it = series_.begin(); it != series_.end(); ++it)
+            {
+                histogram all;
+                for ( std::size_t j = 0; j < it->repetitions.size(); ++j)
+                {
+                    char rep[16];
+                    std::sprintf( rep, "%u", static_cast< unsigned int >( j) );
+                    stats_csv_( os, it->name, rep, it->repetitions[j]);
+                    all.merge( it->repetitions[j]);
+                }
+                stats_csv_( os, it->name, "all", all);
+            }
+            os.flush();
+        }
+        else
+        {
+            for ( std::list< series >::const_iterator it = series_.begin(); it != series_.end(); ++it)
+            {
+                histogram all;
+                for ( std::size_t j = 0; j < it->repetitions.size(); ++j)
+                    all.merge( it->repetitions[j]);
+                os << it->name << ": p50 " << all.percentile( 50)
+                   << ", p90 " << all.percentile( 90)
+                   << ", p99 " << all.percentile( 99)
+                   << ", p99.9 " << all.percentile( 99.9)
+                   << ", max " << all.max() << " nano seconds ("
+                   << it->repetitions.size() << " x "
+                   << ( it->repetitions.empty() ? 0 : it->repetitions[0].count() )
+                   << " samples)" << std::endl;
+            }
+        }
+    }
+};
+
+// `warmup` calls of `resume`, then `repetitions` times `jobs` calls timed
+// one by one; a call switches into the coroutine and back, half of it is
+// recorded
+template< typename Resume >
+void measure_switch( latency_report & report, std::string const& name, Resume & resume,
+                     boost::uint64_t warmup, boost::uint64_t jobs, std::size_t repetitions)
+{
+    boost::uint64_t floor = clock_floor();
+
+    for ( boost::uint64_t i = 0; i < warmup; ++i)
+        resume();
+    for ( std::size_t r = 0; r < repetitions; ++r)
+    {
+        histogram & h = report.at( name, r);
+        for ( boost::uint64_t i = 0; i < jobs; ++i)
+        {
+            time_point_type start( clock_type::now() );
+            resume();
+            time_point_type end( clock_type::now() );
+            h.record( elapsed( start, end, floor) / 2);
+        }
+    }
+}
+
+// `warmup` coroutines created and destroyed, then `repetitions` times
+// `jobs`: the constructor and the destructor of `Coro` timed separately
+template< typename Coro, typename Fn, typename Attributes, typename StackAllocator >
+void measure_create_destroy( latency_report & report, Fn fn, Attributes const& attrs,
+                             StackAllocator & stack_alloc, boost::uint64_t warmup,
+                             boost::uint64_t jobs, std::size_t repetitions)
+{
+    typename boost::aligned_storage< sizeof( Coro), boost::alignment_of< Coro >::value >::type storage;
+    boost::uint64_t floor = clock_floor();
+
+    for ( boost::uint64_t i = 0; i < warmup; ++i)
+    { Coro c( fn, attrs, stack_alloc); }
+    for ( std::size_t r = 0; r < repetitions; ++r)
+    {
+        histogram & create = report.at("create", r);
+        histogram & destroy = report.at("destroy", r);
+        for ( boost::uint64_t i = 0; i < jobs; ++i)
+        {
+            time_point_type start( clock_type::now() );
+            Coro * c = new ( storage.address() ) Coro( fn, attrs, stack_alloc);
+            time_point_type created( clock_type::now() );
+            c->~Coro();
+            time_point_type destroyed( clock_type::now() );
+            create.record( elapsed( start, created, floor) );
+            destroy.record( elapsed( created, destroyed, floor) );
+        }
+    }
+}
+
+#endif // LATENCY_H
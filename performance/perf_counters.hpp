@@ -0,0 +1,113 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+enum perf_event
+{
+    perf_instructions = 0,
+    perf_cycles,
+    perf_l1d_misses,
+    perf_llc_misses,
+    perf_dtlb_misses,
+    perf_branch_misses,
+    perf_event_count
+};
+
+inline
+char const* perf_event_name( perf_event e)
+{
+    static char const* names[perf_event_count] = {
+        "instructions", "cycles", "L1d misses", "LLC misses", "dTLB misses", "branch misses" };
+    return names[e];
+}
+
+// hardware counters of the calling thread (and of the threads it creates
+// afterwards, once they exited), user space only; counters the kernel, the
+// PMU or the container does not provide are left out
+class perf_counters : private boost::noncopyable
+{
+private:
+    int                 fds_[perf_event_count];
+    boost::uint64_t     values_[perf_event_count];
+    std::string         reason_;
+
+public:
+    perf_counters();
+
+    ~perf_counters();
+
+    // at least one counter was opened
+    bool available() const;
+
+    bool available( perf_event e) const
+    { return -1 != fds_[e]; }
+
+    // why no (or not every) counter was opened
+    std::string const& reason() const
+    { return reason_; }
+
+    // resets and enables the counters
+    void start();
+
+    // disables the counters and reads them
+    void stop();
+
+    // count between the last start() and stop(), scaled if the counter
+    // was multiplexed
+    boost::uint64_t value( perf_event e) const
+    { return values_[e]; }
+};
+
+// writes the counts divided by `ops`, e.g.
+// "void: 180.2 instructions, 61.5 cycles, ... per switch"
+inline
+void print_counters( std::ostream & os, std::string const& what, perf_counters const& counters,
+                     boost::uint64_t ops, char const* unit)
+{
+    if ( ! counters.available() || 0 == ops) return;
+    os << what << ":";
+    char const* sep = " ";
+    for ( int i = 0; i < perf_event_count; ++i)
+    {
+        perf_event e = static_cast< perf_event >( i);
+        if ( ! counters.available( e) ) continue;
+        char buf[32];
+        std::sprintf( buf, "%.1f", static_cast< double >( counters.value( e) ) / ops);
+        os << sep << buf << " " << perf_event_name( e);
+        sep = ", ";
+    }
+    os << " per " << unit << std::endl;
+}
+
+// states once why the counters are not written
+inline
+void print_counters_unavailable( std::ostream & os, perf_counters const& counters)
+{
+    if ( ! counters.available() )
+        os << "hardware counters not available: " << counters.reason() << std::endl;
+}
+
+// counts `jobs` calls of `fn` following `warmup` calls
+template< typename Fn >
+void count_events( perf_counters & counters, Fn & fn, boost::uint64_t warmup, boost::uint64_t jobs)
+{
+    for ( boost::uint64_t i = 0; i < warmup; ++i)
+        fn();
+    counters.start();
+    for ( boost::uint64_t i = 0; i < jobs; ++i)
+        fn();
+    counters.stop();
+}
+
+#endif // PERF_COUNTERS_H
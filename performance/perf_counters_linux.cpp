@@ -0,0 +1,131 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "perf_counters.hpp"
+
+extern "C"
+{
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+#include <cstring>
+
+#include <boost/config/abi_prefix.hpp>
+
+namespace {
+
+struct event_config
+{
+    boost::uint32_t     type;
+    boost::uint64_t     config;
+};
+
+#define CACHE_MISS( cache) \
+    ( ( cache) | ( PERF_COUNT_HW_CACHE_OP_READ << 8) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16) )
+
+// indexed by perf_event
+event_config const events[perf_event_count] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HW_CACHE, CACHE_MISS( PERF_COUNT_HW_CACHE_L1D) },
+    { PERF_TYPE_HW_CACHE, CACHE_MISS( PERF_COUNT_HW_CACHE_LL) },
+    { PERF_TYPE_HW_CACHE, CACHE_MISS( PERF_COUNT_HW_CACHE_DTLB) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+};
+
+#undef CACHE_MISS
+
+int open_event( event_config const& ev)
+{
+    struct perf_event_attr attr;
+    std::memset( & attr, 0, sizeof( attr) );
+    attr.size = sizeof( attr);
+    attr.type = ev.type;
+    attr.config = ev.config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // counters are opened separately - more than the PMU holds are multiplexed
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast< int >( ::syscall( __NR_perf_event_open, & attr, 0, -1, -1, 0) );
+}
+
+}
+
+perf_counters::perf_counters() :
+    reason_()
+{
+    int errs[perf_event_count];
+    bool same = true;
+    for ( int i = 0; i < perf_event_count; ++i)
+    {
+        values_[i] = 0;
+        fds_[i] = open_event( events[i]);
+        errs[i] = -1 == fds_[i] ? errno : 0;
+        same = same && errs[i] == errs[0];
+    }
+    // e.g. EACCES (perf_event_paranoid), ENOENT (no PMU), ENOSYS (seccomp)
+    if ( same && 0 != errs[0])
+    {
+        reason_ = std::strerror( errs[0]);
+        return;
+    }
+    for ( int i = 0; i < perf_event_count; ++i)
+    {
+        if ( 0 == errs[i]) continue;
+        if ( ! reason_.empty() ) reason_ += ", ";
+        reason_ += perf_event_name( static_cast< perf_event >( i) );
+        reason_ += ": ";
+        reason_ += std::strerror( errs[i]);
+    }
+}
+
+perf_counters::~perf_counters()
+{
+    for ( int i = 0; i < perf_event_count; ++i)
+        if ( -1 != fds_[i]) ::close( fds_[i]);
+}
+
+bool
+perf_counters::available() const
+{
+    for ( int i = 0; i < perf_event_count; ++i)
+        if ( -1 != fds_[i]) return true;
+    return false;
+}
+
+void
+perf_counters::start()
+{
+    for ( int i = 0; i < perf_event_count; ++i)
+        if ( -1 != fds_[i]) ::ioctl( fds_[i], PERF_EVENT_IOC_RESET, 0);
+    for ( int i = 0; i < perf_event_count; ++i)
+        if ( -1 != fds_[i]) ::ioctl( fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void
+perf_counters::stop()
+{
+    for ( int i = 0; i < perf_event_count; ++i)
+        if ( -1 != fds_[i]) ::ioctl( fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+    for ( int i = 0; i < perf_event_count; ++i)
+    {
+        values_[i] = 0;
+        if ( -1 == fds_[i]) continue;
+        // value, time enabled, time running
+        boost::uint64_t buf[3] = { 0, 0, 0 };
+        if ( sizeof( buf) != ::read( fds_[i], buf, sizeof( buf) ) || 0 == buf[2]) continue;
+        values_[i] = buf[2] < buf[1]
+            ? static_cast< boost::uint64_t >( static_cast< double >( buf[0]) * buf[1] / buf[2])
+            : buf[0];
+    }
+}
+
+#include <boost/config/abi_suffix.hpp>
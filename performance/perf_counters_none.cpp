@@ -0,0 +1,35 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "perf_counters.hpp"
+
+#include <boost/config/abi_prefix.hpp>
+
+perf_counters::perf_counters() :
+    reason_("not supported on this platform")
+{
+    for ( int i = 0; i < perf_event_count; ++i)
+    {
+        fds_[i] = -1;
+        values_[i] = 0;
+    }
+}
+
+perf_counters::~perf_counters()
+{}
+
+bool
+perf_counters::available() const
+{ return false; }
+
+void
+perf_counters::start()
+{}
+
+void
+perf_counters::stop()
+{}
+
+#include <boost/config/abi_suffix.hpp>
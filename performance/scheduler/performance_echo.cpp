@@ -0,0 +1,250 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+}
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
+std::size_t connections = 10000;
+std::size_t requests = 10;
+std::size_t size = 64;
+// reactor, uring or epoll (io_engine)
+std::string engine("reactor");
+// batch latency of the io_engine in micro seconds, negative: one tick
+long latency = -1;
+perf_counters counters;
+
+struct result
+{
+    std::vector< duration_type >    latencies;
+    time_point_type                 start;
+    time_point_type                 end;
+    std::size_t                     failed;
+
+    result() :
+        latencies(), start(), end(), failed( 0)
+    { latencies.reserve( connections * requests); }
+};
+
+template< typename IO >
+void fn_session( IO & r, int fd)
+{
+    std::vector< char > buf( size);
+    boost::system::error_code ec;
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_read( fd, & buf[0], buf.size(), ec) ) )
+    {
+        r.async_write( fd, & buf[0], n, ec);
+        if ( ec) break;
+    }
+    r.remove( fd);
+    ::close( fd);
+}
+
+template< typename IO >
+void fn_server( IO & r, int lfd)
+{
+    for ( std::size_t i = 0; i < connections; ++i)
+    {
+        int fd = r.async_accept( lfd);
+        int one = 1;
+        ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, & one, sizeof( one) );
+        boost::coroutines::scheduler::instance()->spawn(
+            boost::bind( fn_session< IO >, boost::ref( r), fd),
+            boost::coroutines::attributes( preserve_fpu) );
+    }
+}
+
+template< typename IO >
+void fn_client( IO & r, sockaddr_in const& addr,
+                boost::coroutines::barrier & connected, result & res)
+{
+    int fd = ::socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if ( -1 == fd) throw std::runtime_error("socket() failed");
+    int one = 1;
+    ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, & one, sizeof( one) );
+    r.add( fd);
+    boost::system::error_code ec;
+    r.async_connect( fd, reinterpret_cast< sockaddr const* >( & addr), sizeof( addr), ec);
+    // all connections are established before the measurement starts
+    if ( connected.arrive_and_wait() )
+    {
+        counters.start();
+        res.start = clock_type::now();
+    }
+    std::vector< char > msg( size, 'x'), buf( size);
+    std::size_t i = 0;
+    for ( ; ! ec && i < requests; ++i)
+    {
+        time_point_type start( clock_type::now() );
+        r.async_write( fd, & msg[0], msg.size(), ec);
+        std::size_t n = 0;
+        while ( ! ec && n < buf.size() )
+        {
+            std::size_t m = r.async_read( fd, & buf[n], buf.size() - n, ec);
+            if ( 0 == m) break;
+            n += m;
+        }
+        if ( n != buf.size() ) break;
+        res.latencies.push_back( clock_type::now() - start);
+    }
+    if ( i < requests) ++res.failed;
+    res.end = clock_type::now();
+    r.remove( fd);
+    ::close( fd);
+}
+
+template< typename IO >
+void run( boost::coroutines::scheduler & sched, IO & io, int lfd,
+          sockaddr_in const& addr, result & res)
+{
+    boost::coroutines::barrier connected( connections);
+    io.add( lfd);
+    sched.spawn( boost::bind( fn_server< IO >, boost::ref( io), lfd),
+                 boost::coroutines::attributes( preserve_fpu) );
+    for ( std::size_t i = 0; i < connections; ++i)
+        sched.spawn( boost::bind( fn_client< IO >, boost::ref( io), boost::cref( addr),
+                                  boost::ref( connected), boost::ref( res) ),
+                     boost::coroutines::attributes( preserve_fpu) );
+    sched.run();
+}
+
+void measure()
+{
+    int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+    if ( -1 == lfd) throw std::runtime_error("socket() failed");
+    int one = 1;
+    ::setsockopt( lfd, SOL_SOCKET, SO_REUSEADDR, & one, sizeof( one) );
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    socklen_t len = sizeof( addr);
+    if ( 0 != ::bind( lfd, reinterpret_cast< sockaddr * >( & addr), len) ||
+         0 != ::getsockname( lfd, reinterpret_cast< sockaddr * >( & addr), & len) ||
+         0 != ::listen( lfd, SOMAXCONN) )
+        throw std::runtime_error("bind()/listen() failed");
+
+    result res;
+    {
+        boost::coroutines::scheduler sched;
+        if ( "reactor" == engine)
+        {
+            boost::coroutines::reactor r( sched);
+            run( sched, r, lfd, addr, res);
+        }
+        else
+        {
+            // the submission queue holds the entries of all connections
+            boost::coroutines::io_engine e(
+                sched,
+                "epoll" == engine ? boost::coroutines::io_backend_epoll : boost::coroutines::io_backend_auto,
+                4096);
+            if ( 0 <= latency) e.batch_latency( boost::chrono::microseconds( latency) );
+            run( sched, e, lfd, addr, res);
+        }
+    }
+    counters.stop();
+    ::close( lfd);
+
+    if ( res.latencies.empty() ) throw std::runtime_error("no request completed");
+    std::sort( res.latencies.begin(), res.latencies.end() );
+    duration_type elapsed = res.end - res.start;
+    double rate = res.latencies.size() /
+        boost::chrono::duration_cast< boost::chrono::duration< double > >( elapsed).count();
+    std::size_t n = res.latencies.size();
+    std::cout << "echo (" << engine << ", " << connections << " connections, " << size << " bytes): "
+              << static_cast< boost::uint64_t >( rate) << " requests/sec" << std::endl;
+    std::cout << "latency: p50 " << res.latencies[n / 2].count()
+              << ", p99 " << res.latencies[( n * 99) / 100].count()
+              << ", max " << res.latencies[n - 1].count() << " nano seconds" << std::endl;
+    if ( 0 < res.failed)
+        std::cout << res.failed << " connections failed" << std::endl;
+    print_counters_unavailable( std::cout, counters);
+    print_counters( std::cout, "echo", counters, n, "request");
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool preserve = false, bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("connections,c", boost::program_options::value< std::size_t >( & connections), "concurrent connections")
+            ("requests,r", boost::program_options::value< std::size_t >( & requests), "requests per connection")
+            ("size,s", boost::program_options::value< std::size_t >( & size), "bytes per request")
+            ("engine,e", boost::program_options::value< std::string >( & engine), "reactor, uring or epoll (io_engine)")
+            ("latency,l", boost::program_options::value< long >( & latency), "batch latency of io_engine in micro seconds (default: one tick)");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
+        if ( bind) bind_to_processor( 0);
+        if ( 0 == connections || 0 == requests || 0 == size)
+            throw std::invalid_argument("connections, requests and size must not be 0");
+        if ( "reactor" != engine && "uring" != engine && "epoll" != engine)
+            throw std::invalid_argument("engine must be reactor, uring or epoll");
+
+        // two descriptors per connection
+        rlimit rl;
+        if ( 0 == ::getrlimit( RLIMIT_NOFILE, & rl) && rl.rlim_cur < rl.rlim_max)
+        {
+            rl.rlim_cur = rl.rlim_max;
+            ::setrlimit( RLIMIT_NOFILE, & rl);
+        }
+        ::signal( SIGPIPE, SIG_IGN);
+
+        measure();
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
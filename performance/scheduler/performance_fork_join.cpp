@@ -0,0 +1,124 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/coroutine/fork_join_pool.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
+int n = 30;
+int cutoff = 0;
+std::size_t workers = 0;
+perf_counters counters;
+
+long fib_serial( int i)
+{ return i < 2 ? i : fib_serial( i - 1) + fib_serial( i - 2); }
+
+void fib( int i, long & result)
+{
+    if ( i < 2 || i <= cutoff)
+    {
+        result = fib_serial( i);
+        return;
+    }
+    long x = 0, y = 0;
+    boost::coroutines::fork_join_pool::spawn( boost::bind( fib, i - 1, boost::ref( x) ) );
+    fib( i - 2, y);
+    boost::coroutines::fork_join_pool::sync();
+    result = x + y;
+}
+
+duration_type measure( std::size_t w, long & result)
+{
+    duration_type elapsed;
+    {
+        boost::coroutines::fork_join_pool pool(
+            w, boost::coroutines::attributes( preserve_fpu) );
+        // warm up the stack caches of the workers
+        pool.run( boost::bind( fib, n / 2, boost::ref( result) ) );
+
+        counters.start();
+        time_point_type start( clock_type::now() );
+        pool.run( boost::bind( fib, n, boost::ref( result) ) );
+        elapsed = clock_type::now() - start;
+    }
+    // the counts of the workers are added as they exit
+    counters.stop();
+    return elapsed;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool preserve = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("fib,n", boost::program_options::value< int >( & n), "compute fib(n)")
+            ("cutoff,c", boost::program_options::value< int >( & cutoff), "serial below this n")
+            ("workers,w", boost::program_options::value< std::size_t >( & workers), "maximum number of workers");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
+        if ( 0 == workers) workers = boost::thread::hardware_concurrency();
+        if ( 0 == workers) workers = 1;
+
+        print_counters_unavailable( std::cout, counters);
+        time_point_type start( clock_type::now() );
+        long expected = fib_serial( n);
+        duration_type serial = clock_type::now() - start;
+        std::cout << "serial fib(" << n << "): "
+                  << boost::chrono::duration_cast< boost::chrono::milliseconds >( serial).count()
+                  << " ms" << std::endl;
+
+        duration_type one = duration_type::zero();
+        for ( std::size_t w = 1; w <= workers; w *= 2)
+        {
+            long result = 0;
+            duration_type elapsed = measure( w, result);
+            if ( result != expected) throw std::runtime_error("wrong result");
+            if ( 1 == w) one = elapsed;
+            std::cout << "fork-join fib(" << n << ") on " << w << " workers: "
+                      << boost::chrono::duration_cast< boost::chrono::milliseconds >( elapsed).count()
+                      << " ms, speedup " << double( one.count() ) / elapsed.count() << std::endl;
+            print_counters( std::cout, "  all workers", counters, 1, "run");
+            if ( w < workers && workers < 2 * w) w = workers / 2;
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
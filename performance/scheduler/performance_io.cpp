@@ -0,0 +1,343 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+}
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
+std::size_t file_size = 64 * 1024 * 1024;
+std::size_t block = 4096;
+std::size_t readers = 32;
+std::size_t workers = 4;
+std::size_t connections = 100;
+std::size_t requests = 1000;
+std::size_t size = 64;
+perf_counters counters;
+
+void fn_reader( boost::coroutines::io_engine & e, int fd, std::size_t first,
+                char * buf, boost::uint64_t & total)
+{
+    // reader i reads the blocks i, i + readers, i + 2 * readers, ...
+    for ( std::size_t off = first * block; off < file_size; off += readers * block)
+        total += e.async_read_at( fd, off, buf, block);
+}
+
+void fn_offload_reader( boost::coroutines::offload_pool & p, int fd, std::size_t first,
+                        char * buf, boost::uint64_t & total)
+{
+    for ( std::size_t off = first * block; off < file_size; off += readers * block)
+    {
+        ssize_t n = p.execute( boost::bind( ::pread, fd, buf, block, static_cast< off_t >( off) ) );
+        if ( 0 < n) total += n;
+    }
+}
+
+void fn_echo( boost::coroutines::io_engine & e, int fd)
+{
+    std::vector< char > buf( size);
+    boost::system::error_code ec;
+    std::size_t n = 0;
+    while ( 0 != ( n = e.async_read( fd, & buf[0], buf.size(), ec) ) )
+    {
+        e.async_write( fd, & buf[0], n, ec);
+        if ( ec) break;
+    }
+}
+
+void fn_ping( boost::coroutines::io_engine & e, int fd, boost::uint64_t & total)
+{
+    std::vector< char > msg( size, 'x'), buf( size);
+    for ( std::size_t i = 0; i < requests; ++i)
+    {
+        e.async_write( fd, & msg[0], msg.size() );
+        std::size_t n = 0;
+        while ( n < buf.size() )
+        {
+            std::size_t m = e.async_read( fd, & buf[n], buf.size() - n);
+            if ( 0 == m) throw std::runtime_error("connection closed");
+            n += m;
+        }
+        ++total;
+    }
+    ::shutdown( fd, SHUT_WR);
+}
+
+duration_type measure_file( int fd, boost::coroutines::io_backend backend, bool fixed)
+{
+    std::vector< char > buf( readers * block);
+    boost::uint64_t total = 0;
+    time_point_type start, end;
+    {
+        boost::coroutines::scheduler sched;
+        boost::coroutines::io_engine e( sched, backend);
+        if ( fixed)
+        {
+            iovec iov = { & buf[0], buf.size() };
+            e.register_buffers( & iov, 1);
+            e.register_files( & fd, 1);
+        }
+        for ( std::size_t i = 0; i < readers; ++i)
+            sched.spawn( boost::bind( fn_reader, boost::ref( e), fd, i, & buf[i * block],
+                                      boost::ref( total) ),
+                         boost::coroutines::attributes( preserve_fpu) );
+        counters.start();
+        start = clock_type::now();
+        sched.run();
+        end = clock_type::now();
+        if ( fixed)
+        {
+            e.unregister_files();
+            e.unregister_buffers();
+        }
+    }
+    counters.stop();
+    if ( total != file_size) throw std::runtime_error("short read");
+    return end - start;
+}
+
+duration_type measure_offload( int fd)
+{
+    std::vector< char > buf( readers * block);
+    boost::uint64_t total = 0;
+    time_point_type start, end;
+    {
+        boost::coroutines::offload_pool p( workers);
+        boost::coroutines::scheduler sched;
+        for ( std::size_t i = 0; i < readers; ++i)
+            sched.spawn( boost::bind( fn_offload_reader, boost::ref( p), fd, i, & buf[i * block],
+                                      boost::ref( total) ),
+                         boost::coroutines::attributes( preserve_fpu) );
+        counters.start();
+        start = clock_type::now();
+        sched.run();
+        end = clock_type::now();
+    }
+    counters.stop();
+    if ( total != file_size) throw std::runtime_error("short read");
+    return end - start;
+}
+
+duration_type measure_socket( std::vector< std::pair< int, int > > const& conns,
+                              boost::coroutines::io_backend backend)
+{
+    boost::uint64_t total = 0;
+    time_point_type start, end;
+    {
+        boost::coroutines::scheduler sched;
+        boost::coroutines::io_engine e( sched, backend);
+        for ( std::size_t i = 0; i < conns.size(); ++i)
+        {
+            e.add( conns[i].first);
+            e.add( conns[i].second);
+            sched.spawn( boost::bind( fn_echo, boost::ref( e), conns[i].second),
+                         boost::coroutines::attributes( preserve_fpu) );
+            sched.spawn( boost::bind( fn_ping, boost::ref( e), conns[i].first, boost::ref( total) ),
+                         boost::coroutines::attributes( preserve_fpu) );
+        }
+        counters.start();
+        start = clock_type::now();
+        sched.run();
+        end = clock_type::now();
+        for ( std::size_t i = 0; i < conns.size(); ++i)
+        {
+            e.remove( conns[i].first);
+            e.remove( conns[i].second);
+        }
+    }
+    counters.stop();
+    if ( total != conns.size() * requests) throw std::runtime_error("requests failed");
+    return end - start;
+}
+
+double per_second( std::size_t n, duration_type elapsed)
+{
+    return n / boost::chrono::duration_cast< boost::chrono::duration< double > >( elapsed).count();
+}
+
+void file_read()
+{
+    char path[] = "/tmp/performance_io_XXXXXX";
+    int fd = ::mkstemp( path);
+    if ( -1 == fd) throw std::runtime_error("mkstemp() failed");
+    ::unlink( path);
+    std::vector< char > chunk( 1024 * 1024, 'x');
+    for ( std::size_t n = 0; n < file_size; n += chunk.size() )
+        if ( static_cast< ssize_t >( chunk.size() ) != ::write( fd, & chunk[0], chunk.size() ) )
+            throw std::runtime_error("write() failed");
+
+    // warm up the page cache, the benchmark measures the submission path
+    measure_file( fd, boost::coroutines::io_backend_epoll, false);
+
+    double mb = file_size / ( 1024. * 1024.);
+    std::cout << "file read (" << mb << " MB, " << readers << " readers, "
+              << block << " bytes per block):" << std::endl;
+    std::cout << "  io_uring:                    "
+              << static_cast< boost::uint64_t >( per_second( file_size / block,
+                      measure_file( fd, boost::coroutines::io_backend_auto, false) ) )
+              << " blocks/sec" << std::endl;
+    print_counters( std::cout, "  io_uring", counters, file_size / block, "block");
+    std::cout << "  io_uring (fixed buffers):    "
+              << static_cast< boost::uint64_t >( per_second( file_size / block,
+                      measure_file( fd, boost::coroutines::io_backend_auto, true) ) )
+              << " blocks/sec" << std::endl;
+    print_counters( std::cout, "  io_uring (fixed buffers)", counters, file_size / block, "block");
+    std::cout << "  epoll (pread):               "
+              << static_cast< boost::uint64_t >( per_second( file_size / block,
+                      measure_file( fd, boost::coroutines::io_backend_epoll, false) ) )
+              << " blocks/sec" << std::endl;
+    print_counters( std::cout, "  epoll (pread)", counters, file_size / block, "block");
+    std::cout << "  offload_pool (" << workers << " workers):    "
+              << static_cast< boost::uint64_t >( per_second( file_size / block,
+                      measure_offload( fd) ) )
+              << " blocks/sec" << std::endl;
+    print_counters( std::cout, "  offload_pool", counters, file_size / block, "block");
+    ::close( fd);
+}
+
+void socket_ping_pong()
+{
+    int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+    if ( -1 == lfd) throw std::runtime_error("socket() failed");
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    socklen_t len = sizeof( addr);
+    if ( 0 != ::bind( lfd, reinterpret_cast< sockaddr * >( & addr), len) ||
+         0 != ::getsockname( lfd, reinterpret_cast< sockaddr * >( & addr), & len) ||
+         0 != ::listen( lfd, SOMAXCONN) )
+        throw std::runtime_error("bind()/listen() failed");
+
+    std::size_t n = connections * requests;
+    std::cout << "loopback ping-pong (" << connections << " connections, " << size << " bytes):" << std::endl;
+    for ( int i = 0; i < 2; ++i)
+    {
+        // the connections are established before the measurement starts
+        std::vector< std::pair< int, int > > conns;
+        for ( std::size_t j = 0; j < connections; ++j)
+        {
+            int fd = ::socket( AF_INET, SOCK_STREAM, 0);
+            if ( -1 == fd || 0 != ::connect( fd, reinterpret_cast< sockaddr * >( & addr), len) )
+                throw std::runtime_error("connect() failed");
+            int sfd = ::accept( lfd, 0, 0);
+            if ( -1 == sfd) throw std::runtime_error("accept() failed");
+            int one = 1;
+            ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, & one, sizeof( one) );
+            ::setsockopt( sfd, IPPROTO_TCP, TCP_NODELAY, & one, sizeof( one) );
+            conns.push_back( std::make_pair( fd, sfd) );
+        }
+        boost::coroutines::io_backend backend = 0 == i
+            ? boost::coroutines::io_backend_auto
+            : boost::coroutines::io_backend_epoll;
+        duration_type elapsed = measure_socket( conns, backend);
+        std::cout << ( 0 == i ? "  io_uring:                    " : "  epoll:                       ")
+                  << static_cast< boost::uint64_t >( per_second( n, elapsed) )
+                  << " requests/sec" << std::endl;
+        print_counters( std::cout, 0 == i ? "  io_uring" : "  epoll", counters, n, "request");
+        for ( std::size_t j = 0; j < conns.size(); ++j)
+        {
+            ::close( conns[j].first);
+            ::close( conns[j].second);
+        }
+    }
+    ::close( lfd);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool preserve = false, bind = false;
+        std::size_t mb = file_size / ( 1024 * 1024);
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("megabytes,m", boost::program_options::value< std::size_t >( & mb), "file size in MB")
+            ("block,k", boost::program_options::value< std::size_t >( & block), "bytes per file read")
+            ("readers,j", boost::program_options::value< std::size_t >( & readers), "concurrent file readers")
+            ("workers,w", boost::program_options::value< std::size_t >( & workers), "threads of the offload pool")
+            ("connections,c", boost::program_options::value< std::size_t >( & connections), "concurrent connections")
+            ("requests,r", boost::program_options::value< std::size_t >( & requests), "requests per connection")
+            ("size,s", boost::program_options::value< std::size_t >( & size), "bytes per request");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
+        if ( bind) bind_to_processor( 0);
+        file_size = mb * 1024 * 1024;
+        if ( 0 == file_size || 0 == block || 0 == readers || 0 == workers || 0 != file_size % block ||
+             0 == connections || 0 == requests || 0 == size)
+            throw std::invalid_argument("invalid arguments");
+
+        // two descriptors per connection
+        rlimit rl;
+        if ( 0 == ::getrlimit( RLIMIT_NOFILE, & rl) && rl.rlim_cur < rl.rlim_max)
+        {
+            rl.rlim_cur = rl.rlim_max;
+            ::setrlimit( RLIMIT_NOFILE, & rl);
+        }
+        ::signal( SIGPIPE, SIG_IGN);
+
+        {
+            boost::coroutines::scheduler sched;
+            boost::coroutines::io_engine e( sched);
+            if ( ! e.uses_io_uring() )
+                std::cout << "io_uring not available, io_backend_auto uses epoll" << std::endl;
+        }
+
+        print_counters_unavailable( std::cout, counters);
+        file_read();
+        socket_ping_pong();
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
+boost::uint64_t jobs = 100000;
+std::size_t contenders = 8;
+perf_counters counters;
+
+void fn_uncontended( boost::coroutines::coroutine_mutex & mtx, duration_type & total)
+{
+    counters.start();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i)
+    {
+        mtx.lock();
+        mtx.unlock();
+    }
+    total = clock_type::now() - start;
+    counters.stop();
+}
+
+void fn_ping( boost::coroutines::counting_semaphore & ping,
+              boost::coroutines::counting_semaphore & pong)
+{
+    for ( std::size_t i = 0; i < jobs; ++i)
+    {
+        pong.release();
+        ping.acquire();
+    }
+}
+
+void fn_pong( boost::coroutines::counting_semaphore & ping,
+              boost::coroutines::counting_semaphore & pong)
+{
+    for ( std::size_t i = 0; i < jobs; ++i)
+    {
+        pong.acquire();
+        ping.release();
+    }
+}
+
+void fn_contender( boost::coroutines::coroutine_mutex & mtx,
+                   boost::uint64_t & total,
+                   boost::uint64_t & acquired)
+{
+    while ( true)
+    {
+        mtx.lock();
+        if ( total == jobs)
+        {
+            mtx.unlock();
+            return;
+        }
+        ++total;
+        ++acquired;
+        // keep the critical section across a suspension so
+        // that the other contenders pile up on the mutex
+        boost::coroutines::this_coroutine::yield();
+        mtx.unlock();
+    }
+}
+
+duration_type measure_uncontended( duration_type overhead)
+{
+    boost::coroutines::coroutine_mutex mtx;
+    duration_type total = duration_type::zero();
+    boost::coroutines::scheduler sched;
+    sched.spawn( boost::bind( fn_uncontended, boost::ref( mtx), boost::ref( total) ),
+                 boost::coroutines::attributes( preserve_fpu) );
+    sched.run();
+    total -= overhead; // overhead of measurement
+    total /= jobs;  // loops
+
+    return total;
+}
+
+duration_type measure_handoff( duration_type overhead)
+{
+    boost::coroutines::counting_semaphore ping, pong;
+    boost::coroutines::scheduler sched;
+    sched.spawn( boost::bind( fn_ping, boost::ref( ping), boost::ref( pong) ),
+                 boost::coroutines::attributes( preserve_fpu) );
+    sched.spawn( boost::bind( fn_pong, boost::ref( ping), boost::ref( pong) ),
+                 boost::coroutines::attributes( preserve_fpu) );
+
+    counters.start();
+    time_point_type start( clock_type::now() );
+    sched.run();
+    duration_type total = clock_type::now() - start;
+    counters.stop();
+    total -= overhead; // overhead of measurement
+    total /= jobs;  // loops
+    total /= 2;  // 2x hand-off
+
+    return total;
+}
+
+void measure_fairness( duration_type overhead)
+{
+    boost::coroutines::coroutine_mutex mtx;
+    boost::uint64_t total = 0;
+    std::vector< boost::uint64_t > acquired( contenders, 0);
+    boost::coroutines::scheduler sched;
+    for ( std::size_t i = 0; i < contenders; ++i)
+        sched.spawn( boost::bind( fn_contender, boost::ref( mtx), boost::ref( total), boost::ref( acquired[i]) ),
+                     boost::coroutines::attributes( preserve_fpu) );
+
+    counters.start();
+    time_point_type start( clock_type::now() );
+    sched.run();
+    duration_type elapsed = clock_type::now() - start;
+    counters.stop();
+    elapsed -= overhead; // overhead of measurement
+    elapsed /= jobs;  // loops
+
+    boost::uint64_t min = * std::min_element( acquired.begin(), acquired.end() );
+    boost::uint64_t max = * std::max_element( acquired.begin(), acquired.end() );
+    std::cout << "contended lock/unlock (" << contenders << " coroutines): average of "
+              << elapsed.count() << " nano seconds" << std::endl;
+    print_counters( std::cout, "contended lock/unlock", counters, jobs, "lock/unlock");
+    std::cout << "fairness: min " << min << ", max " << max
+              << " acquisitions per coroutine" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool preserve = false, bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("contenders,c", boost::program_options::value< std::size_t >( & contenders), "coroutines contending on the mutex")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
+        if ( bind) bind_to_processor( 0);
+
+        duration_type overhead_c = overhead_clock();
+        std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
+        print_counters_unavailable( std::cout, counters);
+        boost::uint64_t res = measure_uncontended( overhead_c).count();
+        std::cout << "uncontended lock/unlock: average of " << res << " nano seconds" << std::endl;
+        print_counters( std::cout, "uncontended lock/unlock", counters, jobs, "lock/unlock");
+        res = measure_handoff( overhead_c).count();
+        std::cout << "semaphore hand-off: average of " << res << " nano seconds" << std::endl;
+        print_counters( std::cout, "semaphore hand-off", counters, 2 * jobs, "hand-off");
+        measure_fairness( overhead_c);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,159 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+namespace coro = boost::coroutines;
+
+std::size_t tasks = 1000;
+std::size_t rounds = 1000;
+perf_counters counters;
+
+// handles of the suspended tasks of one round, taken by the
+// resuming thread once all tasks are suspended
+boost::mutex mtx;
+boost::condition_variable cond;
+std::vector< coro::task_handle > handles;
+
+void suspended( coro::task_handle h)
+{
+    boost::lock_guard< boost::mutex > lk( mtx);
+    handles.push_back( h);
+    if ( tasks == handles.size() ) cond.notify_one();
+}
+
+void worker()
+{
+    for ( std::size_t i = 0; i < rounds; ++i)
+        coro::this_coroutine::suspend_until_resumed( suspended);
+}
+
+// completion callbacks of another thread resume the tasks in bursts
+void resumer()
+{
+    std::vector< coro::task_handle > v;
+    for ( std::size_t i = 0; i < rounds; ++i)
+    {
+        {
+            boost::unique_lock< boost::mutex > lk( mtx);
+            while ( tasks != handles.size() ) cond.wait( lk);
+            v.swap( handles);
+        }
+        for ( std::size_t j = 0; j < v.size(); ++j)
+            coro::resume_on_owner( v[j]);
+        v.clear();
+    }
+}
+
+void reader( coro::reactor & r, int fd)
+{
+    char c = 0;
+    r.async_read( fd, & c, 1);
+}
+
+void spawner( int fd)
+{
+    coro::task_group g;
+    for ( std::size_t i = 0; i < tasks; ++i)
+        g.spawn( worker);
+    g.wait();
+    // wakes the reader
+    if ( 1 != ::write( fd, "x", 1) ) throw std::runtime_error("write() failed");
+}
+
+// with a reactor the scheduler blocks in epoll_wait() and is woken
+// by an eventfd write, otherwise it waits on a condition variable
+double measure( bool polled)
+{
+    handles.clear();
+    handles.reserve( tasks);
+    coro::scheduler sched;
+    coro::reactor r( sched);
+    int fds[2];
+    if ( 0 != ::pipe( fds) ) throw std::runtime_error("pipe() failed");
+    if ( polled)
+    {
+        r.add( fds[0]);
+        sched.spawn( boost::bind( reader, boost::ref( r), fds[0]) );
+    }
+    counters.start();
+    time_point_type start( clock_type::now() );
+    boost::thread t( resumer);
+    sched.spawn( boost::bind( spawner, fds[1]) );
+    sched.run();
+    duration_type elapsed = clock_type::now() - start;
+    t.join();
+    // including the resuming thread, which exited
+    counters.stop();
+    ::close( fds[0]);
+    ::close( fds[1]);
+    return static_cast< double >( elapsed.count() ) / ( tasks * rounds);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("tasks,t", boost::program_options::value< std::size_t >( & tasks), "tasks resumed per burst")
+            ("rounds,r", boost::program_options::value< std::size_t >( & rounds), "bursts");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+        if ( 0 == tasks || 0 == rounds)
+            throw std::invalid_argument("tasks and rounds must not be 0");
+
+        std::cout << "cross-thread resumption, bursts of " << tasks << " tasks:" << std::endl;
+        print_counters_unavailable( std::cout, counters);
+        std::cout << "  condition variable: " << measure( false) << " nano seconds per resumption" << std::endl;
+        print_counters( std::cout, "  condition variable", counters, tasks * rounds, "resumption");
+        std::cout << "  eventfd (reactor):  " << measure( true) << " nano seconds per resumption" << std::endl;
+        print_counters( std::cout, "  eventfd (reactor)", counters, tasks * rounds, "resumption");
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
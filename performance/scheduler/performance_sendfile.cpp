@@ -0,0 +1,224 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+}
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/ref.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+std::size_t megabytes = 256;
+std::size_t files = 8;
+std::size_t chunk = 256 * 1024;
+perf_counters counters;
+
+enum transfer_mode
+{
+    mode_copy = 0,
+    mode_sendfile,
+    mode_splice
+};
+
+// serves the file files times over the socket
+void fn_server( boost::coroutines::reactor & r, int sock, int file, transfer_mode mode)
+{
+    std::size_t size = megabytes * 1024 * 1024;
+    std::vector< char > buf( chunk);
+    int p[2] = { -1, -1 };
+    if ( mode_splice == mode)
+    {
+        if ( 0 != ::pipe2( p, O_NONBLOCK) ) throw std::runtime_error("pipe2() failed");
+        r.add( p[0]);
+        r.add( p[1]);
+    }
+    for ( std::size_t i = 0; i < files; ++i)
+    {
+        switch ( mode)
+        {
+        case mode_copy:
+            // through user space
+            for ( std::size_t off = 0; off < size; off += chunk)
+            {
+                ssize_t n = ::pread( file, & buf[0], chunk, static_cast< off_t >( off) );
+                if ( n <= 0) throw std::runtime_error("pread() failed");
+                r.async_write( sock, & buf[0], static_cast< std::size_t >( n) );
+            }
+            break;
+        case mode_sendfile:
+            if ( size != r.async_sendfile( sock, file, 0, size) )
+                throw std::runtime_error("file truncated");
+            break;
+        case mode_splice:
+            // file -> pipe -> socket
+            {
+                off_t off = 0;
+                if ( -1 == ::lseek( file, 0, SEEK_SET) ) throw std::runtime_error("lseek() failed");
+                while ( static_cast< std::size_t >( off) < size)
+                {
+                    std::size_t n = r.async_splice( file, p[1], chunk);
+                    if ( 0 == n) throw std::runtime_error("file truncated");
+                    off += n;
+                    while ( 0 < n)
+                        n -= r.async_splice( p[0], sock, n);
+                }
+            }
+            break;
+        }
+    }
+    ::shutdown( sock, SHUT_WR);
+    if ( mode_splice == mode)
+    {
+        r.remove( p[0]);
+        r.remove( p[1]);
+        ::close( p[0]);
+        ::close( p[1]);
+    }
+}
+
+// discards the received data without copying it to user space
+void fn_client( boost::coroutines::reactor & r, int sock, int devnull, boost::uint64_t & received)
+{
+    int p[2];
+    if ( 0 != ::pipe2( p, O_NONBLOCK) ) throw std::runtime_error("pipe2() failed");
+    r.add( p[0]);
+    r.add( p[1]);
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_splice( sock, p[1], chunk) ) )
+    {
+        received += n;
+        while ( 0 < n)
+            n -= r.async_splice( p[0], devnull, n);
+    }
+    r.remove( p[0]);
+    r.remove( p[1]);
+    ::close( p[0]);
+    ::close( p[1]);
+}
+
+double cpu_seconds()
+{
+    rusage ru;
+    ::getrusage( RUSAGE_SELF, & ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+        ( ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+void measure( int file, int devnull, transfer_mode mode, char const* name)
+{
+    int fds[2];
+    if ( 0 != ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) )
+        throw std::runtime_error("socketpair() failed");
+    boost::uint64_t received = 0;
+    double cpu = cpu_seconds();
+    counters.start();
+    time_point_type start( clock_type::now() );
+    {
+        boost::coroutines::scheduler sched;
+        boost::coroutines::reactor r( sched);
+        r.add( fds[0]);
+        r.add( fds[1]);
+        sched.spawn( boost::bind( fn_server, boost::ref( r), fds[1], file, mode) );
+        sched.spawn( boost::bind( fn_client, boost::ref( r), fds[0], devnull, boost::ref( received) ) );
+        sched.run();
+    }
+    duration_type elapsed = clock_type::now() - start;
+    counters.stop();
+    cpu = cpu_seconds() - cpu;
+    ::close( fds[0]);
+    ::close( fds[1]);
+    if ( received != static_cast< boost::uint64_t >( files) * megabytes * 1024 * 1024)
+        throw std::runtime_error("data lost");
+
+    double seconds = boost::chrono::duration_cast< boost::chrono::duration< double > >( elapsed).count();
+    double gb = static_cast< double >( received) / ( 1024 * 1024 * 1024);
+    std::cout << name << static_cast< boost::uint64_t >( received / ( 1024 * 1024) / seconds)
+              << " MB/s, " << cpu / gb << " CPU seconds per GB" << std::endl;
+    std::string label( name);
+    label.erase( label.find_last_not_of(" :") + 1);
+    print_counters( std::cout, label, counters, received / ( 1024 * 1024), "MB");
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("megabytes,m", boost::program_options::value< std::size_t >( & megabytes), "size of the file in MB")
+            ("files,f", boost::program_options::value< std::size_t >( & files), "number of times the file is served")
+            ("chunk,c", boost::program_options::value< std::size_t >( & chunk), "bytes per transfer");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+        if ( 0 == megabytes || 0 == files || 0 == chunk)
+            throw std::invalid_argument("megabytes, files and chunk must not be 0");
+        ::signal( SIGPIPE, SIG_IGN);
+
+        // served from the page cache
+        char path[] = "/tmp/performance_sendfile_XXXXXX";
+        int file = ::mkstemp( path);
+        if ( -1 == file) throw std::runtime_error("mkstemp() failed");
+        ::unlink( path);
+        std::vector< char > block( 1024 * 1024, 'x');
+        for ( std::size_t i = 0; i < megabytes; ++i)
+            if ( static_cast< ssize_t >( block.size() ) != ::write( file, & block[0], block.size() ) )
+                throw std::runtime_error("write() failed");
+        int devnull = ::open( "/dev/null", O_WRONLY);
+        if ( -1 == devnull) throw std::runtime_error("open() failed");
+
+        print_counters_unavailable( std::cout, counters);
+        std::cout << "serving a " << megabytes << " MB file " << files << " times over a local socket:" << std::endl;
+        measure( file, devnull, mode_copy,     "  pread + async_write:     ");
+        measure( file, devnull, mode_sendfile, "  async_sendfile:          ");
+        measure( file, devnull, mode_splice,   "  async_splice (via pipe): ");
+
+        ::close( devnull);
+        ::close( file);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
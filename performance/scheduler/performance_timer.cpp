@@ -0,0 +1,153 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counters.hpp"
+
+typedef boost::coroutines::detail::clock_type       timer_clock_type;
+
+std::size_t timers = 1000000;
+std::size_t seconds = 60;
+std::size_t expired = 0;
+perf_counters counters;
+
+void fn_expired( boost::coroutines::detail::timer_node *)
+{ ++expired; }
+
+// deadlines spread uniformly over the period, in a scrambled order
+void init( std::vector< boost::coroutines::detail::timer_node > & nodes,
+           timer_clock_type::time_point const& start)
+{
+    boost::uint64_t span = static_cast< boost::uint64_t >( seconds) * 1000000;
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        nodes[i].deadline = start + boost::chrono::microseconds(
+                ( static_cast< boost::uint64_t >( i) * 2654435761u) % span);
+        nodes[i].fn = fn_expired;
+    }
+}
+
+double per_op( duration_type elapsed, std::size_t n)
+{ return static_cast< double >( elapsed.count() ) / n; }
+
+void measure()
+{
+    std::vector< boost::coroutines::detail::timer_node > nodes( timers);
+    boost::coroutines::detail::timer_queue q;
+    timer_clock_type::time_point start( timer_clock_type::now() );
+    init( nodes, start);
+
+    // written after the latencies
+    std::ostringstream events;
+
+    counters.start();
+    time_point_type t0( clock_type::now() );
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+        q.push( & nodes[i]);
+    duration_type push = clock_type::now() - t0;
+    counters.stop();
+    print_counters( events, "  push", counters, timers, "deadline");
+
+    counters.start();
+    t0 = clock_type::now();
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+        q.erase( & nodes[i]);
+    duration_type erase = clock_type::now() - t0;
+    counters.stop();
+    print_counters( events, "  erase", counters, timers, "deadline");
+
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+        q.push( & nodes[i]);
+    // the clock advances in steps of one millisecond over the
+    // whole period, as a scheduler waking up each tick would
+    std::size_t steps = 0;
+    counters.start();
+    t0 = clock_type::now();
+    for ( timer_clock_type::time_point now( start); ! q.empty(); now += boost::chrono::milliseconds( 1) )
+    {
+        q.expire( now);
+        ++steps;
+    }
+    duration_type expire = clock_type::now() - t0;
+    counters.stop();
+    print_counters( events, "  expire", counters, timers, "deadline");
+    if ( expired != timers) throw std::runtime_error("timers lost");
+
+    // idle: pending deadlines far in the future
+    init( nodes, start + boost::chrono::hours( 1) );
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+        q.push( & nodes[i]);
+    std::size_t idle = 100000;
+    counters.start();
+    t0 = clock_type::now();
+    for ( std::size_t i = 0; i < idle; ++i)
+        q.expire( start + boost::chrono::microseconds( i) );
+    duration_type idle_expire = clock_type::now() - t0;
+    counters.stop();
+    print_counters( events, "  idle", counters, idle, "wakeup");
+
+    std::cout << timers << " deadlines over " << seconds << " seconds:" << std::endl;
+    std::cout << "  push:    " << per_op( push, timers) << " nano seconds per deadline" << std::endl;
+    std::cout << "  erase:   " << per_op( erase, timers) << " nano seconds per deadline" << std::endl;
+    std::cout << "  expire:  " << per_op( expire, timers) << " nano seconds per deadline ("
+              << steps << " ticks)" << std::endl;
+    std::cout << "  idle:    " << per_op( idle_expire, idle) << " nano seconds per wakeup ("
+              << q.size() << " deadlines pending)" << std::endl;
+    print_counters_unavailable( std::cout, counters);
+    std::cout << events.str();
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("timers,t", boost::program_options::value< std::size_t >( & timers), "pending deadlines")
+            ("seconds,s", boost::program_options::value< std::size_t >( & seconds), "deadlines spread over seconds");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+        if ( 0 == timers || 0 == seconds)
+            throw std::invalid_argument("timers and seconds must not be 0");
+
+        measure();
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 #include <boost/chrono.hpp>
 #include <boost/coroutine/all.hpp>
@@ -16,6 +17,8 @@
 #include "../bind_processor.hpp"
 #include "../clock.hpp"
 #include "../cycle.hpp"
+#include "../latency.hpp"
+#include "../perf_counters.hpp"
 #include "../preallocated_stack_allocator.hpp"
 
 typedef preallocated_stack_allocator                       stack_allocator;
@@ -24,6 +27,8 @@ typedef boost::coroutines::symmetric_coroutine< void >     coro_type;
 boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::coroutines::flag_unwind_t unwind_stack = boost::coroutines::stack_unwind;
 boost::uint64_t jobs = 1000;
+boost::uint64_t warmup = 1000;
+std::size_t repetitions = 5;
 
 void fn( coro_type::yield_type &) {}
 
@@ -62,18 +67,52 @@ cycle_type measure_cycles( cycle_type overhead)
 }
 # endif
 
+void measure_latency( latency_report & report)
+{
+    stack_allocator stack_alloc;
+
+    measure_create_destroy< coro_type::call_type >( report, fn,
+        boost::coroutines::attributes( unwind_stack, preserve_fpu), stack_alloc,
+        warmup, jobs, repetitions);
+}
+
+// creates and destroys a coroutine
+struct create_destroy
+{
+    stack_allocator &   stack_alloc;
+
+    void operator()()
+    {
+        coro_type::call_type c( fn,
+            boost::coroutines::attributes( unwind_stack, preserve_fpu), stack_alloc);
+    }
+};
+
+void measure_counters( perf_counters & counters)
+{
+    stack_allocator stack_alloc;
+    create_destroy cd = { stack_alloc };
+
+    count_events( counters, cd, warmup, jobs);
+    print_counters( std::cout, "create and destroy", counters, jobs, "coroutine");
+}
+
 int main( int argc, char * argv[])
 {
     try
     {
         bool preserve = false, unwind = true, bind = false;
+        std::string fmt("text");
         boost::program_options::options_description desc("allowed options");
         desc.add_options()
             ("help", "help message")
             ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
             ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
             ("unwind,u", boost::program_options::value< bool >( & unwind), "unwind coroutine-stack")
-            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run")
+            ("warmup,w", boost::program_options::value< boost::uint64_t >( & warmup), "jobs to run before measuring")
+            ("repetitions,r", boost::program_options::value< std::size_t >( & repetitions), "repetitions of the latency measurement")
+            ("format", boost::program_options::value< std::string >( & fmt), "latencies as text, json or csv");
 
         boost::program_options::variables_map vm;
         boost::program_options::store(
@@ -92,6 +131,15 @@ int main( int argc, char * argv[])
         if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
         if ( ! unwind) unwind_stack = boost::coroutines::no_stack_unwind;
         if ( bind) bind_to_processor( 0);
+        output_format format = parse_format( fmt);
+
+        latency_report report("symmetric create prealloc");
+        measure_latency( report);
+        if ( output_text != format)
+        {
+            report.write( std::cout, format);
+            return EXIT_SUCCESS;
+        }
 
         duration_type overhead_c = overhead_clock();
         std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
@@ -103,6 +151,10 @@ int main( int argc, char * argv[])
         res = measure_cycles( overhead_y);
         std::cout << "average of " << res << " cpu cycles" << std::endl;
 #endif
+        report.write( std::cout, format);
+        perf_counters counters;
+        print_counters_unavailable( std::cout, counters);
+        measure_counters( counters);
 
         return EXIT_SUCCESS;
     }
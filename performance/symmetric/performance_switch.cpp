@@ -17,9 +17,13 @@
 #include "../bind_processor.hpp"
 #include "../clock.hpp"
 #include "../cycle.hpp"
+#include "../latency.hpp"
+#include "../perf_counters.hpp"
 
 boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::uint64_t jobs = 1000;
+boost::uint64_t warmup = 1000;
+std::size_t repetitions = 5;
 time_point_type end;
 
 struct X
@@ -149,17 +153,74 @@ cycle_type measure_cycles_x( cycle_type overhead)
 }
 # endif
 
+// resumes `c` passing `arg`
+template< typename Coro, typename Arg >
+struct resume_with
+{
+    Coro    &   c;
+    Arg         arg;
+
+    resume_with( Coro & c_, Arg const& arg_) :
+        c( c_), arg( arg_)
+    {}
+
+    void operator()()
+    { c( arg); }
+};
+
+void measure_latency( latency_report & report)
+{
+    boost::coroutines::symmetric_coroutine< void >::call_type c_void( fn_void,
+            boost::coroutines::attributes( preserve_fpu) );
+    measure_switch( report, "void", c_void, warmup, jobs, repetitions);
+
+    boost::coroutines::symmetric_coroutine< int >::call_type c_int( fn_int,
+            boost::coroutines::attributes( preserve_fpu) );
+    resume_with< boost::coroutines::symmetric_coroutine< int >::call_type, int > r_int( c_int, 7);
+    measure_switch( report, "int", r_int, warmup, jobs, repetitions);
+
+    boost::coroutines::symmetric_coroutine< X >::call_type c_x( fn_x,
+            boost::coroutines::attributes( preserve_fpu) );
+    resume_with< boost::coroutines::symmetric_coroutine< X >::call_type, X > r_x( c_x, x);
+    measure_switch( report, "X", r_x, warmup, jobs, repetitions);
+}
+
+void measure_counters( perf_counters & counters)
+{
+    // a resumption is two switches
+    boost::coroutines::symmetric_coroutine< void >::call_type c_void( fn_void,
+            boost::coroutines::attributes( preserve_fpu) );
+    count_events( counters, c_void, warmup, jobs);
+    print_counters( std::cout, "void", counters, 2 * jobs, "switch");
+
+    boost::coroutines::symmetric_coroutine< int >::call_type c_int( fn_int,
+            boost::coroutines::attributes( preserve_fpu) );
+    resume_with< boost::coroutines::symmetric_coroutine< int >::call_type, int > r_int( c_int, 7);
+    count_events( counters, r_int, warmup, jobs);
+    print_counters( std::cout, "int", counters, 2 * jobs, "switch");
+
+    boost::coroutines::symmetric_coroutine< X >::call_type c_x( fn_x,
+            boost::coroutines::attributes( preserve_fpu) );
+    resume_with< boost::coroutines::symmetric_coroutine< X >::call_type, X > r_x( c_x, x);
+    count_events( counters, r_x, warmup, jobs);
+    print_counters( std::cout, "X", counters, 2 * jobs, "switch");
+}
+
 int main( int argc, char * argv[])
 {
     try
     {
         bool preserve = false, bind = false;
+        std::string fmt("text");
         boost::program_options::options_description desc("allowed options");
         desc.add_options()
             ("help", "help message")
             ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
             ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
-            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run")
+            ("warmup,w", boost::program_options::value< boost::uint64_t >( & warmup), "jobs to run before measuring")
+            ("repetitions,r", boost::program_options::value< std::size_t >( & repetitions), "repetitions of the latency measurement")
+            ("format", boost::program_options::value< std::string >( & fmt), "latencies as text, json or csv");
 
         boost::program_options::variables_map vm;
         boost::program_options::store(
@@ -177,7 +238,22 @@ int main( int argc, char * argv[])
 
         if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
         if ( bind) bind_to_processor( 0);
+        output_format format = parse_format( fmt);
+
+        latency_report report("symmetric switch");
+        measure_latency( report);
+        if ( output_text != format)
+        {
+            report.write( std::cout, format);
+            return EXIT_SUCCESS;
+        }
 
+#if defined(BOOST_COROUTINES_ACCOUNTING)
+        std::cout << "resume counters and on-CPU time enabled" << std::endl;
+#endif
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+        std::cout << "runtime hooks compiled in, none installed" << std::endl;
+#endif
         duration_type overhead_c = overhead_clock();
         std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
         boost::uint64_t res = measure_time_void( overhead_c).count();
@@ -196,6 +272,10 @@ int main( int argc, char * argv[])
         res = measure_cycles_x( overhead_y);
         std::cout << "X: average of " << res << " cpu cycles" << std::endl;
 #endif
+        report.write( std::cout, format);
+        perf_counters counters;
+        print_counters_unavailable( std::cout, counters);
+        measure_counters( counters);
 
         return EXIT_SUCCESS;
     }
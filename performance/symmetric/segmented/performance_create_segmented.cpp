@@ -16,6 +16,7 @@
 #include "../../bind_processor.hpp"
 #include "../../clock.hpp"
 #include "../../cycle.hpp"
+#include "../../perf_counters.hpp"
 
 boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::coroutines::flag_unwind_t unwind_stack = boost::coroutines::stack_unwind;
@@ -53,6 +54,19 @@ cycle_type measure_cycles( cycle_type overhead)
 }
 # endif
 
+void create_destroy()
+{
+    boost::coroutines::symmetric_coroutine< void >::call_type c( fn,
+            boost::coroutines::attributes( unwind_stack, preserve_fpu) );
+}
+
+void measure_counters( perf_counters & counters)
+{
+    // warmed up by the measurements before
+    count_events( counters, create_destroy, 0, jobs);
+    print_counters( std::cout, "create and destroy", counters, jobs, "coroutine");
+}
+
 int main( int argc, char * argv[])
 {
     try
@@ -94,6 +108,9 @@ int main( int argc, char * argv[])
         res = measure_cycles( overhead_y);
         std::cout << "average of " << res << " cpu cycles" << std::endl;
 #endif
+        perf_counters counters;
+        print_counters_unavailable( std::cout, counters);
+        measure_counters( counters);
 
         return EXIT_SUCCESS;
     }
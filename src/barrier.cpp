@@ -0,0 +1,76 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/barrier.hpp"
+
+#include <boost/thread/locks.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+bool
+barrier::arrive_and_wait()
+{
+    scheduler * sched = 0;
+    detail::task_base * self = 0;
+    detail::task_base * chain = 0;
+    {
+        lock_guard< detail::spinlock > lk( lock_);
+        if ( 0 == --count_)
+        {
+            // start the next phase before the waiters run - they
+            // might arrive at the barrier again
+            count_ = initial_;
+            chain = scheduler::detach( waiters_);
+        }
+        else
+        {
+            sched = scheduler::instance();
+            BOOST_ASSERT( 0 != sched);
+            self = sched->active();
+            BOOST_ASSERT( 0 != self);
+            waiters_.push( self);
+            sched->expect_remote();
+        }
+    }
+    if ( 0 == self)
+    {
+        // the waiters might destroy the barrier from here on
+        scheduler::wake( chain);
+        return true;
+    }
+    try
+    { sched->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        bool woken = false;
+        {
+            lock_guard< detail::spinlock > lk( lock_);
+            // withdraw the arrival if the phase is not complete
+            if ( waiters_.contains( self) )
+            {
+                waiters_.erase( self);
+                sched->withdraw_remote();
+                ++count_;
+            }
+            else woken = true;
+        }
+        if ( woken) sched->join_remote();
+        throw;
+    }
+    return false;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
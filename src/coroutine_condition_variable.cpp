@@ -0,0 +1,50 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/coroutine_condition_variable.hpp"
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+void
+coroutine_condition_variable::suspend_( detail::task_base * self)
+{
+    try
+    { self->owner()->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        if ( waiters_.contains( self) ) waiters_.erase( self);
+        throw;
+    }
+}
+
+void
+coroutine_condition_variable::notify_one() BOOST_NOEXCEPT
+{
+    detail::task_base * t = waiters_.pop();
+    if ( 0 != t) t->owner()->schedule( t);
+}
+
+void
+coroutine_condition_variable::notify_all() BOOST_NOEXCEPT
+{
+    while ( ! waiters_.empty() )
+    {
+        detail::task_base * t = waiters_.pop();
+        t->owner()->schedule( t);
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
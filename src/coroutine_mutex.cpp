@@ -0,0 +1,50 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/coroutine_mutex.hpp"
+
+#include <boost/assert.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+void
+coroutine_mutex::lock_slow_( detail::task_base * self)
+{
+    waiters_.push( self);
+    try
+    { self->owner()->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        // unwound while waiting or before the handed-over
+        // ownership could be used
+        if ( waiters_.contains( self) ) waiters_.erase( self);
+        else if ( owner_ == self) unlock();
+        throw;
+    }
+    BOOST_ASSERT( owner_ == self);
+}
+
+void
+coroutine_mutex::unlock_slow_() BOOST_NOEXCEPT
+{
+    // hand-off to the longest waiting task: it owns the mutex
+    // before it gets resumed, no other task can barge in
+    detail::task_base * t = waiters_.pop();
+    owner_ = t;
+    t->owner()->schedule( t);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,47 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/counting_semaphore.hpp"
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+void
+counting_semaphore::acquire_slow_( detail::task_base * self)
+{
+    waiters_.push( self);
+    try
+    { self->owner()->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        // give back a unit handed-over but not consumed
+        if ( waiters_.contains( self) ) waiters_.erase( self);
+        else release();
+        throw;
+    }
+}
+
+void
+counting_semaphore::release( std::size_t n) BOOST_NOEXCEPT
+{
+    for ( ; 0 < n && ! waiters_.empty(); --n)
+    {
+        detail::task_base * t = waiters_.pop();
+        t->owner()->schedule( t);
+    }
+    count_ += n;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
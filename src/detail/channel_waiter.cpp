@@ -0,0 +1,45 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/detail/channel_waiter.hpp"
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+channel_op_status
+channel_wait( waiter_list & l, void * value)
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    task_base * self = sched->active();
+    BOOST_ASSERT( 0 != self);
+
+    select_state state( self);
+    channel_waiter w( & state, 0, value);
+    l.push( & w);
+    try
+    { sched->suspend(); }
+    catch ( forced_unwind const&)
+    {
+        if ( w.is_linked() ) l.erase( & w);
+        throw;
+    }
+    BOOST_ASSERT( state.is_fired() );
+    BOOST_ASSERT( ! w.is_linked() );
+    return state.status;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -6,6 +6,11 @@
 
 #include "boost/coroutine/detail/coroutine_context.hpp"
 
+#include <boost/atomic.hpp>
+
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/detail/watchdog.hpp>
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
 #endif
@@ -28,6 +33,75 @@ void __splitstack_setcontext( void * [BOOST_COROUTINES_SEGMENTS]);
 namespace boost {
 namespace coroutines {
 namespace detail {
+
+namespace {
+
+BOOST_COROUTINES_THREAD_LOCAL coroutine_context * active_ = 0;
+BOOST_COROUTINES_THREAD_LOCAL unsigned int active_epoch_ = 0;
+
+// users of active() (profiler, watchdog) - without one the switch
+// path costs a relaxed load and a branch
+atomic< unsigned int > trackers_( 0);
+// advanced by each track_active( true): a context recorded in an
+// earlier period might have been destroyed since
+atomic< unsigned int > epoch_( 0);
+
+// not inlined: a coroutine may continue on another thread, the address
+// of a thread-local must not be reused across a jump
+BOOST_NOINLINE void set_active_( coroutine_context * ctx, unsigned int epoch) BOOST_NOEXCEPT
+{
+    active_ = ctx;
+    active_epoch_ = epoch;
+}
+
+BOOST_NOINLINE void save_active_( coroutine_context ** ctx, unsigned int * epoch) BOOST_NOEXCEPT
+{
+    * ctx = active_;
+    * epoch = active_epoch_;
+}
+
+#if defined(BOOST_COROUTINES_HAS_ENTRY_FRAME)
+// the coroutine entered the first time, read by entry_frame()
+BOOST_COROUTINES_THREAD_LOCAL coroutine_context * entering_ = 0;
+#endif
+
+atomic< bool > parent_link_( false);
+
+// frame of the resumer of a coroutine not entered yet
+BOOST_COROUTINES_THREAD_LOCAL void * parent_[2] = { 0, 0 };
+
+#if defined(BOOST_COROUTINES_HAS_WATCHDOG)
+BOOST_COROUTINES_THREAD_LOCAL watch_slot * watched_ = 0;
+
+// the only store of the watchdog on the way into a coroutine: the time
+// the coroutine entered starts to hold the thread
+inline void watch_( coroutine_context & ctx) BOOST_NOEXCEPT
+{
+    watch_slot * w = watched_;
+    if ( 0 == w)
+    {
+        if ( ! watch_on.load( memory_order_relaxed) ) return;
+        w = watched_ = watch_thread();
+        if ( 0 == w) return;
+    }
+    w->resumed.store( watch_clock.load( memory_order_relaxed), memory_order_relaxed);
+}
+
+inline uint64_t watched_since_() BOOST_NOEXCEPT
+{
+    watch_slot * w = watched_;
+    return 0 != w ? w->resumed.load( memory_order_relaxed) : 0;
+}
+
+// not inlined, see set_active_()
+BOOST_NOINLINE void watch_restore_( uint64_t resumed) BOOST_NOEXCEPT
+{
+    watch_slot * w = watched_;
+    if ( 0 != w) w->resumed.store( resumed, memory_order_relaxed);
+}
+#endif
+
+}
 #ifdef BOOST_COROUTINE_USE_FIBER
 VOID WINAPI coroutine_context::fb_start_proc(LPVOID lpFiberParameter)
 {
@@ -39,7 +113,9 @@ VOID WINAPI coroutine_context::fb_start_proc(LPVOID lpFiberParameter)
 
 coroutine_context::coroutine_context() :
     stack_ctx_(),
-    ctx_( 0)
+    ctx_( 0),
+    label_( 0),
+    entry_( 0)
 {
 #if defined(BOOST_USE_SEGMENTED_STACKS)
     __splitstack_getcontext( stack_ctx_.segments_ctx);
@@ -55,16 +131,21 @@ coroutine_context::coroutine_context( ctx_fn fn, stack_context const& stack_ctx)
 #ifndef BOOST_COROUTINE_USE_FIBER
     , ctx_(context::make_fcontext( stack_ctx_.sp, stack_ctx_.size, fn) )
 #endif // !BOOST_COROUTINE_USE_FIBER
+    , label_( 0)
+    , entry_( 0)
 {
 #ifdef BOOST_COROUTINE_USE_FIBER
     fn_ = fn;
     fiber_ = CreateFiber(0, fb_start_proc, this);
 #endif // BOOST_COROUTINE_USE_FIBER
+    BOOST_COROUTINES_PROBE3( create, this, stack_ctx_.sp, stack_ctx_.size);
 }
 
 coroutine_context::coroutine_context( coroutine_context const& other) :
     stack_ctx_( other.stack_ctx_),
-    ctx_( other.ctx_)
+    ctx_( other.ctx_),
+    label_( other.label_),
+    entry_( other.entry_)
 {
 #ifdef BOOST_COROUTINE_USE_FIBER
     fn_ = other.fn_;
@@ -80,6 +161,8 @@ coroutine_context::operator=( coroutine_context const& other)
 
     stack_ctx_ = other.stack_ctx_;
     ctx_ = other.ctx_;
+    label_ = other.label_;
+    entry_ = other.entry_;
 #ifdef BOOST_COROUTINE_USE_FIBER
     fn_ = other.fn_;
     fiber_ = other.fiber_;
@@ -91,6 +174,38 @@ coroutine_context::operator=( coroutine_context const& other)
 intptr_t
 coroutine_context::jump( coroutine_context & other, intptr_t param, bool preserve_fpu)
 {
+#if defined(__GNUC__) && ! defined(BOOST_COROUTINE_USE_FIBER)
+    if ( parent_link_.load( memory_order_relaxed) )
+    {
+        // the coroutine continues as if called from the caller of jump()
+        void ** frame = other.entry_;
+        if ( 0 == frame) frame = parent_;
+        frame[0] = * static_cast< void ** >( __builtin_frame_address( 0) );
+        frame[1] = __builtin_return_address( 0);
+    }
+#endif
+    BOOST_COROUTINES_PROBE3( switch_out, this, & other, __builtin_frame_address( 0) );
+    BOOST_COROUTINES_PROBE3( switch_in, & other, this, other.ctx_);
+    // a context without stack (the thread, the resumer of a coroutine)
+    // jumps on the stack of the context resumed last - the state of
+    // the watchdog and the profiler is restored when control returns;
+    // a context with stack is recorded by the side resuming it
+    bool resumer = 0 == stack_ctx_.sp;
+    bool entered = 0 != other.stack_ctx_.sp;
+#if defined(BOOST_COROUTINES_HAS_WATCHDOG)
+    uint64_t resumed = resumer ? watched_since_() : 0;
+    if ( entered) watch_( other);
+#endif
+#if defined(BOOST_COROUTINES_HAS_ENTRY_FRAME)
+    if ( entered && 0 == other.entry_) entering_ = & other;
+#endif
+    coroutine_context * active = 0;
+    unsigned int epoch = 0;
+    if ( 0 != trackers_.load( memory_order_relaxed) )
+    {
+        if ( resumer) save_active_( & active, & epoch);
+        if ( entered) set_active_( & other, epoch_.load( memory_order_relaxed) );
+    }
 #if defined(BOOST_USE_SEGMENTED_STACKS)
     __splitstack_getcontext( stack_ctx_.segments_ctx);
     __splitstack_setcontext( other.stack_ctx_.segments_ctx);
@@ -98,8 +213,6 @@ coroutine_context::jump( coroutine_context & other, intptr_t param, bool preserv
     intptr_t ret = context::jump_fcontext( & ctx_, other.ctx_, param, preserve_fpu);
 
     __splitstack_setcontext( stack_ctx_.segments_ctx);
-
-    return ret;
 #elif defined(BOOST_COROUTINE_USE_FIBER)
     other.param_ = param;
 #ifdef BOOST_COROUTINE_USE_IS_THREAD_A_FIBER
@@ -116,9 +229,84 @@ coroutine_context::jump( coroutine_context & other, intptr_t param, bool preserv
         this->fiber_ = GetCurrentFiber();
         SwitchToFiber(other.fiber_);
     }
-    return this->param_;
+    intptr_t ret = this->param_;
+#else
+    intptr_t ret = context::jump_fcontext( & ctx_, other.ctx_, param, preserve_fpu);
+#endif
+    if ( resumer)
+    {
+#if defined(BOOST_COROUTINES_HAS_WATCHDOG)
+        watch_restore_( resumed);
+#endif
+        // tracking started during the jump: nothing was saved, the
+        // epoch 0 is never current
+        if ( 0 != trackers_.load( memory_order_relaxed) ) set_active_( active, epoch);
+    }
+    return ret;
+}
+
+coroutine_context *
+coroutine_context::active() BOOST_NOEXCEPT
+{
+    if ( 0 == trackers_.load( memory_order_relaxed) ||
+         active_epoch_ != epoch_.load( memory_order_relaxed) )
+        return 0;
+    return active_;
+}
+
+void
+coroutine_context::track_active( bool track) BOOST_NOEXCEPT
+{
+    if ( track)
+    {
+        epoch_.fetch_add( 1, memory_order_relaxed);
+        trackers_.fetch_add( 1, memory_order_release);
+    }
+    else
+    {
+        BOOST_ASSERT( 0 < trackers_.load( memory_order_relaxed) );
+        trackers_.fetch_sub( 1, memory_order_release);
+    }
+}
+
+#if defined(BOOST_COROUTINES_HAS_ENTRY_FRAME)
+void
+coroutine_context::entry_frame( void ** frame) BOOST_NOEXCEPT
+{
+    coroutine_context * ctx = entering_;
+    BOOST_ASSERT( 0 != ctx);
+
+    // the trampoline never returns - its frame may be rewritten
+    ctx->entry_ = frame;
+    if ( parent_link_.load( memory_order_relaxed) )
+    {
+        frame[0] = parent_[0];
+        frame[1] = parent_[1];
+    }
+    else
+        frame[0] = frame[1] = 0;
+}
+#endif
+
+void
+coroutine_context::link_parent( bool link) BOOST_NOEXCEPT
+{ parent_link_.store( link, memory_order_relaxed); }
+
+bool
+coroutine_context::parent_linked() BOOST_NOEXCEPT
+{ return parent_link_.load( memory_order_relaxed); }
+
+std::size_t
+coroutine_context::stack_used() const
+{
+#if defined(BOOST_COROUTINE_USE_FIBER) || defined(BOOST_USE_SEGMENTED_STACKS)
+    return 0;
 #else
-    return context::jump_fcontext( & ctx_, other.ctx_, param, preserve_fpu);
+    // a suspended coroutine has saved its registers on its stack
+    char const* top = static_cast< char const* >( stack_ctx_.sp);
+    char const* sp = reinterpret_cast< char const* >( ctx_);
+    if ( 0 == top || sp > top || sp < top - stack_ctx_.size) return 0;
+    return static_cast< std::size_t >( top - sp);
 #endif
 }
 
@@ -0,0 +1,386 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/fork_join_pool.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/coroutine/detail/chase_lev_deque.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+struct fork_join_worker : private noncopyable
+{
+    // executed by the context resumed next, after the
+    // context of the suspending task has been saved
+    enum action_t
+    {
+        action_none = 0,
+        action_push,
+        action_sync,
+        action_release
+    };
+
+    fork_join_pool                      *   pool;
+    std::size_t                             index;
+    coroutine_context                       ctx;
+    chase_lev_deque< fork_join_task >       deque;
+    fork_join_task                      *   current;
+    action_t                                action;
+    fork_join_task                      *   action_task;
+    std::vector< stack_context >            stacks;
+    std::size_t                             stack_size;
+    bool                                    preserve_fpu;
+    uint32_t                                seed;
+
+    fork_join_worker( fork_join_pool * pool_, std::size_t index_,
+                      attributes const& attrs, std::size_t max_stacks) :
+        pool( pool_),
+        index( index_),
+        ctx(),
+        deque(),
+        current( 0),
+        action( action_none),
+        action_task( 0),
+        stacks(),
+        stack_size( attrs.size),
+        preserve_fpu( fpu_preserved == attrs.preserve_fpu),
+        seed( static_cast< uint32_t >( index_ + 1) * 2654435761U)
+    { stacks.reserve( max_stacks); }
+
+    ~fork_join_worker()
+    {
+        stack_allocator alloc;
+        for ( std::size_t i = 0; i < stacks.size(); ++i)
+            alloc.deallocate( stacks[i]);
+    }
+
+    // xorshift32 - victim selection
+    uint32_t random() BOOST_NOEXCEPT
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+};
+
+}
+
+namespace {
+
+// stacks kept per worker for reuse by spawn()
+const std::size_t max_cached_stacks = 64;
+
+// spins of an idle worker before it yields its time-slice
+const std::size_t idle_spins = 64;
+
+BOOST_COROUTINES_THREAD_LOCAL detail::fork_join_worker * current_worker_ = 0;
+
+}
+
+fork_join_pool::fork_join_pool( std::size_t workers, attributes const& attrs) :
+    workers_(),
+    threads_(),
+    attrs_( attrs),
+    mtx_(),
+    cond_(),
+    inject_(),
+    active_( 0),
+    stop_( false)
+{
+    if ( 0 == workers) workers = 1;
+    try
+    {
+        for ( std::size_t i = 0; i < workers; ++i)
+            workers_.push_back(
+                new detail::fork_join_worker( this, i, attrs_, max_cached_stacks) );
+        for ( std::size_t i = 0; i < workers; ++i)
+            threads_.create_thread( bind( & fork_join_pool::loop_, this, workers_[i]) );
+    }
+    catch (...)
+    {
+        {
+            lock_guard< mutex > lk( mtx_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        threads_.join_all();
+        for ( std::size_t i = 0; i < workers_.size(); ++i)
+            delete workers_[i];
+        throw;
+    }
+}
+
+fork_join_pool::~fork_join_pool()
+{
+    {
+        lock_guard< mutex > lk( mtx_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    threads_.join_all();
+    BOOST_ASSERT( inject_.empty() );
+    for ( std::size_t i = 0; i < workers_.size(); ++i)
+        delete workers_[i];
+}
+
+// not inlined: a task might continue on another thread after
+// a context switch, the address of the thread-local variable
+// must not be cached across a switch
+BOOST_NOINLINE
+detail::fork_join_worker *
+fork_join_pool::worker_() BOOST_NOEXCEPT
+{ return current_worker_; }
+
+detail::fork_join_task *
+fork_join_pool::post_( detail::fork_join_worker * w)
+{
+    detail::fork_join_worker::action_t action = w->action;
+    detail::fork_join_task * t = w->action_task;
+    w->action = detail::fork_join_worker::action_none;
+    w->action_task = 0;
+    switch ( action)
+    {
+    case detail::fork_join_worker::action_push:
+        // continuation of the parent becomes stealable
+        w->deque.push( t);
+        break;
+    case detail::fork_join_worker::action_sync:
+        // drop the token of the task waiting in sync(); if all
+        // children are already complete resume it immediately
+        if ( 1 == t->join_.fetch_sub( 1, memory_order_acq_rel) ) return t;
+        break;
+    case detail::fork_join_worker::action_release:
+        t->destroy();
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+void
+fork_join_pool::entry_( intptr_t vp)
+{
+    detail::fork_join_task * t( reinterpret_cast< detail::fork_join_task * >( vp) );
+    BOOST_ASSERT( 0 != t);
+
+    detail::fork_join_task * r = post_( worker_() );
+    BOOST_ASSERT( 0 == r);
+    ( void) r;
+    t->run();
+}
+
+bool
+fork_join_pool::allocate_( stack_context & stack_ctx)
+{
+    detail::fork_join_worker * w = worker_();
+    BOOST_ASSERT_MSG( 0 != w, "not called from inside a fork_join_pool");
+
+    if ( ! w->stacks.empty() )
+    {
+        stack_ctx = w->stacks.back();
+        w->stacks.pop_back();
+    }
+    else
+        stack_allocator().allocate( stack_ctx, w->stack_size);
+    return w->preserve_fpu;
+}
+
+void
+fork_join_pool::deallocate_( stack_context & stack_ctx) BOOST_NOEXCEPT
+{
+    detail::fork_join_worker * w = worker_();
+    if ( 0 != w && w->stacks.size() < max_cached_stacks)
+        w->stacks.push_back( stack_ctx);
+    else
+        stack_allocator().deallocate( stack_ctx);
+}
+
+void
+fork_join_pool::spawn_( detail::fork_join_task * child)
+{
+    detail::fork_join_worker * w = worker_();
+    BOOST_ASSERT_MSG( 0 != w, "not called from inside a fork_join_pool");
+    detail::fork_join_task * self = w->current;
+    BOOST_ASSERT( 0 != self);
+
+    child->parent_ = self;
+    self->join_.fetch_add( 1, memory_order_relaxed);
+    // the child pushes the continuation of self to the deque
+    // as soon as the context of self has been saved
+    w->action = detail::fork_join_worker::action_push;
+    w->action_task = self;
+    w->current = child;
+    self->ctx_.jump( child->ctx_, reinterpret_cast< intptr_t >( child), child->preserve_fpu() );
+    // resumed by this or by a stealing worker
+    detail::fork_join_task * r = post_( worker_() );
+    BOOST_ASSERT( 0 == r);
+    ( void) r;
+}
+
+void
+fork_join_pool::wait_( detail::fork_join_task * self) BOOST_NOEXCEPT
+{
+    if ( 1 == self->join_.load( memory_order_acquire) ) return;
+
+    detail::fork_join_worker * w = worker_();
+    w->action = detail::fork_join_worker::action_sync;
+    w->action_task = self;
+    w->current = 0;
+    self->ctx_.jump( w->ctx, 0, self->preserve_fpu() );
+    // resumed by the worker completing the last child
+    detail::fork_join_task * r = post_( worker_() );
+    BOOST_ASSERT( 0 == r);
+    ( void) r;
+    self->join_.store( 1, memory_order_relaxed);
+}
+
+void
+fork_join_pool::sync()
+{
+    detail::fork_join_worker * w = worker_();
+    BOOST_ASSERT_MSG( 0 != w, "not called from inside a fork_join_pool");
+    detail::fork_join_task * self = w->current;
+    BOOST_ASSERT( 0 != self);
+
+    wait_( self);
+    if ( self->failed_.load( memory_order_acquire) )
+    {
+        exception_ptr except( self->except_);
+        self->except_ = exception_ptr();
+        self->failed_.store( false, memory_order_relaxed);
+        rethrow_exception( except);
+    }
+}
+
+void
+fork_join_pool::complete_( detail::fork_join_task * t) BOOST_NOEXCEPT
+{
+    wait_( t);
+
+    detail::fork_join_worker * w = worker_();
+    detail::fork_join_task * next = 0;
+    detail::fork_join_task * parent = t->parent_;
+    if ( 0 != parent)
+    {
+        if ( t->failed_.load( memory_order_acquire) )
+            parent->set_exception( t->except_);
+        // last child of a parent waiting in sync()
+        if ( 1 == parent->join_.fetch_sub( 1, memory_order_acq_rel) )
+            next = parent;
+    }
+    else
+    {
+        fork_join_pool * pool = w->pool;
+        {
+            lock_guard< mutex > lk( pool->mtx_);
+            if ( t->failed_.load( memory_order_acquire) )
+                t->root_->except = t->except_;
+            t->root_->done = true;
+            pool->active_.fetch_sub( 1, memory_order_release);
+        }
+        pool->cond_.notify_all();
+    }
+    // usually the continuation of the parent, if not stolen
+    if ( 0 == next) next = w->deque.pop();
+    // the stack of t is released after leaving it
+    w->action = detail::fork_join_worker::action_release;
+    w->action_task = t;
+    w->current = next;
+    if ( 0 != next)
+        t->ctx_.jump( next->ctx_, reinterpret_cast< intptr_t >( next), next->preserve_fpu() );
+    else
+        t->ctx_.jump( w->ctx, 0, t->preserve_fpu() );
+}
+
+detail::fork_join_task *
+fork_join_pool::steal_( detail::fork_join_worker * w) BOOST_NOEXCEPT
+{
+    std::size_t n = workers_.size();
+    if ( 1 == n) return 0;
+    for ( std::size_t i = 0; i < n; ++i)
+    {
+        std::size_t victim = w->random() % n;
+        if ( victim == w->index) continue;
+        detail::fork_join_task * t = workers_[victim]->deque.steal();
+        if ( 0 != t) return t;
+    }
+    return 0;
+}
+
+void
+fork_join_pool::loop_( detail::fork_join_worker * w)
+{
+    current_worker_ = w;
+    std::size_t spins = 0;
+    for (;;)
+    {
+        detail::fork_join_task * t = post_( w);
+        if ( 0 == t) t = w->deque.pop();
+        if ( 0 == t) t = steal_( w);
+        if ( 0 == t)
+        {
+            if ( 0 < active_.load( memory_order_acquire) )
+            {
+                {
+                    lock_guard< mutex > lk( mtx_);
+                    if ( ! inject_.empty() )
+                    {
+                        t = inject_.front();
+                        inject_.pop_front();
+                    }
+                }
+                if ( 0 == t)
+                {
+                    if ( idle_spins < ++spins) this_thread::yield();
+                    continue;
+                }
+            }
+            else
+            {
+                unique_lock< mutex > lk( mtx_);
+                while ( 0 == active_.load( memory_order_relaxed) && ! stop_)
+                    cond_.wait( lk);
+                if ( stop_ && 0 == active_.load( memory_order_relaxed) ) break;
+                continue;
+            }
+        }
+        spins = 0;
+        w->current = t;
+        w->ctx.jump( t->ctx_, reinterpret_cast< intptr_t >( t), t->preserve_fpu() );
+    }
+    current_worker_ = 0;
+}
+
+void
+fork_join_pool::submit_( detail::fork_join_task * t, detail::fork_join_root & root)
+{
+    t->root_ = & root;
+    {
+        lock_guard< mutex > lk( mtx_);
+        inject_.push_back( t);
+        active_.fetch_add( 1, memory_order_release);
+    }
+    cond_.notify_all();
+    unique_lock< mutex > lk( mtx_);
+    while ( ! root.done)
+        cond_.wait( lk);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,36 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/hooks.hpp"
+
+#include <boost/coroutine/detail/hooks.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+atomic< coroutine_hooks * > hooks_installed( 0);
+
+}
+
+namespace hooks {
+
+void install( coroutine_hooks * h) BOOST_NOEXCEPT
+{ detail::hooks_installed.store( h, memory_order_release); }
+
+coroutine_hooks * installed() BOOST_NOEXCEPT
+{ return detail::hooks_installed.load( memory_order_acquire); }
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,69 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/latch.hpp"
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+void
+latch::count_down( std::size_t n) BOOST_NOEXCEPT
+{
+    detail::task_base * woken = 0;
+    {
+        lock_guard< detail::spinlock > lk( lock_);
+        BOOST_ASSERT_MSG( n <= count_, "latch counted down below zero");
+        count_ -= n;
+        if ( 0 == count_) woken = scheduler::detach( waiters_);
+    }
+    // the waiters might destroy the latch from here on
+    scheduler::wake( woken);
+}
+
+void
+latch::wait()
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    detail::task_base * self = sched->active();
+    BOOST_ASSERT( 0 != self);
+    {
+        // the counter is read under the lock only: count_down()
+        // releases it as its last access to the latch
+        lock_guard< detail::spinlock > lk( lock_);
+        if ( 0 == count_) return;
+        waiters_.push( self);
+        sched->expect_remote();
+    }
+    try
+    { sched->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        bool woken = false;
+        {
+            lock_guard< detail::spinlock > lk( lock_);
+            if ( waiters_.contains( self) )
+            {
+                waiters_.erase( self);
+                sched->withdraw_remote();
+            }
+            else woken = true;
+        }
+        if ( woken) sched->join_remote();
+        throw;
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
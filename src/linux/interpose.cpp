@@ -0,0 +1,392 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// replaces read(), write(), connect(), poll() and the sleep functions
+// of libc (link the library or LD_PRELOAD it): called from a task of
+// a scheduler polling a reactor a blocking call on a socket suspends
+// the task instead of the thread; outside of tasks the calls are
+// passed through
+
+// the fortified inline wrappers of libc would clash with the definitions
+#undef _FORTIFY_SOURCE
+
+#include <cstring>
+
+extern "C" {
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <boost/coroutine/reactor.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+namespace boost {
+namespace coroutines {
+namespace {
+
+typedef ssize_t ( * read_fn)( int, void *, size_t);
+typedef ssize_t ( * write_fn)( int, void const*, size_t);
+typedef int ( * connect_fn)( int, sockaddr const*, socklen_t);
+typedef int ( * poll_fn)( pollfd *, nfds_t, int);
+typedef int ( * close_fn)( int);
+typedef int ( * nanosleep_fn)( timespec const*, timespec *);
+typedef int ( * usleep_fn)( useconds_t);
+typedef unsigned int ( * sleep_fn)( unsigned int);
+
+typedef reactor::clock_type     clock_type;
+
+// calls on higher descriptors are passed through
+const int max_descriptors = 65536;
+
+// poll() on several descriptors is emulated by polling
+// without timeout at this interval
+const chrono::milliseconds poll_interval( 1);
+
+// state of a descriptor: the reactor it has been added to by the
+// hooks (first used by a task of this reactor) tagged with
+const uintptr_t unknown = 0;
+// not a socket, added to a reactor by the application or not
+// inspectable - passed through
+const uintptr_t passed = 1;
+// switched to non-blocking mode by the hooks - the application
+// still expects blocking calls
+const uintptr_t switched = 2;
+// socket in non-blocking mode (without reactor) - passed through,
+// added to a reactor by poll()
+const uintptr_t nonblocking = passed | switched;
+
+atomic< uintptr_t > descriptors[max_descriptors];
+
+template< typename Fn >
+Fn next( char const* name)
+{
+    void * p = ::dlsym( RTLD_NEXT, name);
+    BOOST_ASSERT_MSG( 0 != p, "symbol not found in libc");
+    Fn fn;
+    std::memcpy( & fn, & p, sizeof( fn) );
+    return fn;
+}
+
+read_fn libc_read()
+{
+    static read_fn fn = next< read_fn >("read");
+    return fn;
+}
+
+write_fn libc_write()
+{
+    static write_fn fn = next< write_fn >("write");
+    return fn;
+}
+
+connect_fn libc_connect()
+{
+    static connect_fn fn = next< connect_fn >("connect");
+    return fn;
+}
+
+poll_fn libc_poll()
+{
+    static poll_fn fn = next< poll_fn >("poll");
+    return fn;
+}
+
+close_fn libc_close()
+{
+    static close_fn fn = next< close_fn >("close");
+    return fn;
+}
+
+nanosleep_fn libc_nanosleep()
+{
+    static nanosleep_fn fn = next< nanosleep_fn >("nanosleep");
+    return fn;
+}
+
+usleep_fn libc_usleep()
+{
+    static usleep_fn fn = next< usleep_fn >("usleep");
+    return fn;
+}
+
+sleep_fn libc_sleep()
+{
+    static sleep_fn fn = next< sleep_fn >("sleep");
+    return fn;
+}
+
+reactor * owner( uintptr_t state) BOOST_NOEXCEPT
+{ return reinterpret_cast< reactor * >( state & ~( passed | switched) ); }
+
+// scheduler of the calling task, 0 outside of tasks
+scheduler * active_scheduler() BOOST_NOEXCEPT
+{
+    scheduler * sched = scheduler::instance();
+    return 0 != sched && 0 != sched->active() ? sched : 0;
+}
+
+reactor * active_reactor() BOOST_NOEXCEPT
+{
+    scheduler * sched = active_scheduler();
+    return 0 != sched ? dynamic_cast< reactor * >( sched->poller() ) : 0;
+}
+
+uintptr_t keep( int fd, uintptr_t state) BOOST_NOEXCEPT
+{
+    descriptors[fd].store( state, memory_order_release);
+    return state;
+}
+
+// adds socket fd to r at its first use by a task of r; sockets in
+// non-blocking mode are added only for poll() - the state is kept
+// until close()
+uintptr_t attach( reactor * r, int fd, bool polled)
+{
+    struct stat st;
+    int flags = -1;
+    if ( -1 == ::fstat( fd, & st) )
+    {
+        // not open: nothing to keep until close()
+        if ( EBADF == errno) return unknown;
+    }
+    // the mode of pipes and terminals (stdout ...) is shared with
+    // other processes - only sockets are switched to non-blocking mode
+    else if ( S_ISSOCK( st.st_mode) )
+        flags = ::fcntl( fd, F_GETFL, 0);
+    if ( -1 == flags) return keep( fd, passed);
+    // the application handles EAGAIN itself
+    if ( 0 != ( flags & O_NONBLOCK) && ! polled) return keep( fd, nonblocking);
+    system::error_code ec;
+    r->add( fd, ec);
+    if ( ec)
+    {
+        // added by the application itself
+        ::fcntl( fd, F_SETFL, flags);
+        return keep( fd, passed);
+    }
+    uintptr_t state = reinterpret_cast< uintptr_t >( r);
+    if ( 0 == ( flags & O_NONBLOCK) ) state |= switched;
+    return keep( fd, state);
+}
+
+// true if the application expects calls on fd to block; r is set
+// to the reactor the calling task waits with, to 0 if the thread
+// has to block (not called from a task of the reactor of fd)
+bool emulated( int fd, reactor * & r)
+{
+    r = 0;
+    if ( 0 > fd || max_descriptors <= fd) return false;
+    reactor * current = active_reactor();
+    uintptr_t state = descriptors[fd].load( memory_order_acquire);
+    if ( unknown == state && 0 != current)
+        state = attach( current, fd, false);
+    if ( 0 == owner( state) || 0 == ( state & switched) ) return false;
+    if ( owner( state) == current) r = current;
+    return true;
+}
+
+bool would_block() BOOST_NOEXCEPT
+{ return EAGAIN == errno || EWOULDBLOCK == errno; }
+
+int fail( system::error_code const& ec) BOOST_NOEXCEPT
+{
+    // the descriptor has been closed by another task
+    errno = system::errc::operation_canceled == ec ? EBADF : ec.value();
+    return -1;
+}
+
+// suspends the calling task until fd is ready, blocks the thread
+// if r is 0
+bool wait( reactor * r, int fd, short events)
+{
+    if ( 0 == r)
+    {
+        pollfd p;
+        p.fd = fd;
+        p.events = events;
+        p.revents = 0;
+        return -1 != libc_poll()( & p, 1, -1);
+    }
+    system::error_code ec;
+    if ( POLLIN == events)
+        r->async_wait_readable( fd, clock_type::time_point::max(), ec);
+    else
+        r->async_wait_writable( fd, clock_type::time_point::max(), ec);
+    if ( ! ec) return true;
+    fail( ec);
+    return false;
+}
+
+int connect_result( int fd) BOOST_NOEXCEPT
+{
+    int err = 0;
+    socklen_t len = sizeof( err);
+    if ( -1 == ::getsockopt( fd, SOL_SOCKET, SO_ERROR, & err, & len) )
+        return -1;
+    if ( 0 == err) return 0;
+    errno = err;
+    return -1;
+}
+
+// poll() on one descriptor suspends the task until the reactor
+// reports the requested direction
+int poll_one( reactor * r, pollfd * p, clock_type::time_point const& deadline)
+{
+    for (;;)
+    {
+        system::error_code ec;
+        if ( 0 != ( p->events & POLLOUT) )
+            r->async_wait_writable( p->fd, deadline, ec);
+        else
+            r->async_wait_readable( p->fd, deadline, ec);
+        if ( system::errc::timed_out == ec) return 0;
+        // otherwise libc reports the state (POLLNVAL ...)
+        int n = libc_poll()( p, 1, 0);
+        if ( 0 != n || ec) return n;
+    }
+}
+
+}}}
+
+using namespace boost::coroutines;
+
+extern "C"
+ssize_t read( int fd, void * buf, size_t size)
+{
+    reactor * r = 0;
+    if ( ! emulated( fd, r) ) return libc_read()( fd, buf, size);
+    for (;;)
+    {
+        ssize_t n = libc_read()( fd, buf, size);
+        if ( -1 != n || ! would_block() ) return n;
+        if ( ! wait( r, fd, POLLIN) ) return -1;
+    }
+}
+
+extern "C"
+ssize_t write( int fd, void const* buf, size_t size)
+{
+    reactor * r = 0;
+    if ( ! emulated( fd, r) ) return libc_write()( fd, buf, size);
+    // a blocking write transfers all bytes
+    char const* p = static_cast< char const* >( buf);
+    size_t written = 0;
+    do
+    {
+        ssize_t n = libc_write()( fd, p + written, size - written);
+        if ( -1 != n) written += static_cast< size_t >( n);
+        else if ( ! would_block() || ! wait( r, fd, POLLOUT) )
+            return 0 < written ? static_cast< ssize_t >( written) : -1;
+    }
+    while ( written < size);
+    return static_cast< ssize_t >( written);
+}
+
+extern "C"
+int connect( int fd, sockaddr const* addr, socklen_t len)
+{
+    reactor * r = 0;
+    if ( ! emulated( fd, r) ) return libc_connect()( fd, addr, len);
+    if ( 0 == libc_connect()( fd, addr, len) ) return 0;
+    if ( EINPROGRESS != errno) return -1;
+    // established (or failed) as soon as the socket is writable
+    if ( ! wait( r, fd, POLLOUT) ) return -1;
+    return connect_result( fd);
+}
+
+extern "C"
+int poll( pollfd * fds, nfds_t nfds, int timeout)
+{
+    scheduler * sched = active_scheduler();
+    if ( 0 == sched || 0 == timeout) return libc_poll()( fds, nfds, timeout);
+    int n = libc_poll()( fds, nfds, 0);
+    if ( 0 != n) return n;
+
+    clock_type::time_point deadline( clock_type::time_point::max() );
+    if ( 0 < timeout) deadline = clock_type::now() + boost::chrono::milliseconds( timeout);
+    if ( 1 == nfds && 0 <= fds[0].fd && max_descriptors > fds[0].fd)
+    {
+        reactor * r = active_reactor();
+        short dir = fds[0].events & ( POLLIN | POLLOUT);
+        if ( 0 != r && ( POLLIN == dir || POLLOUT == dir) )
+        {
+            uintptr_t state = descriptors[fds[0].fd].load( boost::memory_order_acquire);
+            if ( unknown == state || nonblocking == state) state = attach( r, fds[0].fd, true);
+            if ( owner( state) == r) return poll_one( r, fds, deadline);
+        }
+    }
+    // the reactor waits for one direction of one descriptor - other
+    // sets are polled at short intervals, the thread keeps running
+    // the other tasks
+    for (;;)
+    {
+        clock_type::time_point now( clock_type::now() );
+        if ( deadline <= now) return 0;
+        sched->sleep_until( deadline - now < poll_interval ? deadline : now + poll_interval);
+        n = libc_poll()( fds, nfds, 0);
+        if ( 0 != n) return n;
+    }
+}
+
+extern "C"
+int close( int fd)
+{
+    if ( 0 <= fd && max_descriptors > fd)
+    {
+        uintptr_t state = descriptors[fd].exchange( unknown, boost::memory_order_acq_rel);
+        reactor * r = owner( state);
+        scheduler * sched = scheduler::instance();
+        // the reactor is not thread-safe - the descriptor is removed
+        // only by the thread of its scheduler
+        if ( 0 != r && 0 != sched && r == sched->poller() ) r->remove( fd);
+    }
+    return libc_close()( fd);
+}
+
+extern "C"
+int nanosleep( timespec const* req, timespec * rem)
+{
+    scheduler * sched = active_scheduler();
+    if ( 0 == sched) return libc_nanosleep()( req, rem);
+    if ( 0 > req->tv_sec || 0 > req->tv_nsec || 999999999 < req->tv_nsec)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    sched->sleep_for(
+        boost::chrono::seconds( req->tv_sec) + boost::chrono::nanoseconds( req->tv_nsec) );
+    if ( 0 != rem) rem->tv_sec = rem->tv_nsec = 0;
+    return 0;
+}
+
+extern "C"
+int usleep( useconds_t usec)
+{
+    scheduler * sched = active_scheduler();
+    if ( 0 == sched) return libc_usleep()( usec);
+    sched->sleep_for( boost::chrono::microseconds( usec) );
+    return 0;
+}
+
+extern "C"
+unsigned int sleep( unsigned int seconds)
+{
+    scheduler * sched = active_scheduler();
+    if ( 0 == sched) return libc_sleep()( seconds);
+    sched->sleep_for( boost::chrono::seconds( seconds) );
+    return 0;
+}
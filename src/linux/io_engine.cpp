@@ -0,0 +1,893 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/io_engine.hpp"
+
+#include <climits>
+#include <cstring>
+
+extern "C" {
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if ! defined(BOOST_COROUTINES_NO_IO_URING)
+# include <linux/io_uring.h>
+#endif
+}
+
+#include <boost/assert.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/detail/syscall.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// control block of an operation, lives on the stack of the
+// submitting task; user_data of the SQE points to it
+struct uring_op
+{
+    task_base   *   task;
+    int             fd;
+    int             res;
+    bool            done;
+    // cancellation requested by remove(), not submitted yet
+    bool            cancel;
+    uring_op    *   next;
+    uring_op    *   prev;
+};
+
+#if ! defined(BOOST_COROUTINES_NO_IO_URING)
+
+struct uring
+{
+    int                 fd;
+    unsigned            entries;
+    unsigned        *   sq_head;
+    unsigned        *   sq_tail;
+    unsigned            sq_mask;
+    unsigned            sq_local_tail;
+    io_uring_sqe    *   sqes;
+    unsigned        *   cq_head;
+    unsigned        *   cq_tail;
+    unsigned            cq_mask;
+    io_uring_cqe    *   cqes;
+    void            *   sq_ptr;
+    std::size_t         sq_size;
+    void            *   cq_ptr;
+    std::size_t         cq_size;
+    std::size_t         sqes_size;
+};
+
+#else
+
+struct uring {};
+
+#endif
+
+}
+
+namespace {
+
+// completions resumed by one call of poll()
+const std::size_t max_batch = 256;
+
+// user_data of the poll of the eventfd signalled by interrupt()
+detail::uring_op wakeup_op = { 0, -1, 0, false, false, 0, 0 };
+
+void throw_on_error( system::error_code const& ec, char const* what)
+{
+    if ( ec) boost::throw_exception( system::system_error( ec, what) );
+}
+
+void throw_errno( char const* what)
+{
+    boost::throw_exception(
+        system::system_error(
+            system::error_code( errno, system::system_category() ),
+            what) );
+}
+
+#if ! defined(BOOST_COROUTINES_NO_IO_URING)
+
+const int op_read = IORING_OP_READ;
+const int op_write = IORING_OP_WRITE;
+const int op_read_fixed = IORING_OP_READ_FIXED;
+const int op_write_fixed = IORING_OP_WRITE_FIXED;
+const int op_accept = IORING_OP_ACCEPT;
+const int op_connect = IORING_OP_CONNECT;
+const int op_poll_add = IORING_OP_POLL_ADD;
+
+void uring_close( detail::uring * r) BOOST_NOEXCEPT
+{
+    ::munmap( r->sqes, r->sqes_size);
+    if ( r->cq_ptr != r->sq_ptr) ::munmap( r->cq_ptr, r->cq_size);
+    ::munmap( r->sq_ptr, r->sq_size);
+    ::close( r->fd);
+    delete r;
+}
+
+// returns 0 if io_uring is not usable - the caller falls back to epoll
+detail::uring * uring_open( unsigned entries)
+{
+    io_uring_params p;
+    std::memset( & p, 0, sizeof( p) );
+    int fd = static_cast< int >( ::syscall( __NR_io_uring_setup, entries, & p) );
+    if ( -1 == fd) return 0;
+    // timeouts of io_uring_enter() and a single mapping of both rings
+    // are required; CQEs must not be dropped
+    unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ( required != ( p.features & required) )
+    {
+        ::close( fd);
+        return 0;
+    }
+    detail::uring * r = new detail::uring();
+    r->fd = fd;
+    r->entries = p.sq_entries;
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof( unsigned);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof( io_uring_cqe);
+    if ( r->cq_size > r->sq_size) r->sq_size = r->cq_size;
+    r->cq_size = r->sq_size;
+    r->sq_ptr = ::mmap( 0, r->sq_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if ( MAP_FAILED == r->sq_ptr)
+    {
+        ::close( fd);
+        delete r;
+        return 0;
+    }
+    r->cq_ptr = r->sq_ptr;
+    r->sqes_size = p.sq_entries * sizeof( io_uring_sqe);
+    void * sqes = ::mmap( 0, r->sqes_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if ( MAP_FAILED == sqes)
+    {
+        ::munmap( r->sq_ptr, r->sq_size);
+        ::close( fd);
+        delete r;
+        return 0;
+    }
+    char * sq = static_cast< char * >( r->sq_ptr);
+    r->sq_head = reinterpret_cast< unsigned * >( sq + p.sq_off.head);
+    r->sq_tail = reinterpret_cast< unsigned * >( sq + p.sq_off.tail);
+    r->sq_mask = * reinterpret_cast< unsigned * >( sq + p.sq_off.ring_mask);
+    r->sq_local_tail = * r->sq_tail;
+    r->sqes = static_cast< io_uring_sqe * >( sqes);
+    // identity mapping - SQE i is always submitted from slot i
+    unsigned * array = reinterpret_cast< unsigned * >( sq + p.sq_off.array);
+    for ( unsigned i = 0; i < p.sq_entries; ++i)
+        array[i] = i;
+    char * cq = static_cast< char * >( r->cq_ptr);
+    r->cq_head = reinterpret_cast< unsigned * >( cq + p.cq_off.head);
+    r->cq_tail = reinterpret_cast< unsigned * >( cq + p.cq_off.tail);
+    r->cq_mask = * reinterpret_cast< unsigned * >( cq + p.cq_off.ring_mask);
+    r->cqes = reinterpret_cast< io_uring_cqe * >( cq + p.cq_off.cqes);
+    return r;
+}
+
+unsigned uring_pending( detail::uring * r) BOOST_NOEXCEPT
+{ return r->sq_local_tail - __atomic_load_n( r->sq_head, __ATOMIC_ACQUIRE); }
+
+// submits the pending SQEs; with min_complete > 0 waits for
+// completions until the deadline (forever if 0)
+void uring_enter( detail::uring * r, unsigned min_complete,
+                  detail::clock_type::time_point const* deadline)
+{
+    unsigned to_submit = uring_pending( r);
+    unsigned flags = 0;
+    __kernel_timespec ts;
+    io_uring_getevents_arg arg;
+    std::memset( & arg, 0, sizeof( arg) );
+    if ( 0 < min_complete)
+    {
+        flags |= IORING_ENTER_GETEVENTS;
+        if ( 0 != deadline)
+        {
+            detail::clock_type::duration d( * deadline - detail::clock_type::now() );
+            chrono::nanoseconds ns( chrono::duration_cast< chrono::nanoseconds >( d) );
+            if ( ns.count() < 0) ns = chrono::nanoseconds::zero();
+            ts.tv_sec = ns.count() / 1000000000;
+            ts.tv_nsec = ns.count() % 1000000000;
+            arg.ts = reinterpret_cast< uintptr_t >( & ts);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+    }
+    if ( 0 == to_submit && 0 == flags) return;
+    long n = ::syscall( __NR_io_uring_enter, r->fd, to_submit, min_complete, flags,
+                        0 != ( flags & IORING_ENTER_EXT_ARG) ? & arg : 0,
+                        0 != ( flags & IORING_ENTER_EXT_ARG) ? sizeof( arg) : 0);
+    if ( -1 == n && EINTR != errno && ETIME != errno && EBUSY != errno && EAGAIN != errno)
+        throw_errno("io_uring_enter");
+}
+
+io_uring_sqe * uring_sqe( detail::uring * r)
+{
+    if ( r->entries == uring_pending( r) )
+    {
+        uring_enter( r, 0, 0);
+        if ( r->entries == uring_pending( r) ) return 0;
+    }
+    io_uring_sqe * sqe = & r->sqes[r->sq_local_tail & r->sq_mask];
+    std::memset( sqe, 0, sizeof( io_uring_sqe) );
+    return sqe;
+}
+
+void uring_commit( detail::uring * r) BOOST_NOEXCEPT
+{
+    // published now, consumed by the kernel at the next io_uring_enter()
+    ++r->sq_local_tail;
+    __atomic_store_n( r->sq_tail, r->sq_local_tail, __ATOMIC_RELEASE);
+}
+
+void uring_prepare( io_uring_sqe * sqe, int op, int fd, int fixed,
+                    void const* addr, std::size_t len,
+                    uint64_t off, uint32_t op_flags, int buf_index,
+                    detail::uring_op * o) BOOST_NOEXCEPT
+{
+    sqe->opcode = static_cast< __u8 >( op);
+    if ( 0 <= fixed)
+    {
+        sqe->fd = fixed;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+    else
+        sqe->fd = fd;
+    sqe->addr = reinterpret_cast< uintptr_t >( addr);
+    sqe->len = static_cast< __u32 >( len);
+    sqe->off = off;
+    sqe->rw_flags = op_flags;
+    if ( 0 <= buf_index) sqe->buf_index = static_cast< __u16 >( buf_index);
+    sqe->user_data = reinterpret_cast< uintptr_t >( o);
+}
+
+// cancels the operation o (keyed by user_data, available with all
+// kernels providing IORING_FEAT_EXT_ARG); returns false if the
+// submission queue is full - the completion of the cancellation
+// itself is ignored
+bool uring_cancel( detail::uring * r, detail::uring_op * o)
+{
+    io_uring_sqe * sqe = uring_sqe( r);
+    if ( 0 == sqe) return false;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast< uintptr_t >( o);
+    sqe->user_data = 0;
+    uring_commit( r);
+    return true;
+}
+
+bool uring_next_cqe( detail::uring * r, uint64_t & user_data, int & res) BOOST_NOEXCEPT
+{
+    unsigned head = * r->cq_head;
+    if ( head == __atomic_load_n( r->cq_tail, __ATOMIC_ACQUIRE) ) return false;
+    io_uring_cqe * cqe = & r->cqes[head & r->cq_mask];
+    user_data = cqe->user_data;
+    res = cqe->res;
+    __atomic_store_n( r->cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+int uring_register( detail::uring * r, unsigned op, void const* arg, unsigned n) BOOST_NOEXCEPT
+{
+    long res = ::syscall( __NR_io_uring_register, r->fd, op, arg, n);
+    return -1 == res ? errno : 0;
+}
+
+const unsigned register_buffers_op = IORING_REGISTER_BUFFERS;
+const unsigned unregister_buffers_op = IORING_UNREGISTER_BUFFERS;
+const unsigned register_files_op = IORING_REGISTER_FILES;
+const unsigned unregister_files_op = IORING_UNREGISTER_FILES;
+
+#else
+
+// io_uring disabled at compile time - the engine always uses
+// the fallback and the functions below are never called
+
+const int op_read = 0;
+const int op_write = 0;
+const int op_read_fixed = 0;
+const int op_write_fixed = 0;
+const int op_accept = 0;
+const int op_connect = 0;
+const int op_poll_add = 0;
+
+struct io_uring_sqe {};
+
+void uring_close( detail::uring *) BOOST_NOEXCEPT {}
+
+detail::uring * uring_open( unsigned) { return 0; }
+
+unsigned uring_pending( detail::uring *) BOOST_NOEXCEPT { return 0; }
+
+void uring_enter( detail::uring *, unsigned, detail::clock_type::time_point const*) {}
+
+io_uring_sqe * uring_sqe( detail::uring *) { return 0; }
+
+void uring_commit( detail::uring *) BOOST_NOEXCEPT {}
+
+void uring_prepare( io_uring_sqe *, int, int, int, void const*, std::size_t,
+                    uint64_t, uint32_t, int, detail::uring_op *) BOOST_NOEXCEPT
+{}
+
+bool uring_cancel( detail::uring *, detail::uring_op *) { return false; }
+
+bool uring_next_cqe( detail::uring *, uint64_t &, int &) BOOST_NOEXCEPT { return false; }
+
+int uring_register( detail::uring *, unsigned, void const*, unsigned) BOOST_NOEXCEPT
+{ return ENOSYS; }
+
+const unsigned register_buffers_op = 0;
+const unsigned unregister_buffers_op = 0;
+const unsigned register_files_op = 0;
+const unsigned unregister_files_op = 0;
+
+#endif
+
+}
+
+io_engine::io_engine( scheduler & sched, io_backend backend, unsigned entries) :
+    sched_( & sched),
+    ring_( io_backend_epoll != backend ? uring_open( entries) : 0),
+    reactor_( 0),
+    inflight_( 0),
+    cancels_( 0),
+    evfd_( -1),
+    armed_( false),
+    buffers_(),
+    files_(),
+    latency_( clock_type::duration::max() ),
+    batch_start_()
+{
+    if ( 0 == ring_)
+    {
+        reactor_ = new reactor( sched);
+        return;
+    }
+    evfd_ = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ( -1 == evfd_)
+    {
+        system::error_code ec( errno, system::system_category() );
+        uring_close( ring_);
+        boost::throw_exception( system::system_error( ec, "eventfd") );
+    }
+    sched_->poller( this);
+}
+
+io_engine::~io_engine()
+{
+    if ( 0 != reactor_)
+    {
+        delete reactor_;
+        return;
+    }
+    // the forced_unwind handler of a task cancels its operation and
+    // waits for the completion - the kernel must not write to the
+    // unwound stack
+    while ( 0 != inflight_)
+    {
+        BOOST_ASSERT( inflight_->task->force_unwind() );
+        sched_->unwind_( inflight_->task);
+    }
+    sched_->poller( 0);
+    uring_close( ring_);
+    ::close( evfd_);
+}
+
+int
+io_engine::buffer_( void const* buf, std::size_t size) const BOOST_NOEXCEPT
+{
+    char const* p = static_cast< char const* >( buf);
+    for ( std::size_t i = 0; i < buffers_.size(); ++i)
+    {
+        char const* b = static_cast< char const* >( buffers_[i].iov_base);
+        if ( b <= p && p + size <= b + buffers_[i].iov_len)
+            return static_cast< int >( i);
+    }
+    return -1;
+}
+
+int
+io_engine::execute_( int op, int fd, void const* addr, std::size_t len,
+                     uint64_t off, uint32_t op_flags, int buf_index)
+{
+    detail::task_base * self = sched_->active();
+    BOOST_ASSERT( 0 != self);
+
+    io_uring_sqe * sqe = uring_sqe( ring_);
+    if ( 0 == sqe) return -EBUSY;
+    int fixed = 0 <= fd && static_cast< std::size_t >( fd) < files_.size() ? files_[fd] : -1;
+    detail::uring_op o = { self, fd, 0, false, false, 0, 0 };
+    uring_prepare( sqe, op, fd, fixed, addr, len, off, op_flags, buf_index, & o);
+    uring_commit( ring_);
+    flush_();
+    o.next = inflight_;
+    o.prev = 0;
+    if ( 0 != inflight_) inflight_->prev = & o;
+    inflight_ = & o;
+    try
+    { sched_->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        if ( ! o.done)
+        {
+            bool canceled = false;
+            detail::task_base * tasks[max_batch];
+            while ( ! o.done)
+            {
+                if ( ! canceled) canceled = uring_cancel( ring_, & o);
+                uring_enter( ring_, 1, 0);
+                std::size_t n = reap_( tasks, max_batch);
+                for ( std::size_t i = 0; i < n; ++i)
+                    if ( self != tasks[i]) sched_->schedule( tasks[i]);
+            }
+        }
+        throw;
+    }
+    BOOST_ASSERT( o.done);
+    return o.res;
+}
+
+int
+io_engine::poll_fd_( int fd, uint32_t events)
+{ return execute_( op_poll_add, fd, 0, 0, 0, events, -1); }
+
+std::size_t
+io_engine::reap_( detail::task_base ** tasks, std::size_t n) BOOST_NOEXCEPT
+{
+    std::size_t i = 0;
+    uint64_t user_data = 0;
+    int res = 0;
+    while ( i < n && uring_next_cqe( ring_, user_data, res) )
+    {
+        detail::uring_op * o = reinterpret_cast< detail::uring_op * >( user_data);
+        if ( 0 == o) continue;
+        if ( & wakeup_op == o)
+        {
+            uint64_t value = 0;
+            while ( -1 == detail::sys_read( evfd_, & value, sizeof( value) ) && EINTR == errno)
+                ;
+            armed_ = false;
+            continue;
+        }
+        o->res = res;
+        o->done = true;
+        if ( o->cancel) --cancels_;
+        if ( 0 != o->prev) o->prev->next = o->next;
+        else inflight_ = o->next;
+        if ( 0 != o->next) o->next->prev = o->prev;
+        tasks[i++] = o->task;
+    }
+    return i;
+}
+
+void
+io_engine::poll( detail::clock_type::time_point const* deadline)
+{
+    BOOST_ASSERT( 0 != ring_);
+    BOOST_ASSERT( 0 == sched_->active() );
+
+    // cancellations remove() could not submit
+    if ( 0 != cancels_) cancel_();
+    // one syscall submits the operations of all tasks suspended
+    // since the last call and waits for completions
+    if ( 0 == deadline)
+    {
+        arm_();
+        uring_enter( ring_, 1, 0);
+    }
+    else if ( * deadline <= detail::clock_type::now() ) uring_enter( ring_, 0, 0);
+    else
+    {
+        arm_();
+        uring_enter( ring_, 1, deadline);
+    }
+
+    detail::task_base * tasks[max_batch];
+    std::size_t n = reap_( tasks, max_batch);
+    // resumed without the detour through the ready-queue; the
+    // engine might be destroyed by a resumed task
+    scheduler * sched = sched_;
+    std::size_t i = 0;
+    try
+    {
+        for ( ; i < n; ++i)
+            sched->resume_( tasks[i]);
+    }
+    catch (...)
+    {
+        for ( ++i; i < n; ++i)
+            sched->schedule( tasks[i]);
+        throw;
+    }
+}
+
+void
+io_engine::arm_()
+{
+    if ( armed_) return;
+    io_uring_sqe * sqe = uring_sqe( ring_);
+    if ( 0 == sqe) return;
+    uring_prepare( sqe, op_poll_add, evfd_, -1, 0, 0, 0, POLLIN, -1, & wakeup_op);
+    uring_commit( ring_);
+    armed_ = true;
+}
+
+void
+io_engine::cancel_()
+{
+    for ( detail::uring_op * o = inflight_; 0 != o && 0 != cancels_; o = o->next)
+    {
+        if ( ! o->cancel) continue;
+        if ( ! uring_cancel( ring_, o) ) return;
+        o->cancel = false;
+        --cancels_;
+    }
+}
+
+void
+io_engine::flush_()
+{
+    if ( clock_type::duration::max() == latency_) return;
+    if ( clock_type::duration::zero() < latency_)
+    {
+        // the clock is read only by batches bounded in time
+        clock_type::time_point now( clock_type::now() );
+        if ( 1 == uring_pending( ring_) )
+        {
+            batch_start_ = now;
+            return;
+        }
+        if ( now - batch_start_ < latency_) return;
+    }
+    uring_enter( ring_, 0, 0);
+}
+
+void
+io_engine::interrupt() BOOST_NOEXCEPT
+{
+    if ( 0 != reactor_)
+    {
+        reactor_->interrupt();
+        return;
+    }
+    uint64_t value = 1;
+    while ( -1 == detail::sys_write( evfd_, & value, sizeof( value) ) && EINTR == errno)
+        ;
+}
+
+void
+io_engine::add( int fd, system::error_code & ec)
+{
+    if ( 0 != reactor_) reactor_->add( fd, ec);
+    else ec.clear();
+}
+
+void
+io_engine::add( int fd)
+{
+    system::error_code ec;
+    add( fd, ec);
+    throw_on_error( ec, "add");
+}
+
+void
+io_engine::remove( int fd) BOOST_NOEXCEPT
+{
+    if ( 0 != reactor_)
+    {
+        reactor_->remove( fd);
+        return;
+    }
+    for ( detail::uring_op * o = inflight_; 0 != o; o = o->next)
+    {
+        if ( fd != o->fd || o->cancel) continue;
+        o->cancel = true;
+        ++cancels_;
+    }
+    // a failure of io_uring_enter() is reported by the next poll(),
+    // submitting the remaining cancellations again
+    try
+    { cancel_(); }
+    catch (...)
+    {}
+}
+
+void
+io_engine::register_buffers( iovec const* iov, std::size_t n, system::error_code & ec)
+{
+    BOOST_ASSERT( buffers_.empty() );
+
+    if ( 0 != ring_)
+    {
+        int err = uring_register( ring_, register_buffers_op, iov, static_cast< unsigned >( n) );
+        if ( 0 != err)
+        {
+            ec.assign( err, system::system_category() );
+            return;
+        }
+        buffers_.assign( iov, iov + n);
+    }
+    ec.clear();
+}
+
+void
+io_engine::register_buffers( iovec const* iov, std::size_t n)
+{
+    system::error_code ec;
+    register_buffers( iov, n, ec);
+    throw_on_error( ec, "register_buffers");
+}
+
+void
+io_engine::unregister_buffers() BOOST_NOEXCEPT
+{
+    if ( buffers_.empty() ) return;
+    uring_register( ring_, unregister_buffers_op, 0, 0);
+    buffers_.clear();
+}
+
+void
+io_engine::register_files( int const* fds, std::size_t n, system::error_code & ec)
+{
+    BOOST_ASSERT( files_.empty() );
+
+    if ( 0 != ring_)
+    {
+        int err = uring_register( ring_, register_files_op, fds, static_cast< unsigned >( n) );
+        if ( 0 != err)
+        {
+            ec.assign( err, system::system_category() );
+            return;
+        }
+        for ( std::size_t i = 0; i < n; ++i)
+        {
+            if ( fds[i] < 0) continue;
+            if ( files_.size() <= static_cast< std::size_t >( fds[i]) )
+                files_.resize( fds[i] + 1, -1);
+            files_[fds[i]] = static_cast< int >( i);
+        }
+    }
+    ec.clear();
+}
+
+void
+io_engine::register_files( int const* fds, std::size_t n)
+{
+    system::error_code ec;
+    register_files( fds, n, ec);
+    throw_on_error( ec, "register_files");
+}
+
+void
+io_engine::unregister_files() BOOST_NOEXCEPT
+{
+    if ( files_.empty() ) return;
+    uring_register( ring_, unregister_files_op, 0, 0);
+    files_.clear();
+}
+
+std::size_t
+io_engine::async_read( int fd, void * buf, std::size_t size, system::error_code & ec)
+{
+    if ( 0 != reactor_) return reactor_->async_read( fd, buf, size, ec);
+    for (;;)
+    {
+        // offset -1: current file position (sockets, pipes)
+        int res = execute_( op_read, fd, buf, size, static_cast< uint64_t >( -1), 0, -1);
+        if ( -EAGAIN == res) res = poll_fd_( fd, POLLIN);
+        else if ( 0 <= res)
+        {
+            ec.clear();
+            return static_cast< std::size_t >( res);
+        }
+        if ( 0 <= res || -EINTR == res) continue;
+        ec.assign( -res, system::system_category() );
+        return 0;
+    }
+}
+
+std::size_t
+io_engine::async_read( int fd, void * buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_read( fd, buf, size, ec);
+    throw_on_error( ec, "async_read");
+    return n;
+}
+
+std::size_t
+io_engine::async_write( int fd, void const* buf, std::size_t size, system::error_code & ec)
+{
+    if ( 0 != reactor_) return reactor_->async_write( fd, buf, size, ec);
+    char const* p = static_cast< char const* >( buf);
+    std::size_t written = 0;
+    ec.clear();
+    while ( written < size)
+    {
+        int res = execute_( op_write, fd, p + written, size - written,
+                            static_cast< uint64_t >( -1), 0, -1);
+        if ( 0 <= res)
+        {
+            written += static_cast< std::size_t >( res);
+            continue;
+        }
+        if ( -EAGAIN == res) res = poll_fd_( fd, POLLOUT);
+        if ( 0 <= res || -EINTR == res) continue;
+        ec.assign( -res, system::system_category() );
+        break;
+    }
+    return written;
+}
+
+std::size_t
+io_engine::async_write( int fd, void const* buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_write( fd, buf, size, ec);
+    throw_on_error( ec, "async_write");
+    return n;
+}
+
+std::size_t
+io_engine::async_read_at( int fd, uint64_t offset, void * buf, std::size_t size,
+                          system::error_code & ec)
+{
+    for (;;)
+    {
+        int res = 0;
+        if ( 0 != ring_)
+        {
+            int idx = buffer_( buf, size);
+            res = execute_( 0 <= idx ? op_read_fixed : op_read,
+                            fd, buf, size, offset, 0, idx);
+        }
+        else
+        {
+            // regular files are always ready - epoll rejects them
+            ssize_t n = ::pread( fd, buf, size, static_cast< off_t >( offset) );
+            res = -1 == n ? -errno : static_cast< int >( n);
+        }
+        if ( -EINTR == res) continue;
+        if ( res < 0)
+        {
+            ec.assign( -res, system::system_category() );
+            return 0;
+        }
+        ec.clear();
+        return static_cast< std::size_t >( res);
+    }
+}
+
+std::size_t
+io_engine::async_read_at( int fd, uint64_t offset, void * buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_read_at( fd, offset, buf, size, ec);
+    throw_on_error( ec, "async_read_at");
+    return n;
+}
+
+std::size_t
+io_engine::async_write_at( int fd, uint64_t offset, void const* buf, std::size_t size,
+                           system::error_code & ec)
+{
+    char const* p = static_cast< char const* >( buf);
+    std::size_t written = 0;
+    ec.clear();
+    while ( written < size)
+    {
+        int res = 0;
+        if ( 0 != ring_)
+        {
+            int idx = buffer_( p + written, size - written);
+            res = execute_( 0 <= idx ? op_write_fixed : op_write,
+                            fd, p + written, size - written, offset + written, 0, idx);
+        }
+        else
+        {
+            ssize_t n = ::pwrite( fd, p + written, size - written,
+                                  static_cast< off_t >( offset + written) );
+            res = -1 == n ? -errno : static_cast< int >( n);
+        }
+        if ( 0 <= res)
+        {
+            written += static_cast< std::size_t >( res);
+            continue;
+        }
+        if ( -EINTR == res) continue;
+        ec.assign( -res, system::system_category() );
+        break;
+    }
+    return written;
+}
+
+std::size_t
+io_engine::async_write_at( int fd, uint64_t offset, void const* buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_write_at( fd, offset, buf, size, ec);
+    throw_on_error( ec, "async_write_at");
+    return n;
+}
+
+int
+io_engine::async_accept( int fd, system::error_code & ec)
+{
+    if ( 0 != reactor_) return reactor_->async_accept( fd, ec);
+    for (;;)
+    {
+        int res = execute_( op_accept, fd, 0, 0, 0, SOCK_CLOEXEC, -1);
+        if ( 0 <= res)
+        {
+            ec.clear();
+            return res;
+        }
+        if ( -EAGAIN == res) res = poll_fd_( fd, POLLIN);
+        if ( 0 <= res || -EINTR == res || -ECONNABORTED == res) continue;
+        ec.assign( -res, system::system_category() );
+        return -1;
+    }
+}
+
+int
+io_engine::async_accept( int fd)
+{
+    system::error_code ec;
+    int s = async_accept( fd, ec);
+    throw_on_error( ec, "async_accept");
+    return s;
+}
+
+void
+io_engine::async_connect( int fd, sockaddr const* addr, socklen_t len, system::error_code & ec)
+{
+    if ( 0 != reactor_)
+    {
+        reactor_->async_connect( fd, addr, len, ec);
+        return;
+    }
+    int res = execute_( op_connect, fd, addr, 0, len, 0, -1);
+    if ( -EINPROGRESS == res || -EAGAIN == res || -EALREADY == res)
+    {
+        // non-blocking socket: established as soon as it is writable
+        res = poll_fd_( fd, POLLOUT);
+        if ( 0 <= res)
+        {
+            int err = 0;
+            socklen_t err_len = sizeof( err);
+            res = -1 == ::getsockopt( fd, SOL_SOCKET, SO_ERROR, & err, & err_len)
+                ? -errno : -err;
+        }
+    }
+    if ( res < 0) ec.assign( -res, system::system_category() );
+    else ec.clear();
+}
+
+void
+io_engine::async_connect( int fd, sockaddr const* addr, socklen_t len)
+{
+    system::error_code ec;
+    async_connect( fd, addr, len, ec);
+    throw_on_error( ec, "async_connect");
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
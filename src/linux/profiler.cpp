@@ -0,0 +1,218 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/profiler.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/stack_sample.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// samples kept until clear()
+#if ! defined(BOOST_COROUTINES_PROFILE_SAMPLES)
+# define BOOST_COROUTINES_PROFILE_SAMPLES 8192
+#endif
+
+// frames recorded per sample
+#if ! defined(BOOST_COROUTINES_PROFILE_DEPTH)
+# define BOOST_COROUTINES_PROFILE_DEPTH 64
+#endif
+
+namespace boost {
+namespace coroutines {
+
+namespace {
+
+const std::size_t capacity = BOOST_COROUTINES_PROFILE_SAMPLES;
+
+struct sample
+{
+    atomic< bool >      ready;
+    void const      *   coroutine;
+    char const      *   label;
+    std::size_t         depth;
+    // interrupted instruction followed by the return addresses
+    void const      *   pcs[BOOST_COROUTINES_PROFILE_DEPTH];
+
+    sample() :
+        ready( false), coroutine( 0), label( 0), depth( 0)
+    {}
+};
+
+atomic< bool > running_( false);
+// slots handed out, may exceed the capacity
+atomic< uint64_t > next_( 0);
+sample * samples_ = 0;
+
+void fail_( char const* what)
+{
+    boost::throw_exception(
+        system::system_error(
+            system::error_code( errno, system::system_category() ),
+            what) );
+}
+
+void record_( void * uc) BOOST_NOEXCEPT
+{
+    uint64_t i = next_.fetch_add( 1, memory_order_relaxed);
+    if ( capacity <= i) return;
+    sample & s = samples_[i];
+
+    detail::coroutine_context * ctx = detail::coroutine_context::active();
+    s.coroutine = ctx;
+    s.label = 0 != ctx ? ctx->label() : 0;
+    s.depth = detail::sample_stack( uc, ctx, s.pcs, BOOST_COROUTINES_PROFILE_DEPTH);
+    s.ready.store( true, memory_order_release);
+}
+
+extern "C" void on_sigprof( int, siginfo_t *, void * uc)
+{
+    if ( ! running_.load( memory_order_relaxed) ) return;
+    int err = errno;
+    record_( uc);
+    errno = err;
+}
+
+void set_timer_( unsigned int frequency)
+{
+    struct itimerval tv;
+    std::memset( & tv, 0, sizeof( tv) );
+    if ( 0 != frequency)
+    {
+        long us = 1000000L / static_cast< long >( frequency);
+        if ( 0 == us) us = 1;
+        tv.it_interval.tv_sec = us / 1000000L;
+        tv.it_interval.tv_usec = us % 1000000L;
+        tv.it_value = tv.it_interval;
+    }
+    if ( 0 != ::setitimer( ITIMER_PROF, & tv, 0) )
+        fail_("setitimer() failed");
+}
+
+}
+
+namespace profiler {
+
+void start( unsigned int frequency)
+{
+    BOOST_ASSERT( 0 < frequency);
+
+    if ( 0 == samples_) samples_ = new sample[capacity];
+
+    struct sigaction sa;
+    std::memset( & sa, 0, sizeof( sa) );
+    sa.sa_sigaction = on_sigprof;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    ::sigemptyset( & sa.sa_mask);
+    if ( 0 != ::sigaction( SIGPROF, & sa, 0) )
+        fail_("sigaction() failed");
+
+    if ( ! running_.load( memory_order_relaxed) )
+        detail::coroutine_context::track_active( true);
+    running_.store( true, memory_order_relaxed);
+    set_timer_( frequency);
+}
+
+void stop() BOOST_NOEXCEPT
+{
+    if ( ! running_.load( memory_order_relaxed) ) return;
+    try
+    { set_timer_( 0); }
+    catch (...)
+    {}
+    running_.store( false, memory_order_relaxed);
+    detail::coroutine_context::track_active( false);
+}
+
+bool running() BOOST_NOEXCEPT
+{ return running_.load( memory_order_relaxed); }
+
+void clear() BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( ! running_.load( memory_order_relaxed) );
+
+    if ( 0 != samples_)
+        for ( std::size_t i = 0; i < capacity; ++i)
+            samples_[i].ready.store( false, memory_order_relaxed);
+    next_.store( 0, memory_order_relaxed);
+}
+
+std::size_t samples() BOOST_NOEXCEPT
+{
+    uint64_t n = next_.load( memory_order_relaxed);
+    return static_cast< std::size_t >( n < capacity ? n : capacity);
+}
+
+std::size_t dropped() BOOST_NOEXCEPT
+{
+    uint64_t n = next_.load( memory_order_relaxed);
+    return static_cast< std::size_t >( n < capacity ? 0 : n - capacity);
+}
+
+void write_folded( std::ostream & os, bool by_coroutine)
+{
+    std::map< void const*, std::string > symbols;
+    std::map< std::string, std::size_t > stacks;
+    std::size_t n = samples();
+    for ( std::size_t i = 0; i < n; ++i)
+    {
+        sample const& s = samples_[i];
+        if ( ! s.ready.load( memory_order_acquire) ) continue;
+
+        std::string stack;
+        if ( 0 == s.coroutine) stack = "[thread]";
+        else if ( 0 != s.label) stack = s.label;
+        else stack = "[coroutine]";
+        if ( by_coroutine && 0 != s.coroutine)
+        {
+            char buf[32];
+            std::sprintf( buf, " %p", s.coroutine);
+            stack += buf;
+        }
+        // outermost frame first; return addresses point behind the call
+        for ( std::size_t j = s.depth; 0 < j--;)
+        {
+            void const* pc = 0 == j ? s.pcs[j] : static_cast< char const* >( s.pcs[j]) - 1;
+            std::map< void const*, std::string >::iterator it = symbols.find( pc);
+            if ( symbols.end() == it)
+                it = symbols.insert( std::make_pair( pc, detail::symbol_name( pc) ) ).first;
+            stack += ';';
+            stack += it->second;
+        }
+        ++stacks[stack];
+    }
+    for ( std::map< std::string, std::size_t >::const_iterator it = stacks.begin(); it != stacks.end(); ++it)
+        os << it->first << ' ' << it->second << '\n';
+    os.flush();
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
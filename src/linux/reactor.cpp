@@ -0,0 +1,571 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/reactor.hpp"
+
+#include <climits>
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/detail/syscall.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+namespace {
+
+// events fetched by one call of epoll_wait()
+const int max_events = 256;
+
+void throw_on_error( system::error_code const& ec, char const* what)
+{
+    if ( ec) boost::throw_exception( system::system_error( ec, what) );
+}
+
+}
+
+reactor::reactor( scheduler & sched) :
+    sched_( & sched),
+    epfd_( ::epoll_create1( EPOLL_CLOEXEC) ),
+    evfd_( -1),
+    descriptors_(),
+    waiting_( 0)
+{
+    if ( -1 == epfd_)
+        boost::throw_exception(
+            system::system_error(
+                system::error_code( errno, system::system_category() ),
+                "epoll_create1") );
+    evfd_ = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    ev.data.fd = evfd_;
+    if ( -1 == evfd_ || -1 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, evfd_, & ev) )
+    {
+        int err = errno;
+        if ( -1 != evfd_) ::close( evfd_);
+        ::close( epfd_);
+        boost::throw_exception(
+            system::system_error(
+                system::error_code( err, system::system_category() ),
+                "eventfd") );
+    }
+    sched_->poller( this);
+}
+
+reactor::~reactor()
+{
+    for ( std::size_t fd = 0; fd < descriptors_.size(); ++fd)
+    {
+        detail::task_base * reader = descriptors_[fd].reader;
+        detail::task_base * writer = descriptors_[fd].writer;
+        descriptors_[fd].reader = descriptors_[fd].writer = 0;
+        if ( 0 != reader)
+        {
+            --waiting_;
+            sched_->unwind_( reader);
+        }
+        if ( 0 != writer)
+        {
+            --waiting_;
+            sched_->unwind_( writer);
+        }
+    }
+    BOOST_ASSERT( 0 == waiting_);
+    sched_->poller( 0);
+    ::close( evfd_);
+    ::close( epfd_);
+}
+
+void
+reactor::add( int fd, system::error_code & ec)
+{
+    BOOST_ASSERT( 0 <= fd);
+
+    int flags = ::fcntl( fd, F_GETFL, 0);
+    if ( -1 == flags || -1 == ::fcntl( fd, F_SETFL, flags | O_NONBLOCK) )
+    {
+        ec.assign( errno, system::system_category() );
+        return;
+    }
+    // registered once for both directions - with edge-triggered
+    // notification no re-arming is required after an event
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = 0;
+    ev.data.fd = fd;
+    if ( -1 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, & ev) )
+    {
+        ec.assign( errno, system::system_category() );
+        return;
+    }
+    if ( descriptors_.size() <= static_cast< std::size_t >( fd) )
+        descriptors_.resize( fd + 1);
+    descriptors_[fd].registered = true;
+    ec.clear();
+}
+
+void
+reactor::add( int fd)
+{
+    system::error_code ec;
+    add( fd, ec);
+    throw_on_error( ec, "add");
+}
+
+void
+reactor::remove( int fd) BOOST_NOEXCEPT
+{
+    if ( descriptors_.size() <= static_cast< std::size_t >( fd) ) return;
+    descriptor & d = descriptors_[fd];
+    if ( ! d.registered) return;
+    ::epoll_ctl( epfd_, EPOLL_CTL_DEL, fd, 0);
+    d.registered = false;
+    wake_( d.reader);
+    wake_( d.writer);
+}
+
+void
+reactor::wake_( detail::task_base * & t) BOOST_NOEXCEPT
+{
+    if ( 0 == t) return;
+    sched_->schedule( t);
+    t = 0;
+    --waiting_;
+}
+
+void
+reactor::expired_( detail::timer_node * n) BOOST_NOEXCEPT
+{
+    timer_t * t = static_cast< timer_t * >( n);
+    detail::task_base * & waiter = t->r->descriptors_[t->fd].*t->waiter;
+    // the task might have been woken by an event already
+    if ( t->task != waiter) return;
+    t->expired = true;
+    t->r->wake_( waiter);
+}
+
+bool
+reactor::wait_( int fd, detail::task_base * descriptor::* waiter,
+                clock_type::time_point const& deadline, system::error_code & ec)
+{
+    if ( descriptors_.size() <= static_cast< std::size_t >( fd) ||
+         ! descriptors_[fd].registered)
+    {
+        ec.assign( EBADF, system::system_category() );
+        return false;
+    }
+    detail::task_base * self = sched_->active();
+    BOOST_ASSERT( 0 != self);
+    BOOST_ASSERT_MSG( 0 == descriptors_[fd].*waiter, "concurrent operations on descriptor");
+
+    bool timed = clock_type::time_point::max() != deadline;
+    if ( timed && deadline <= clock_type::now() )
+    {
+        ec.assign( ETIMEDOUT, system::system_category() );
+        return false;
+    }
+    timer_t timer( deadline, this, fd, self, waiter);
+    if ( timed) sched_->add_timer( & timer);
+    descriptors_[fd].*waiter = self;
+    ++waiting_;
+    try
+    { sched_->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        sched_->cancel_timer( & timer);
+        // descriptors_ might have been reallocated meanwhile
+        descriptor & d = descriptors_[fd];
+        if ( self == d.*waiter)
+        {
+            d.*waiter = 0;
+            --waiting_;
+        }
+        throw;
+    }
+    sched_->cancel_timer( & timer);
+    if ( timer.expired)
+    {
+        ec.assign( ETIMEDOUT, system::system_category() );
+        return false;
+    }
+    if ( ! descriptors_[fd].registered)
+    {
+        ec.assign( ECANCELED, system::system_category() );
+        return false;
+    }
+    return true;
+}
+
+std::size_t
+reactor::async_read( int fd, void * buf, std::size_t size, system::error_code & ec)
+{ return async_read( fd, buf, size, clock_type::time_point::max(), ec); }
+
+std::size_t
+reactor::async_read( int fd, void * buf, std::size_t size,
+                     clock_type::time_point const& deadline, system::error_code & ec)
+{
+    for (;;)
+    {
+        ssize_t n = detail::sys_read( fd, buf, size);
+        if ( 0 <= n)
+        {
+            ec.clear();
+            return static_cast< std::size_t >( n);
+        }
+        if ( EINTR == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            return 0;
+        }
+        if ( ! wait_( fd, & descriptor::reader, deadline, ec) ) return 0;
+    }
+}
+
+std::size_t
+reactor::async_read( int fd, void * buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_read( fd, buf, size, ec);
+    throw_on_error( ec, "async_read");
+    return n;
+}
+
+std::size_t
+reactor::async_write( int fd, void const* buf, std::size_t size, system::error_code & ec)
+{ return async_write( fd, buf, size, clock_type::time_point::max(), ec); }
+
+std::size_t
+reactor::async_write( int fd, void const* buf, std::size_t size,
+                      clock_type::time_point const& deadline, system::error_code & ec)
+{
+    char const* p = static_cast< char const* >( buf);
+    std::size_t written = 0;
+    ec.clear();
+    while ( written < size)
+    {
+        ssize_t n = detail::sys_write( fd, p + written, size - written);
+        if ( 0 <= n)
+        {
+            written += static_cast< std::size_t >( n);
+            continue;
+        }
+        if ( EINTR == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            break;
+        }
+        if ( ! wait_( fd, & descriptor::writer, deadline, ec) ) break;
+    }
+    return written;
+}
+
+std::size_t
+reactor::async_write( int fd, void const* buf, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_write( fd, buf, size, ec);
+    throw_on_error( ec, "async_write");
+    return n;
+}
+
+int
+reactor::async_accept( int fd, system::error_code & ec)
+{ return async_accept( fd, clock_type::time_point::max(), ec); }
+
+int
+reactor::async_accept( int fd, clock_type::time_point const& deadline, system::error_code & ec)
+{
+    for (;;)
+    {
+        int s = ::accept4( fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if ( -1 != s)
+        {
+            add( s, ec);
+            if ( ! ec) return s;
+            ::close( s);
+            return -1;
+        }
+        if ( EINTR == errno || ECONNABORTED == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            return -1;
+        }
+        if ( ! wait_( fd, & descriptor::reader, deadline, ec) ) return -1;
+    }
+}
+
+int
+reactor::async_accept( int fd)
+{
+    system::error_code ec;
+    int s = async_accept( fd, ec);
+    throw_on_error( ec, "async_accept");
+    return s;
+}
+
+void
+reactor::async_connect( int fd, sockaddr const* addr, socklen_t len, system::error_code & ec)
+{ async_connect( fd, addr, len, clock_type::time_point::max(), ec); }
+
+void
+reactor::async_connect( int fd, sockaddr const* addr, socklen_t len,
+                        clock_type::time_point const& deadline, system::error_code & ec)
+{
+    if ( 0 == detail::sys_connect( fd, addr, len) )
+    {
+        ec.clear();
+        return;
+    }
+    if ( EINPROGRESS != errno && EINTR != errno)
+    {
+        ec.assign( errno, system::system_category() );
+        return;
+    }
+    // the connection is established (or failed) as soon
+    // as the socket becomes writable
+    if ( ! wait_( fd, & descriptor::writer, deadline, ec) ) return;
+    int err = 0;
+    socklen_t err_len = sizeof( err);
+    if ( -1 == ::getsockopt( fd, SOL_SOCKET, SO_ERROR, & err, & err_len) )
+        err = errno;
+    ec.assign( err, system::system_category() );
+}
+
+void
+reactor::async_connect( int fd, sockaddr const* addr, socklen_t len)
+{
+    system::error_code ec;
+    async_connect( fd, addr, len, ec);
+    throw_on_error( ec, "async_connect");
+}
+
+bool
+reactor::wait_transfer_( int in_fd, int out_fd,
+                         clock_type::time_point const& deadline, system::error_code & ec)
+{
+    pollfd p[2];
+    p[0].fd = in_fd;
+    p[0].events = POLLIN;
+    p[0].revents = 0;
+    p[1].fd = out_fd;
+    p[1].events = POLLOUT;
+    p[1].revents = 0;
+    if ( -1 == ::poll( p, 2, 0) )
+    {
+        ec.assign( errno, system::system_category() );
+        return false;
+    }
+    // the next edge of the side found not ready ends the wait
+    // (regular files are always ready)
+    if ( 0 == p[0].revents) return wait_( in_fd, & descriptor::reader, deadline, ec);
+    if ( 0 == p[1].revents) return wait_( out_fd, & descriptor::writer, deadline, ec);
+    return true;
+}
+
+std::size_t
+reactor::async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size,
+                         system::error_code & ec)
+{ return async_sendfile( out_fd, in_fd, offset, size, clock_type::time_point::max(), ec); }
+
+std::size_t
+reactor::async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size,
+                         clock_type::time_point const& deadline, system::error_code & ec)
+{
+    off_t off = static_cast< off_t >( offset);
+    std::size_t sent = 0;
+    ec.clear();
+    while ( sent < size)
+    {
+        // advances off
+        ssize_t n = ::sendfile( out_fd, in_fd, & off, size - sent);
+        if ( 0 < n)
+        {
+            sent += static_cast< std::size_t >( n);
+            continue;
+        }
+        // end of file
+        if ( 0 == n) break;
+        if ( EINTR == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            break;
+        }
+        if ( ! wait_( out_fd, & descriptor::writer, deadline, ec) ) break;
+    }
+    return sent;
+}
+
+std::size_t
+reactor::async_sendfile( int out_fd, int in_fd, uint64_t offset, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_sendfile( out_fd, in_fd, offset, size, ec);
+    throw_on_error( ec, "async_sendfile");
+    return n;
+}
+
+std::size_t
+reactor::async_splice( int in_fd, int out_fd, std::size_t size, system::error_code & ec)
+{ return async_splice( in_fd, out_fd, size, clock_type::time_point::max(), ec); }
+
+std::size_t
+reactor::async_splice( int in_fd, int out_fd, std::size_t size,
+                       clock_type::time_point const& deadline, system::error_code & ec)
+{
+    for (;;)
+    {
+        ssize_t n = ::splice( in_fd, 0, out_fd, 0, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if ( 0 <= n)
+        {
+            ec.clear();
+            return static_cast< std::size_t >( n);
+        }
+        if ( EINTR == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            return 0;
+        }
+        if ( ! wait_transfer_( in_fd, out_fd, deadline, ec) ) return 0;
+    }
+}
+
+std::size_t
+reactor::async_splice( int in_fd, int out_fd, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_splice( in_fd, out_fd, size, ec);
+    throw_on_error( ec, "async_splice");
+    return n;
+}
+
+std::size_t
+reactor::async_tee( int in_fd, int out_fd, std::size_t size, system::error_code & ec)
+{ return async_tee( in_fd, out_fd, size, clock_type::time_point::max(), ec); }
+
+std::size_t
+reactor::async_tee( int in_fd, int out_fd, std::size_t size,
+                    clock_type::time_point const& deadline, system::error_code & ec)
+{
+    for (;;)
+    {
+        ssize_t n = ::tee( in_fd, out_fd, size, SPLICE_F_NONBLOCK);
+        if ( 0 <= n)
+        {
+            ec.clear();
+            return static_cast< std::size_t >( n);
+        }
+        if ( EINTR == errno) continue;
+        if ( EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            ec.assign( errno, system::system_category() );
+            return 0;
+        }
+        if ( ! wait_transfer_( in_fd, out_fd, deadline, ec) ) return 0;
+    }
+}
+
+std::size_t
+reactor::async_tee( int in_fd, int out_fd, std::size_t size)
+{
+    system::error_code ec;
+    std::size_t n = async_tee( in_fd, out_fd, size, ec);
+    throw_on_error( ec, "async_tee");
+    return n;
+}
+
+void
+reactor::async_wait_readable( int fd, clock_type::time_point const& deadline, system::error_code & ec)
+{ if ( wait_( fd, & descriptor::reader, deadline, ec) ) ec.clear(); }
+
+void
+reactor::async_wait_writable( int fd, clock_type::time_point const& deadline, system::error_code & ec)
+{ if ( wait_( fd, & descriptor::writer, deadline, ec) ) ec.clear(); }
+
+void
+reactor::poll( detail::clock_type::time_point const* deadline)
+{
+    int timeout = -1;
+    if ( 0 != deadline)
+    {
+        detail::clock_type::time_point now( detail::clock_type::now() );
+        if ( * deadline <= now) timeout = 0;
+        else
+        {
+            // round up - waking before the deadline would spin
+            chrono::microseconds us(
+                chrono::duration_cast< chrono::microseconds >( * deadline - now) );
+            timeout = us.count() / 1000 < INT_MAX
+                ? static_cast< int >( ( us.count() + 999) / 1000)
+                : INT_MAX;
+        }
+    }
+    epoll_event events[max_events];
+    int n = ::epoll_wait( epfd_, events, max_events, timeout);
+    if ( -1 == n)
+    {
+        if ( EINTR == errno) return;
+        boost::throw_exception(
+            system::system_error(
+                system::error_code( errno, system::system_category() ),
+                "epoll_wait") );
+    }
+    for ( int i = 0; i < n; ++i)
+    {
+        if ( evfd_ == events[i].data.fd)
+        {
+            uint64_t value = 0;
+            while ( -1 == detail::sys_read( evfd_, & value, sizeof( value) ) && EINTR == errno)
+                ;
+            continue;
+        }
+        // an event without waiter is dropped: the next operation
+        // on the descriptor tries the syscall first anyway
+        descriptor & d = descriptors_[events[i].data.fd];
+        uint32_t e = events[i].events;
+        if ( 0 != ( e & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR) ) )
+            wake_( d.reader);
+        if ( 0 != ( e & ( EPOLLOUT | EPOLLHUP | EPOLLERR) ) )
+            wake_( d.writer);
+    }
+}
+
+void
+reactor::interrupt() BOOST_NOEXCEPT
+{
+    uint64_t value = 1;
+    while ( -1 == detail::sys_write( evfd_, & value, sizeof( value) ) && EINTR == errno)
+        ;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,118 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/detail/stack_sample.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include <dlfcn.h>
+#include <ucontext.h>
+}
+
+#include <cxxabi.h>
+
+#include <boost/cstdint.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+namespace {
+
+// the frame pointer chain is followed only within [lo, hi) - the part
+// of the coroutine stack above the interrupted stack pointer, always
+// mapped - and only towards the top of the stack
+std::size_t walk_( void const** pcs, std::size_t n, char const* fp, char const* lo, char const* hi)
+{
+    std::size_t depth = 0;
+    while ( depth < n)
+    {
+        if ( fp < lo || fp + 2 * sizeof( void *) > hi) break;
+        if ( 0 != ( reinterpret_cast< uintptr_t >( fp) & ( sizeof( void *) - 1) ) ) break;
+        void * const* frame = reinterpret_cast< void * const* >( fp);
+        if ( 0 == frame[1]) break;
+        pcs[depth++] = frame[1];
+        char const* next = static_cast< char const* >( frame[0]);
+        if ( next <= fp) break;
+        fp = next;
+    }
+    return depth;
+}
+
+}
+
+std::size_t sample_stack( void * ucontext, coroutine_context * ctx,
+                          void const** pcs, std::size_t n) BOOST_NOEXCEPT
+{
+    ucontext_t * uc = static_cast< ucontext_t * >( ucontext);
+    char const* pc = 0, * fp = 0, * sp = 0;
+#if defined(__x86_64__)
+    pc = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_RIP]);
+    fp = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_RBP]);
+    sp = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__i386__)
+    pc = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_EIP]);
+    fp = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_EBP]);
+    sp = reinterpret_cast< char const* >( uc->uc_mcontext.gregs[REG_ESP]);
+#elif defined(__aarch64__)
+    pc = reinterpret_cast< char const* >( uc->uc_mcontext.pc);
+    fp = reinterpret_cast< char const* >( uc->uc_mcontext.regs[29]);
+    sp = reinterpret_cast< char const* >( uc->uc_mcontext.sp);
+#else
+    // frame layout unknown - only the execution context is recorded
+    ( void) uc;
+#endif
+
+    std::size_t depth = 0;
+    if ( 0 != pc && depth < n) pcs[depth++] = pc;
+    if ( 0 != ctx && 0 != ctx->stack_ctx().sp)
+    {
+        char const* top = static_cast< char const* >( ctx->stack_ctx().sp);
+        // a stack pointer outside of the stack: interrupted while switching
+        if ( sp <= top && sp >= top - ctx->stack_ctx().size)
+            depth += walk_( pcs + depth, n - depth, fp, sp, top);
+    }
+    return depth;
+}
+
+std::string symbol_name( void const* pc)
+{
+    char buf[64];
+    Dl_info info;
+    if ( 0 != ::dladdr( const_cast< void * >( pc), & info) )
+    {
+        if ( 0 != info.dli_sname)
+        {
+            int status = 0;
+            char * name = abi::__cxa_demangle( info.dli_sname, 0, 0, & status);
+            std::string s( 0 == status && 0 != name ? name : info.dli_sname);
+            std::free( name);
+            return s;
+        }
+        if ( 0 != info.dli_fname)
+        {
+            char const* file = std::strrchr( info.dli_fname, '/');
+            std::sprintf( buf, "+0x%lx",
+                    static_cast< unsigned long >(
+                        static_cast< char const* >( pc) - static_cast< char const* >( info.dli_fbase) ) );
+            return std::string( 0 != file ? file + 1 : info.dli_fname) + buf;
+        }
+    }
+    std::sprintf( buf, "%p", pc);
+    return buf;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
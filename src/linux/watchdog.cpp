@@ -0,0 +1,226 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/watchdog.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <ostream>
+
+extern "C" {
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/stack_sample.hpp>
+#include <boost/coroutine/detail/watchdog.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// signal sampling the stack of a stalled thread
+#if ! defined(BOOST_COROUTINES_WATCHDOG_SIGNAL)
+# define BOOST_COROUTINES_WATCHDOG_SIGNAL SIGURG
+#endif
+
+// frames recorded per stall
+#if ! defined(BOOST_COROUTINES_WATCHDOG_DEPTH)
+# define BOOST_COROUTINES_WATCHDOG_DEPTH 64
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+atomic< uint64_t > watch_clock( 1);
+atomic< bool > watch_on( false);
+
+}
+
+namespace {
+
+struct watched_thread : public detail::watch_slot
+{
+    pthread_t           thread;
+    watched_thread  *   next;
+    // `resumed` of the last stall reported
+    uint64_t            reported;
+    // written by the signal handler on the stalled thread
+    atomic< bool >      sampled;
+    void const      *   coroutine;
+    char const      *   label;
+    std::size_t         depth;
+    void const      *   pcs[BOOST_COROUTINES_WATCHDOG_DEPTH];
+
+    watched_thread() :
+        detail::watch_slot(), thread( ::pthread_self() ), next( 0),
+        reported( 0), sampled( false), coroutine( 0), label( 0), depth( 0)
+    {}
+};
+
+atomic< watched_thread * > threads_( 0);
+// thread the monitor waits for to be sampled
+atomic< watched_thread * > target_( 0);
+atomic< std::size_t > stalls_( 0);
+atomic< bool > stop_( false);
+thread * monitor_ = 0;
+
+extern "C" void on_sample( int, siginfo_t *, void * uc)
+{
+    watched_thread * t = target_.load( memory_order_acquire);
+    if ( 0 == t || ! ::pthread_equal( t->thread, ::pthread_self() ) ) return;
+    int err = errno;
+    detail::coroutine_context * ctx = detail::coroutine_context::active();
+    t->coroutine = ctx;
+    t->label = 0 != ctx ? ctx->label() : 0;
+    t->depth = detail::sample_stack( uc, ctx, t->pcs, BOOST_COROUTINES_WATCHDOG_DEPTH);
+    t->sampled.store( true, memory_order_release);
+    errno = err;
+}
+
+void write_( coroutine_stall const& stall)
+{
+    char buf[64];
+    std::sprintf( buf, " %p", stall.coroutine);
+    std::cerr << "coroutine stall: "
+              << ( stall.label.empty() ? "[coroutine]" : stall.label.c_str() )
+              << buf << " held its thread for " << stall.held.count() << " ms\n";
+    for ( std::size_t i = 0; i < stall.frames.size(); ++i)
+        std::cerr << "    " << stall.frames[i] << '\n';
+    std::cerr.flush();
+}
+
+void report_( watched_thread * t, uint64_t resumed, uint64_t now, watchdog::stall_handler handler)
+{
+    t->sampled.store( false, memory_order_relaxed);
+    target_.store( t, memory_order_release);
+    if ( 0 == ::pthread_kill( t->thread, BOOST_COROUTINES_WATCHDOG_SIGNAL) )
+        for ( int i = 0; i < 100 && ! t->sampled.load( memory_order_acquire); ++i)
+            this_thread::sleep_for( chrono::milliseconds( 1) );
+    target_.store( 0, memory_order_release);
+    // the coroutine was left meanwhile
+    if ( resumed != t->resumed.load( memory_order_relaxed) ) return;
+
+    coroutine_stall stall;
+    stall.coroutine = 0;
+    stall.held = chrono::milliseconds( now - resumed);
+    if ( t->sampled.load( memory_order_acquire) )
+    {
+        stall.coroutine = t->coroutine;
+        if ( 0 != t->label) stall.label = t->label;
+        // return addresses point behind the call
+        for ( std::size_t i = 0; i < t->depth; ++i)
+            stall.frames.push_back( detail::symbol_name(
+                0 == i ? t->pcs[i] : static_cast< char const* >( t->pcs[i]) - 1) );
+    }
+    stalls_.fetch_add( 1, memory_order_relaxed);
+    if ( 0 != handler) handler( stall);
+    else write_( stall);
+}
+
+void monitor( uint64_t threshold, watchdog::stall_handler handler)
+{
+    uint64_t tick = threshold / 4;
+    if ( 0 == tick) tick = 1;
+    // continues where the last run stopped, `resumed` stays comparable
+    uint64_t base = detail::watch_clock.load( memory_order_relaxed);
+    chrono::steady_clock::time_point start( chrono::steady_clock::now() );
+    while ( ! stop_.load( memory_order_relaxed) )
+    {
+        this_thread::sleep_for( chrono::milliseconds( tick) );
+        uint64_t now = base + chrono::duration_cast< chrono::milliseconds >(
+                chrono::steady_clock::now() - start).count();
+        detail::watch_clock.store( now, memory_order_relaxed);
+        for ( watched_thread * t = threads_.load( memory_order_acquire); 0 != t; t = t->next)
+        {
+            uint64_t resumed = t->resumed.load( memory_order_relaxed);
+            if ( 0 == resumed || t->reported == resumed || now - resumed < threshold) continue;
+            t->reported = resumed;
+            report_( t, resumed, now, handler);
+        }
+    }
+}
+
+}
+
+namespace detail {
+
+watch_slot * watch_thread() BOOST_NOEXCEPT
+{
+    watched_thread * t = new ( std::nothrow) watched_thread();
+    if ( 0 == t) return 0;
+    watched_thread * head = threads_.load( memory_order_relaxed);
+    do
+    { t->next = head; }
+    while ( ! threads_.compare_exchange_weak( head, t, memory_order_release, memory_order_relaxed) );
+    return t;
+}
+
+}
+
+namespace watchdog {
+
+void start( chrono::milliseconds threshold, stall_handler handler)
+{
+    BOOST_ASSERT( 0 < threshold.count() );
+    BOOST_ASSERT( 0 == monitor_);
+
+    struct sigaction sa;
+    std::memset( & sa, 0, sizeof( sa) );
+    sa.sa_sigaction = on_sample;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    ::sigemptyset( & sa.sa_mask);
+    if ( 0 != ::sigaction( BOOST_COROUTINES_WATCHDOG_SIGNAL, & sa, 0) )
+        boost::throw_exception(
+            system::system_error(
+                system::error_code( errno, system::system_category() ),
+                "sigaction() failed") );
+
+    stop_.store( false, memory_order_relaxed);
+    monitor_ = new thread( monitor, static_cast< uint64_t >( threshold.count() ), handler);
+    detail::coroutine_context::track_active( true);
+    detail::watch_on.store( true, memory_order_relaxed);
+}
+
+void stop() BOOST_NOEXCEPT
+{
+    if ( 0 == monitor_) return;
+    detail::watch_on.store( false, memory_order_relaxed);
+    stop_.store( true, memory_order_relaxed);
+    try
+    { monitor_->join(); }
+    catch (...)
+    {}
+    delete monitor_;
+    monitor_ = 0;
+    detail::coroutine_context::track_active( false);
+}
+
+bool running() BOOST_NOEXCEPT
+{ return 0 != monitor_; }
+
+std::size_t stalls() BOOST_NOEXCEPT
+{ return stalls_.load( memory_order_relaxed); }
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
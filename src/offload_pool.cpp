@@ -0,0 +1,127 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/offload_pool.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+offload_pool::offload_pool( std::size_t threads) :
+    head_( 0),
+    tail_( 0),
+    stop_( false),
+    mtx_(),
+    cond_(),
+    workers_()
+{
+    BOOST_ASSERT( 0 < threads);
+
+    workers_.reserve( threads);
+    try
+    {
+        for ( std::size_t i = 0; i < threads; ++i)
+            workers_.push_back( new thread( bind( & offload_pool::worker_, this) ) );
+    }
+    catch (...)
+    {
+        join_();
+        throw;
+    }
+}
+
+offload_pool::~offload_pool()
+{ join_(); }
+
+void
+offload_pool::join_()
+{
+    {
+        lock_guard< mutex > lk( mtx_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    for ( std::size_t i = 0; i < workers_.size(); ++i)
+    {
+        workers_[i]->join();
+        delete workers_[i];
+    }
+    workers_.clear();
+    BOOST_ASSERT( 0 == head_);
+}
+
+void
+offload_pool::worker_()
+{
+    for (;;)
+    {
+        detail::offload_job * j = 0;
+        {
+            unique_lock< mutex > lk( mtx_);
+            while ( 0 == head_ && ! stop_)
+                cond_.wait( lk);
+            if ( 0 == head_) return;
+            j = head_;
+            head_ = j->next;
+            if ( 0 == head_) tail_ = 0;
+        }
+        // j is gone as soon as its task has been resumed
+        scheduler * sched = j->sched;
+        detail::task_base * task = j->task;
+        j->run( j);
+        if ( 0 != sched) sched->schedule_remote( task);
+    }
+}
+
+void
+offload_pool::execute_( detail::offload_job * j)
+{
+    scheduler * sched = scheduler::instance();
+    detail::task_base * self = 0 != sched ? sched->active() : 0;
+    if ( 0 == self)
+    {
+        // not called from a task: block the thread
+        j->run( j);
+        return;
+    }
+    BOOST_ASSERT( self->force_unwind() );
+
+    if ( sched->cancellation_requested() ) throw detail::forced_unwind();
+    j->sched = sched;
+    j->task = self;
+    sched->expect_remote();
+    {
+        lock_guard< mutex > lk( mtx_);
+        BOOST_ASSERT( ! stop_);
+        if ( 0 != tail_) tail_->next = j;
+        else head_ = j;
+        tail_ = j;
+    }
+    cond_.notify_one();
+    try
+    { self->suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        // the worker still refers to j
+        sched->join_remote();
+        throw;
+    }
+    if ( sched->cancellation_requested() ) throw detail::forced_unwind();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,288 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/registry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <ostream>
+
+#include <boost/assert.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/registry.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+#if ! defined(BOOST_WINDOWS)
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+}
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+atomic< bool > registry_on( false);
+
+// coroutines created by one thread; destroyed by any thread - the
+// mutex is contended only by snapshots; kept until the process exits
+struct registry_list
+{
+    mutex               mtx;
+    registry_hook   *   head;
+    uint32_t            tid;
+    registry_list   *   next;
+
+    registry_list() :
+        mtx(), head( 0), tid( 0), next( 0)
+    {}
+
+    void push( registry_hook * h) BOOST_NOEXCEPT
+    {
+        lock_guard< mutex > lk( mtx);
+        h->list_ = this;
+        h->prev_ = 0;
+        h->next_ = head;
+        if ( 0 != head) head->prev_ = h;
+        head = h;
+    }
+
+    void erase( registry_hook * h) BOOST_NOEXCEPT
+    {
+        lock_guard< mutex > lk( mtx);
+        if ( 0 != h->prev_) h->prev_->next_ = h->next_;
+        else head = h->next_;
+        if ( 0 != h->next_) h->next_->prev_ = h->prev_;
+        h->next_ = h->prev_ = 0;
+        h->list_ = 0;
+    }
+
+    void append( std::vector< coroutine_info > & v)
+    {
+        lock_guard< mutex > lk( mtx);
+        for ( registry_hook * h = head; 0 != h; h = h->next_)
+        {
+            coroutine_info info;
+            info.kind = static_cast< coroutine_info::kind_t >( h->kind_);
+            int flags = * h->flags_;
+            info.started = 0 != ( flags & flag_started);
+            info.running = 0 != ( flags & flag_running);
+            info.complete = 0 != ( flags & flag_complete);
+            info.thread = tid;
+            info.stack = h->ctx_->stack_ctx().sp;
+            info.stack_size = h->ctx_->stack_ctx().size;
+            info.stack_used = info.started ? h->ctx_->stack_used() : 0;
+            info.created = chrono::steady_clock::time_point( chrono::nanoseconds( h->created_) );
+            if ( 0 != h->ctx_->label() ) info.label = h->ctx_->label();
+            v.push_back( info);
+        }
+    }
+};
+
+}
+
+namespace {
+
+atomic< detail::registry_list * > lists( 0);
+atomic< uint32_t > threads( 0);
+
+BOOST_COROUTINES_THREAD_LOCAL detail::registry_list * thread_list_ = 0;
+
+detail::registry_list * register_() BOOST_NOEXCEPT
+{
+    detail::registry_list * l = new ( std::nothrow) detail::registry_list();
+    if ( 0 == l) return 0;
+    l->tid = threads.fetch_add( 1, memory_order_relaxed) + 1;
+    detail::registry_list * head = lists.load( memory_order_relaxed);
+    do
+    { l->next = head; }
+    while ( ! lists.compare_exchange_weak( head, l, memory_order_release, memory_order_relaxed) );
+    return l;
+}
+
+bool older( coroutine_info const& l, coroutine_info const& r)
+{ return l.created < r.created; }
+
+char const* kind_name( coroutine_info::kind_t kind)
+{
+    switch ( kind)
+    {
+    case coroutine_info::task: return "task";
+    case coroutine_info::pull: return "pull";
+    case coroutine_info::push: return "push";
+    default: return "symmetric";
+    }
+}
+
+char const* state_name( coroutine_info const& info)
+{
+    if ( info.complete) return "complete";
+    if ( info.running) return "running";
+    if ( info.started) return "suspended";
+    return "not started";
+}
+
+#if ! defined(BOOST_WINDOWS)
+int signal_fds[2] = { -1, -1 };
+
+extern "C" void on_signal( int)
+{
+    int err = errno;
+    char c = 0;
+    // a pending wakeup is enough
+    if ( 0 > ::write( signal_fds[1], & c, 1) ) {}
+    errno = err;
+}
+
+void dumper()
+{
+    char c = 0;
+    for (;;)
+    {
+        ssize_t n = ::read( signal_fds[0], & c, 1);
+        if ( 0 > n && EINTR == errno) continue;
+        if ( 1 != n) return;
+        registry::dump( std::cerr);
+    }
+}
+#endif
+
+}
+
+namespace detail {
+
+void
+registry_hook::link_( registry_kind kind, int const* flags) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( 0 == list_);
+
+    registry_list * l = thread_list_;
+    if ( 0 == l)
+    {
+        l = thread_list_ = register_();
+        if ( 0 == l) return;
+    }
+    kind_ = kind;
+    flags_ = flags;
+    created_ = chrono::duration_cast< chrono::nanoseconds >(
+        chrono::steady_clock::now().time_since_epoch() ).count();
+    l->push( this);
+}
+
+void
+registry_hook::unlink_() BOOST_NOEXCEPT
+{ list_->erase( this); }
+
+}
+
+namespace registry {
+
+void enable() BOOST_NOEXCEPT
+{ detail::registry_on.store( true, memory_order_relaxed); }
+
+void disable() BOOST_NOEXCEPT
+{ detail::registry_on.store( false, memory_order_relaxed); }
+
+bool enabled() BOOST_NOEXCEPT
+{ return detail::registry_on.load( memory_order_relaxed); }
+
+std::vector< coroutine_info > snapshot()
+{
+    std::vector< coroutine_info > v;
+    for ( detail::registry_list * l = lists.load( memory_order_acquire); 0 != l; l = l->next)
+        l->append( v);
+    std::stable_sort( v.begin(), v.end(), older);
+    return v;
+}
+
+void dump( std::ostream & os)
+{
+    std::vector< coroutine_info > v( snapshot() );
+    chrono::steady_clock::time_point now( chrono::steady_clock::now() );
+    std::size_t reserved = 0, used = 0;
+    for ( std::size_t i = 0; i < v.size(); ++i)
+    {
+        reserved += v[i].stack_size;
+        used += v[i].stack_used;
+    }
+    os << "live coroutines: " << v.size() << ", stacks: " << reserved
+       << " bytes reserved, " << used << " bytes in use\n";
+    for ( std::size_t i = 0; i < v.size(); ++i)
+    {
+        char buf[160];
+        std::sprintf( buf, "  thread %-3u %-9s %-11s age %10.3f s  stack %8lu / %8lu  ",
+                static_cast< unsigned >( v[i].thread),
+                kind_name( v[i].kind),
+                state_name( v[i]),
+                chrono::duration_cast< chrono::duration< double > >( now - v[i].created).count(),
+                static_cast< unsigned long >( v[i].stack_used),
+                static_cast< unsigned long >( v[i].stack_size) );
+        os << buf << v[i].label << '\n';
+    }
+    os.flush();
+}
+
+#if ! defined(BOOST_WINDOWS)
+void dump_on_signal( int sig)
+{
+    if ( -1 == signal_fds[0])
+    {
+        if ( 0 != ::pipe( signal_fds) )
+            boost::throw_exception(
+                system::system_error(
+                    system::error_code( errno, system::system_category() ),
+                    "pipe() failed") );
+        ::fcntl( signal_fds[1], F_SETFL, O_NONBLOCK);
+        thread( dumper).detach();
+    }
+    struct sigaction sa;
+    std::memset( & sa, 0, sizeof( sa) );
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESTART;
+    ::sigemptyset( & sa.sa_mask);
+    if ( 0 != ::sigaction( sig, & sa, 0) )
+        boost::throw_exception(
+            system::system_error(
+                system::error_code( errno, system::system_category() ),
+                "sigaction() failed") );
+}
+#endif
+
+}
+
+namespace this_coroutine {
+
+void label( char const* label) BOOST_NOEXCEPT
+{
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    BOOST_ASSERT( 0 != sched->active() );
+
+    sched->active()->label( label);
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
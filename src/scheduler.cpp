@@ -0,0 +1,401 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/scheduler.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/detail/trace.hpp>
+#include <boost/coroutine/task_group.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+namespace {
+
+BOOST_COROUTINES_THREAD_LOCAL scheduler * instance_ = 0;
+
+// installs a scheduler as instance of the current thread
+// for the lifetime of the guard
+class instance_guard
+{
+private:
+    scheduler   *   prev_;
+
+public:
+    explicit instance_guard( scheduler * sched) BOOST_NOEXCEPT :
+        prev_( instance_)
+    { instance_ = sched; }
+
+    ~instance_guard() BOOST_NOEXCEPT
+    { instance_ = prev_; }
+};
+
+// deadline of a sleeping task, lives on its stack
+struct sleeper : public detail::timer_node
+{
+    detail::task_base   *   task;
+
+    sleeper( scheduler::clock_type::time_point const& tp, detail::task_base * task_) BOOST_NOEXCEPT :
+        detail::timer_node( tp, & sleeper::expired), task( task_)
+    {}
+
+    static void expired( detail::timer_node * n) BOOST_NOEXCEPT
+    {
+        detail::task_base * t = static_cast< sleeper * >( n)->task;
+        t->owner()->schedule( t);
+    }
+};
+
+}
+
+scheduler::scheduler() :
+    ready_(),
+    timers_(),
+    poller_( 0),
+    active_( 0),
+    live_( 0),
+    size_( 0),
+    remote_(),
+    remote_pending_( 0),
+    remote_producers_( 0),
+    remote_mtx_(),
+    remote_cond_(),
+    remote_poller_( 0)
+{}
+
+scheduler::~scheduler()
+{
+    instance_guard guard( this);
+    // unwind the stacks of all tasks not yet complete; unwinding
+    // might schedule other tasks (e.g. releasing a mutex)
+    while ( 0 != live_)
+        unwind_( live_);
+    BOOST_ASSERT( ready_.empty() );
+    BOOST_ASSERT( 0 == remote_pending_);
+    // a producer might still be inside of schedule_remote()
+    while ( 0 != remote_producers_.load( memory_order_acquire) )
+        this_thread::yield();
+}
+
+scheduler *
+scheduler::instance() BOOST_NOEXCEPT
+{ return instance_; }
+
+void
+scheduler::attach_( detail::task_base * t) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( 0 != t);
+    BOOST_ASSERT( 0 == t->owner() );
+
+    t->owner( this);
+    t->live_prev_ = 0;
+    t->live_next_ = live_;
+    if ( 0 != live_) live_->live_prev_ = t;
+    live_ = t;
+    ++size_;
+    detail::trace( detail::trace_create, t);
+}
+
+void
+scheduler::detach_( detail::task_base * t) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( 0 != t);
+    BOOST_ASSERT( this == t->owner() );
+
+    if ( 0 != t->live_prev_) t->live_prev_->live_next_ = t->live_next_;
+    else live_ = t->live_next_;
+    if ( 0 != t->live_next_) t->live_next_->live_prev_ = t->live_prev_;
+    t->live_next_ = t->live_prev_ = 0;
+    --size_;
+}
+
+void
+scheduler::resume_( detail::task_base * t)
+{
+    BOOST_ASSERT( 0 == active_);
+
+    active_ = t;
+    detail::trace( detail::trace_resume, t);
+    t->resume();
+    active_ = 0;
+    if ( ! t->is_complete() ) detail::trace( detail::trace_suspend, t);
+    else
+    {
+        detail::trace( detail::trace_complete, t);
+        exception_ptr except( t->exception() );
+        task_group * group = t->group_;
+        detach_( t);
+        // the exception of a child is delivered by task_group::wait()
+        if ( 0 != group) group->complete_( t, except);
+        t->destroy();
+        if ( except && 0 == group) rethrow_exception( except);
+    }
+}
+
+void
+scheduler::unwind_( detail::task_base * t) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( 0 != t);
+    BOOST_ASSERT( active_ != t);
+
+    if ( 0 != t->group_) t->group_->unlink_( t);
+    detach_( t);
+    if ( ready_.contains( t) ) ready_.erase( t);
+    // the task is active while its stack is unwound - destructors
+    // might use the synchronization primitives
+    detail::task_base * active = active_;
+    active_ = t;
+    detail::trace( detail::trace_complete, t);
+    t->destroy();
+    active_ = active;
+}
+
+bool
+scheduler::cancelled_() const BOOST_NOEXCEPT
+{ return 0 != active_->group_ && active_->group_->is_cancelled(); }
+
+void
+scheduler::take_remote_() BOOST_NOEXCEPT
+{
+    detail::task_base * t = remote_.take();
+    while ( 0 != t)
+    {
+        detail::task_base * next = t->remote_next_;
+        t->remote_next_ = 0;
+        BOOST_ASSERT( t->remote_wakeup_pending() );
+        t->flags_ &= ~detail::flag_remote_wakeup;
+        --remote_pending_;
+        // a task being unwound waits inside of join_remote()
+        if ( ! t->unwind_requested() ) schedule( t);
+        t = next;
+    }
+}
+
+void
+scheduler::wait_remote_( clock_type::time_point const* deadline)
+{
+    unique_lock< mutex > lk( remote_mtx_);
+    while ( remote_.empty() )
+    {
+        if ( 0 == deadline) remote_cond_.wait( lk);
+        else if ( cv_status::timeout == remote_cond_.wait_until( lk, * deadline) ) return;
+    }
+}
+
+void
+scheduler::poll_( clock_type::time_point const* deadline)
+{
+    if ( 0 == remote_pending_)
+    {
+        poller_->poll( deadline);
+        return;
+    }
+    {
+        lock_guard< mutex > lk( remote_mtx_);
+        if ( ! remote_.empty() ) return;
+        remote_poller_ = poller_;
+    }
+    try
+    { poller_->poll( deadline); }
+    catch (...)
+    {
+        lock_guard< mutex > lk( remote_mtx_);
+        remote_poller_ = 0;
+        throw;
+    }
+    lock_guard< mutex > lk( remote_mtx_);
+    remote_poller_ = 0;
+}
+
+void
+scheduler::poller( detail::poller * p)
+{
+    BOOST_ASSERT( 0 == p || 0 == poller_);
+
+    if ( 0 == p)
+    {
+        // the poller might be destroyed while polling
+        lock_guard< mutex > lk( remote_mtx_);
+        remote_poller_ = 0;
+    }
+    poller_ = p;
+}
+
+void
+scheduler::schedule_remote( detail::task_base * t)
+{
+    BOOST_ASSERT( 0 != t);
+    BOOST_ASSERT( this == t->owner() );
+
+    remote_producers_.fetch_add( 1, memory_order_seq_cst);
+    if ( remote_.push( t) )
+    {
+        // the owner blocks either in the poller or on the condition
+        // variable (join_remote() while polling waits on both)
+        lock_guard< mutex > lk( remote_mtx_);
+        if ( 0 != remote_poller_) remote_poller_->interrupt();
+        remote_cond_.notify_one();
+    }
+    remote_producers_.fetch_sub( 1, memory_order_release);
+}
+
+detail::task_base *
+scheduler::detach( detail::task_queue & waiters) BOOST_NOEXCEPT
+{
+    detail::task_base * head = 0, * tail = 0;
+    while ( ! waiters.empty() )
+    {
+        detail::task_base * t = waiters.pop();
+        BOOST_ASSERT( t->remote_wakeup_pending() );
+        BOOST_ASSERT( 0 == t->remote_next_);
+        if ( 0 != tail) tail->remote_next_ = t;
+        else head = t;
+        tail = t;
+    }
+    return head;
+}
+
+void
+scheduler::wake( detail::task_base * chain)
+{
+    while ( 0 != chain)
+    {
+        detail::task_base * t = chain;
+        // t might complete as soon as it is scheduled
+        chain = t->remote_next_;
+        t->remote_next_ = 0;
+        scheduler * owner = t->owner();
+        if ( instance_ != owner)
+        {
+            owner->schedule_remote( t);
+            continue;
+        }
+        t->flags_ &= ~detail::flag_remote_wakeup;
+        --owner->remote_pending_;
+        // a task being unwound waits inside of join_remote()
+        if ( ! t->unwind_requested() ) owner->schedule( t);
+    }
+}
+
+void
+scheduler::join_remote()
+{
+    BOOST_ASSERT( 0 != active_);
+
+    detail::task_base * self = active_;
+    while ( self->remote_wakeup_pending() )
+    {
+        wait_remote_( 0);
+        take_remote_();
+    }
+}
+
+void
+scheduler::run()
+{
+    BOOST_ASSERT( 0 == active_);
+
+    instance_guard guard( this);
+    for (;;)
+    {
+        if ( 0 < remote_pending_) take_remote_();
+        if ( ! timers_.empty() )
+            timers_.expire( detail::clock_type::now() );
+        // resume only the tasks ready at this point so that expired
+        // deadlines are not starved by tasks yielding in a loop
+        std::size_t n = ready_.size();
+        while ( 0 < n-- && ! ready_.empty() )
+            resume_( ready_.pop() );
+        bool waiting = 0 != poller_ && ! poller_->empty();
+        if ( ! ready_.empty() )
+        {
+            // tasks yielding in a loop must not starve the poller;
+            // the epoch as deadline polls without blocking
+            if ( waiting)
+            {
+                detail::clock_type::time_point epoch;
+                poller_->poll( & epoch);
+            }
+            continue;
+        }
+        if ( waiting)
+        {
+            if ( timers_.empty() ) poll_( 0);
+            else
+            {
+                detail::clock_type::time_point deadline( timers_.deadline() );
+                poll_( & deadline);
+            }
+            continue;
+        }
+        if ( 0 < remote_pending_)
+        {
+            if ( timers_.empty() ) wait_remote_( 0);
+            else
+            {
+                detail::clock_type::time_point deadline( timers_.deadline() );
+                wait_remote_( & deadline);
+            }
+            continue;
+        }
+        if ( timers_.empty() ) break;
+        this_thread::sleep_until( timers_.deadline() );
+    }
+}
+
+void
+scheduler::suspend()
+{
+    BOOST_ASSERT( 0 != active_);
+
+    detail::task_base * self = active_;
+    if ( cancelled_() ) throw detail::forced_unwind();
+    self->suspend();
+    if ( cancelled_() ) throw detail::forced_unwind();
+}
+
+void
+scheduler::yield()
+{
+    BOOST_ASSERT( 0 != active_);
+
+    detail::task_base * self = active_;
+    if ( cancelled_() ) throw detail::forced_unwind();
+    schedule( self);
+    self->suspend();
+    if ( cancelled_() ) throw detail::forced_unwind();
+}
+
+void
+scheduler::sleep_until( clock_type::time_point const& tp)
+{
+    BOOST_ASSERT( 0 != active_);
+
+    if ( cancelled_() ) throw detail::forced_unwind();
+    if ( tp <= clock_type::now() ) return;
+    sleeper s( tp, active_);
+    add_timer( & s);
+    try
+    { suspend(); }
+    catch ( detail::forced_unwind const&)
+    {
+        cancel_timer( & s);
+        throw;
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,104 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/select.hpp"
+
+#include <boost/coroutine/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+void
+select::expired_( detail::timer_node * n) BOOST_NOEXCEPT
+{
+    timer_case * t = static_cast< timer_case * >( n);
+    t->state->fire( t->case_index, channel_op_timeout);
+}
+
+void
+select::cancel_() BOOST_NOEXCEPT
+{
+    scheduler * sched = state_.task->owner();
+    for ( std::size_t i = 0; i < size_; ++i)
+    {
+        case_t & c = cases_[i];
+        if ( 0 == c.try_op) sched->cancel_timer( & c.timer);
+        else if ( c.waiter.is_linked() ) c.list->erase( & c.waiter);
+    }
+}
+
+std::size_t
+select::wait()
+{
+    BOOST_ASSERT( 0 < size_);
+
+    scheduler * sched = scheduler::instance();
+    BOOST_ASSERT( 0 != sched);
+    detail::task_base * self = sched->active();
+    BOOST_ASSERT( 0 != self);
+
+    state_ = detail::select_state( self);
+    // complete a case ready without suspending
+    clock_type::time_point now;
+    bool has_now = false;
+    for ( std::size_t i = 0; i < size_; ++i)
+    {
+        case_t & c = cases_[i];
+        if ( 0 == c.try_op)
+        {
+            if ( ! has_now)
+            {
+                now = clock_type::now();
+                has_now = true;
+            }
+            if ( now < c.timer.deadline) continue;
+            state_.fired = i;
+            state_.status = channel_op_timeout;
+            return i;
+        }
+        channel_op_status st = c.try_op( c.chan, c.waiter.value);
+        if ( channel_op_empty == st || channel_op_full == st) continue;
+        state_.fired = i;
+        state_.status = st;
+        return i;
+    }
+    // link all cases - the first one firing schedules the task
+    try
+    {
+        for ( std::size_t i = 0; i < size_; ++i)
+        {
+            case_t & c = cases_[i];
+            if ( 0 == c.try_op)
+            {
+                c.timer.fn = & select::expired_;
+                c.timer.state = & state_;
+                c.timer.case_index = i;
+                sched->add_timer( & c.timer);
+            }
+            else
+                c.list->push( & c.waiter);
+        }
+        sched->suspend();
+    }
+    catch (...)
+    {
+        // forced_unwind or bad_alloc while linking
+        cancel_();
+        throw;
+    }
+    cancel_();
+    BOOST_ASSERT( state_.is_fired() );
+    return state_.fired;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,158 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/task_group.hpp"
+
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+task_group::task_group( scheduler & sched) :
+    sched_( & sched),
+    children_( 0),
+    size_( 0),
+    cancelled_( false),
+    except_(),
+    waiters_(),
+    timer_( this)
+{}
+
+task_group::task_group() :
+    sched_( scheduler::instance() ),
+    children_( 0),
+    size_( 0),
+    cancelled_( false),
+    except_(),
+    waiters_(),
+    timer_( this)
+{ BOOST_ASSERT( 0 != sched_); }
+
+task_group::~task_group()
+{
+    // a group going out of scope (e.g. its owner failed)
+    // takes its children with it
+    cancel();
+    BOOST_ASSERT( 0 == size_);
+    BOOST_ASSERT( waiters_.empty() );
+}
+
+void
+task_group::expired_( detail::timer_node * n) BOOST_NOEXCEPT
+{ static_cast< timer_t * >( n)->group->cancel(); }
+
+void
+task_group::link_( detail::task_base * t) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( 0 == t->group_);
+
+    t->group_ = this;
+    t->group_prev_ = 0;
+    t->group_next_ = children_;
+    if ( 0 != children_) children_->group_prev_ = t;
+    children_ = t;
+    ++size_;
+}
+
+void
+task_group::unlink_( detail::task_base * t) BOOST_NOEXCEPT
+{
+    BOOST_ASSERT( this == t->group_);
+
+    if ( 0 != t->group_prev_) t->group_prev_->group_next_ = t->group_next_;
+    else children_ = t->group_next_;
+    if ( 0 != t->group_next_) t->group_next_->group_prev_ = t->group_prev_;
+    t->group_next_ = t->group_prev_ = 0;
+    t->group_ = 0;
+    --size_;
+    if ( 0 == size_) wake_();
+}
+
+void
+task_group::complete_( detail::task_base * t, exception_ptr const& except) BOOST_NOEXCEPT
+{
+    unlink_( t);
+    if ( except && ! except_)
+    {
+        // fail fast: the siblings are of no use anymore
+        except_ = except;
+        cancel();
+    }
+}
+
+void
+task_group::wake_() BOOST_NOEXCEPT
+{
+    sched_->cancel_timer( & timer_);
+    while ( ! waiters_.empty() )
+    {
+        detail::task_base * t = waiters_.pop();
+        t->owner()->schedule( t);
+    }
+}
+
+void
+task_group::wait()
+{
+    while ( 0 < size_)
+    {
+        detail::task_base * self = sched_->active();
+        BOOST_ASSERT( 0 != self);
+        BOOST_ASSERT_MSG( this != self->group_, "child waits for its own group");
+
+        waiters_.push( self);
+        try
+        { sched_->suspend(); }
+        catch ( detail::forced_unwind const&)
+        {
+            if ( waiters_.contains( self) ) waiters_.erase( self);
+            throw;
+        }
+    }
+    if ( except_)
+    {
+        exception_ptr except( except_);
+        except_ = exception_ptr();
+        rethrow_exception( except);
+    }
+}
+
+void
+task_group::cancel() BOOST_NOEXCEPT
+{
+    cancelled_ = true;
+    sched_->cancel_timer( & timer_);
+    // a child cancelling its own group keeps running until
+    // its next suspension point
+    detail::task_base * active = sched_->active();
+    for (;;)
+    {
+        detail::task_base * t = children_;
+        if ( 0 != t && active == t) t = t->group_next_;
+        if ( 0 == t) break;
+        unlink_( t);
+        sched_->unwind_( t);
+    }
+}
+
+void
+task_group::cancel_at( clock_type::time_point const& tp)
+{
+    if ( cancelled_) return;
+    sched_->cancel_timer( & timer_);
+    timer_.deadline = tp;
+    timer_.fn = & task_group::expired_;
+    sched_->add_timer( & timer_);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
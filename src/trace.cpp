@@ -0,0 +1,207 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/coroutine/trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <new>
+#include <ostream>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/static_assert.hpp>
+
+#include <boost/coroutine/detail/trace.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// records per thread (power of two)
+#if ! defined(BOOST_COROUTINES_TRACE_RECORDS)
+# define BOOST_COROUTINES_TRACE_RECORDS 16384
+#endif
+
+namespace boost {
+namespace coroutines {
+
+namespace {
+
+BOOST_STATIC_ASSERT( 0 == ( BOOST_COROUTINES_TRACE_RECORDS & ( BOOST_COROUTINES_TRACE_RECORDS - 1) ) );
+
+const uint64_t records = BOOST_COROUTINES_TRACE_RECORDS;
+
+// single-producer ring buffer of one thread; the records of
+// terminated threads are kept until the process exits
+struct trace_buffer
+{
+    atomic< uint64_t >      head;
+    // first record not discarded by clear()
+    atomic< uint64_t >      tail;
+    uint32_t                tid;
+    trace_buffer        *   next;
+    detail::trace_record    records[BOOST_COROUTINES_TRACE_RECORDS];
+
+    trace_buffer() :
+        head( 0), tail( 0), tid( 0), next( 0)
+    {}
+};
+
+atomic< trace_buffer * > buffers( 0);
+atomic< uint32_t > threads( 0);
+
+BOOST_COROUTINES_THREAD_LOCAL trace_buffer * buffer_ = 0;
+
+trace_buffer * register_() BOOST_NOEXCEPT
+{
+    trace_buffer * b = new ( std::nothrow) trace_buffer();
+    if ( 0 == b) return 0;
+    b->tid = threads.fetch_add( 1, memory_order_relaxed) + 1;
+    trace_buffer * head = buffers.load( memory_order_relaxed);
+    do
+    { b->next = head; }
+    while ( ! buffers.compare_exchange_weak( head, b, memory_order_release, memory_order_relaxed) );
+    return b;
+}
+
+// copies the records of a buffer not overwritten meanwhile
+void copy_( trace_buffer * b, std::vector< detail::trace_record > & v)
+{
+    uint64_t head = b->head.load( memory_order_acquire);
+    uint64_t first = head > records ? head - records : 0;
+    uint64_t tail = b->tail.load( memory_order_relaxed);
+    if ( first < tail) first = tail;
+    v.clear();
+    for ( uint64_t i = first; i < head; ++i)
+        v.push_back( b->records[i & ( records - 1)]);
+    atomic_thread_fence( memory_order_acquire);
+    uint64_t after = b->head.load( memory_order_relaxed);
+    uint64_t valid = after > records ? after - records : 0;
+    if ( first < valid)
+        v.erase( v.begin(), v.begin() + static_cast< std::size_t >( std::min( valid, head) - first) );
+}
+
+void write_ts_( std::ostream & os, uint64_t ns)
+{
+    char buf[32];
+    std::sprintf( buf, "%llu.%03u",
+            static_cast< unsigned long long >( ns / 1000),
+            static_cast< unsigned >( ns % 1000) );
+    os << buf;
+}
+
+void write_task_( std::ostream & os, void const* task)
+{
+    char buf[32];
+    std::sprintf( buf, "%p", task);
+    os << buf;
+}
+
+}
+
+namespace detail {
+
+atomic< bool > trace_on( false);
+
+void trace_append( trace_event e, void const* task) BOOST_NOEXCEPT
+{
+    trace_buffer * b = buffer_;
+    if ( 0 == b)
+    {
+        b = buffer_ = register_();
+        if ( 0 == b) return;
+    }
+    uint64_t i = b->head.load( memory_order_relaxed);
+    trace_record & r = b->records[i & ( records - 1)];
+    r.ts = chrono::duration_cast< chrono::nanoseconds >(
+        chrono::steady_clock::now().time_since_epoch() ).count();
+    r.task = task;
+    r.event = e;
+    b->head.store( i + 1, memory_order_release);
+}
+
+}
+
+namespace trace {
+
+void start() BOOST_NOEXCEPT
+{ detail::trace_on.store( true, memory_order_relaxed); }
+
+void stop() BOOST_NOEXCEPT
+{ detail::trace_on.store( false, memory_order_relaxed); }
+
+bool enabled() BOOST_NOEXCEPT
+{ return detail::trace_on.load( memory_order_relaxed); }
+
+void clear() BOOST_NOEXCEPT
+{
+    for ( trace_buffer * b = buffers.load( memory_order_acquire); 0 != b; b = b->next)
+        b->tail.store( b->head.load( memory_order_acquire), memory_order_relaxed);
+}
+
+void write_chrome_json( std::ostream & os)
+{
+    std::vector< std::vector< detail::trace_record > > v;
+    std::vector< uint32_t > tids;
+    uint64_t base = 0;
+    for ( trace_buffer * b = buffers.load( memory_order_acquire); 0 != b; b = b->next)
+    {
+        v.push_back( std::vector< detail::trace_record >() );
+        tids.push_back( b->tid);
+        copy_( b, v.back() );
+        if ( ! v.back().empty() && ( 0 == base || v.back().front().ts < base) )
+            base = v.back().front().ts;
+    }
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for ( std::size_t i = 0; i < v.size(); ++i)
+    {
+        os << ( first ? "\n" : ",\n")
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tids[i]
+           << ",\"args\":{\"name\":\"thread " << tids[i] << "\"}}";
+        first = false;
+        // a resumption becomes one slice, ended by suspend or complete
+        detail::trace_record const* resumed = 0;
+        for ( std::size_t j = 0; j < v[i].size(); ++j)
+        {
+            detail::trace_record const& r = v[i][j];
+            if ( detail::trace_resume == r.event)
+            {
+                resumed = & r;
+                continue;
+            }
+            if ( 0 != resumed && resumed->task == r.task)
+            {
+                os << ",\n{\"name\":\"task ";
+                write_task_( os, r.task);
+                os << "\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tids[i] << ",\"ts\":";
+                write_ts_( os, resumed->ts - base);
+                os << ",\"dur\":";
+                write_ts_( os, r.ts - resumed->ts);
+                os << "}";
+            }
+            resumed = 0;
+            if ( detail::trace_suspend == r.event) continue;
+            os << ",\n{\"name\":\"" << ( detail::trace_create == r.event ? "create" : "complete")
+               << "\",\"cat\":\"task\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":" << tids[i] << ",\"ts\":";
+            write_ts_( os, r.ts - base);
+            os << ",\"args\":{\"task\":\"";
+            write_task_( os, r.task);
+            os << "\"}}";
+        }
+    }
+    os << "\n]}\n";
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
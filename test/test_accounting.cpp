@@ -0,0 +1,116 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#if ! defined(BOOST_COROUTINES_ACCOUNTING)
+# define BOOST_COROUTINES_ACCOUNTING
+#endif
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+
+namespace coro = boost::coroutines;
+
+coro::symmetric_coroutine< void >::call_type * other = 0;
+volatile boost::uint64_t sink = 0;
+
+void spin( int n)
+{
+    for ( int i = 0; i < n; ++i)
+        sink = sink + i;
+}
+
+void f1( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    for ( int i = 0; i < 3; ++i)
+        c( i);
+}
+
+void f2( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    spin( 1000000);
+    c();
+}
+
+void f3( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    spin( 1000);
+    c();
+}
+
+void f4( coro::asymmetric_coroutine< int >::pull_type & c)
+{
+    while ( c) c();
+}
+
+void f5( coro::symmetric_coroutine< void >::yield_type & yield)
+{
+    spin( 1000000);
+    // the other coroutine is accounted separately
+    yield( * other);
+}
+
+void f6( coro::symmetric_coroutine< void >::yield_type &)
+{ spin( 1000); }
+
+void test_pull()
+{
+    coro::asymmetric_coroutine< int >::pull_type c( f1);
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 1, c.resumes() );
+    while ( c) c();
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 4, c.resumes() );
+    BOOST_CHECK( 0 < c.cpu_ticks() );
+
+    coro::asymmetric_coroutine< int >::pull_type empty;
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 0, empty.resumes() );
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 0, empty.cpu_ticks() );
+}
+
+void test_push()
+{
+    coro::asymmetric_coroutine< int >::push_type c( f4);
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 0, c.resumes() );
+    c( 1);
+    c( 2);
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 2, c.resumes() );
+}
+
+void test_ticks()
+{
+    coro::asymmetric_coroutine< void >::pull_type c1( f2);
+    coro::asymmetric_coroutine< void >::pull_type c2( f3);
+    c1();
+    c2();
+    BOOST_CHECK( c2.cpu_ticks() < c1.cpu_ticks() );
+}
+
+void test_symmetric()
+{
+    coro::symmetric_coroutine< void >::call_type c1( f5);
+    coro::symmetric_coroutine< void >::call_type c2( f6);
+    other = & c2;
+    c1();
+    // c2 returns to the caller of c1
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 1, c1.resumes() );
+    BOOST_CHECK_EQUAL( ( boost::uint64_t) 1, c2.resumes() );
+    BOOST_CHECK( c2.cpu_ticks() < c1.cpu_ticks() );
+    other = 0;
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: accounting test suite");
+
+    test->add( BOOST_TEST_CASE( & test_pull) );
+    test->add( BOOST_TEST_CASE( & test_push) );
+    test->add( BOOST_TEST_CASE( & test_ticks) );
+    test->add( BOOST_TEST_CASE( & test_symmetric) );
+
+    return test;
+}
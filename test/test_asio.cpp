@@ -0,0 +1,222 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asio.hpp>
+#include <boost/coroutine/pooled_stack_allocator.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+
+namespace coro = boost::coroutines;
+namespace asio = boost::asio;
+
+typedef coro::symmetric_coroutine< void >   symmetric_t;
+
+int value1 = 0;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void f1( asio::io_context & ioc, std::vector< int > & v, int id, int ms, coro::yield_context yield)
+{
+    asio::steady_timer t( ioc, std::chrono::milliseconds( ms) );
+    t.async_wait( yield);
+    v.push_back( id);
+}
+
+void f2( asio::io_context & ioc, boost::system::error_code & ec, bool & thrown,
+         coro::yield_context yield)
+{
+    asio::steady_timer t( ioc, std::chrono::hours( 1) );
+    asio::steady_timer c( ioc, std::chrono::milliseconds( 1) );
+    c.async_wait( boost::bind( & asio::steady_timer::cancel, & t) );
+    t.async_wait( yield[ec]);
+    t.expires_after( std::chrono::hours( 1) );
+    c.expires_after( std::chrono::milliseconds( 1) );
+    c.async_wait( boost::bind( & asio::steady_timer::cancel, & t) );
+    try
+    { t.async_wait( yield); }
+    catch ( boost::system::system_error const& e)
+    { thrown = asio::error::operation_aborted == e.code(); }
+}
+
+void f3( asio::local::stream_protocol::socket & s, coro::yield_context yield)
+{
+    asio::async_write( s, asio::buffer( "abc", 3), yield);
+    s.shutdown( asio::socket_base::shutdown_send);
+}
+
+void f4( asio::local::stream_protocol::socket & s, std::string & str, coro::yield_context yield)
+{
+    char buf[16];
+    boost::system::error_code ec;
+    for (;;)
+    {
+        std::size_t n = s.async_read_some( asio::buffer( buf), yield[ec]);
+        if ( ec) break;
+        str.append( buf, n);
+    }
+    BOOST_CHECK( asio::error::eof == ec);
+}
+
+void f5( asio::io_context & ioc, coro::yield_context yield)
+{
+    asio::steady_timer t( ioc, std::chrono::milliseconds( 1) );
+    t.async_wait( yield);
+    throw std::runtime_error("abc");
+}
+
+void f6( asio::io_context & ioc, coro::yield_context yield)
+{
+    X x;
+    asio::steady_timer t( ioc, std::chrono::hours( 1) );
+    t.async_wait( yield);
+}
+
+void f7( asio::io_context & ioc, symmetric_t::call_type *& self, int & n,
+         symmetric_t::yield_type & yield)
+{
+    coro::yield_context yc( yield, * self);
+    asio::steady_timer t( ioc, std::chrono::milliseconds( 1) );
+    for ( ; n < 3; ++n)
+    {
+        t.expires_after( std::chrono::milliseconds( 1) );
+        t.async_wait( yc);
+    }
+}
+
+void test_timer()
+{
+    std::vector< int > v;
+    asio::io_context ioc;
+    coro::spawn( boost::bind( f1, boost::ref( ioc), boost::ref( v), 0, 30, _1) );
+    coro::spawn( boost::bind( f1, boost::ref( ioc), boost::ref( v), 1, 10, _1) );
+    coro::spawn( boost::bind( f1, boost::ref( ioc), boost::ref( v), 2, 20, _1) );
+    // the coroutines are suspended in async_wait()
+    BOOST_CHECK( v.empty() );
+    ioc.run();
+    int expected[] = { 1, 2, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_error_code()
+{
+    boost::system::error_code ec;
+    bool thrown = false;
+    asio::io_context ioc;
+    coro::spawn( boost::bind( f2, boost::ref( ioc), boost::ref( ec), boost::ref( thrown), _1) );
+    ioc.run();
+    BOOST_CHECK( asio::error::operation_aborted == ec);
+    BOOST_CHECK( thrown);
+}
+
+void test_socket()
+{
+    std::string str;
+    asio::io_context ioc;
+    asio::local::stream_protocol::socket s1( ioc), s2( ioc);
+    asio::local::connect_pair( s1, s2);
+    coro::spawn( boost::bind( f4, boost::ref( s2), boost::ref( str), _1) );
+    coro::spawn( boost::bind( f3, boost::ref( s1), _1) );
+    ioc.run();
+    BOOST_CHECK_EQUAL( std::string("abc"), str);
+}
+
+void test_exception()
+{
+    asio::io_context ioc;
+    coro::spawn( boost::bind( f5, boost::ref( ioc), _1) );
+    bool thrown = false;
+    // re-thrown by the handler resuming the coroutine
+    try
+    { ioc.run(); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    BOOST_CHECK( thrown);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    {
+        asio::io_context ioc;
+        coro::spawn( boost::bind( f6, boost::ref( ioc), _1) );
+        BOOST_CHECK_EQUAL( ( int) 7, value1);
+    }
+    // destroying the pending handler unwinds the coroutine
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+}
+
+void test_symmetric()
+{
+    int n = 0;
+    asio::io_context ioc;
+    symmetric_t::call_type * self = 0;
+    symmetric_t::call_type c(
+        boost::bind( f7, boost::ref( ioc), boost::ref( self), boost::ref( n), _1) );
+    self = & c;
+    c();
+    BOOST_CHECK_EQUAL( ( int) 0, n);
+    ioc.run();
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+    BOOST_CHECK( ! c);
+}
+
+void test_pooled_stack_allocator()
+{
+    std::vector< int > v;
+    coro::pooled_stack_allocator alloc;
+    asio::io_context ioc;
+    for ( int i = 0; i < 3; ++i)
+        coro::spawn( boost::bind( f1, boost::ref( ioc), boost::ref( v), i, 1, _1),
+                     coro::attributes(), alloc);
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, alloc.cached() );
+    ioc.run();
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, alloc.cached() );
+    ioc.restart();
+    // the stacks are reused
+    for ( int i = 0; i < 2; ++i)
+        coro::spawn( boost::bind( f1, boost::ref( ioc), boost::ref( v), i, 1, _1),
+                     coro::attributes(), alloc);
+    BOOST_CHECK_EQUAL( ( std::size_t) 1, alloc.cached() );
+    ioc.run();
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, alloc.cached() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 5, v.size() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: asio test suite");
+
+    test->add( BOOST_TEST_CASE( & test_timer) );
+    test->add( BOOST_TEST_CASE( & test_error_code) );
+    test->add( BOOST_TEST_CASE( & test_socket) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+    test->add( BOOST_TEST_CASE( & test_symmetric) );
+    test->add( BOOST_TEST_CASE( & test_pooled_stack_allocator) );
+
+    return test;
+}
@@ -0,0 +1,267 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_THREAD_VERSION 4
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/future.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/await.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/task_group.hpp>
+
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+extern "C" {
+#include <unistd.h>
+}
+
+#include <boost/coroutine/io_engine.hpp>
+#include <boost/coroutine/reactor.hpp>
+#endif
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+int value2 = 0;
+bool value3 = false;
+boost::thread::id value4;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void set_later( boost::promise< int > & p, int i)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    p.set_value( i);
+}
+
+void fail_later( boost::promise< int > & p)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    p.set_exception( std::runtime_error("abc") );
+}
+
+void set_all( std::vector< boost::promise< int > > & v)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    for ( std::size_t i = 0; i < v.size(); ++i)
+        v[i].set_value( static_cast< int >( i) );
+}
+
+void f1( boost::future< int > & f)
+{
+    value1 = coro::this_coroutine::await( f);
+    value4 = boost::this_thread::get_id();
+}
+
+void f2( int & n)
+{
+    // keeps running while the other task awaits
+    for ( int i = 0; i < 3; ++i)
+    {
+        ++n;
+        coro::this_coroutine::yield();
+    }
+}
+
+void f3( boost::future< int > & f)
+{
+    try
+    { coro::this_coroutine::await( f); }
+    catch ( std::runtime_error const&)
+    { value3 = true; }
+}
+
+void f4( boost::promise< int > & p)
+{
+    boost::future< int > f( p.get_future() );
+    value2 += coro::this_coroutine::await( f);
+}
+
+void f5( boost::future< int > & f)
+{
+    X x;
+    coro::this_coroutine::await( f);
+    value2 = 1;
+}
+
+void f6( boost::future< int > & f)
+{
+    coro::task_group g;
+    g.spawn( boost::bind( f5, boost::ref( f) ) );
+    g.cancel_after( boost::chrono::milliseconds( 1) );
+    g.wait();
+}
+
+void test_ready()
+{
+    value1 = 0;
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    p.set_value( 3);
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f1, boost::ref( f) ) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( int) 3, value1);
+}
+
+void test_remote()
+{
+    value1 = 0;
+    int n = 0;
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f1, boost::ref( f) ) );
+    sched.spawn( boost::bind( f2, boost::ref( n) ) );
+    boost::thread t( set_later, boost::ref( p), 5);
+    // returns not before the awaiting task is complete
+    sched.run();
+    t.join();
+    BOOST_CHECK_EQUAL( ( int) 5, value1);
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+    // resumed on the thread of its scheduler
+    BOOST_CHECK( boost::this_thread::get_id() == value4);
+}
+
+void test_exception()
+{
+    value3 = false;
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f3, boost::ref( f) ) );
+    boost::thread t( fail_later, boost::ref( p) );
+    sched.run();
+    t.join();
+    BOOST_CHECK( value3);
+}
+
+void test_many()
+{
+    value2 = 0;
+    std::vector< boost::promise< int > > v( 100);
+    coro::scheduler sched;
+    for ( std::size_t i = 0; i < v.size(); ++i)
+        sched.spawn( boost::bind( f4, boost::ref( v[i]) ) );
+    boost::thread t( set_all, boost::ref( v) );
+    sched.run();
+    t.join();
+    BOOST_CHECK_EQUAL( ( int) 4950, value2);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    value2 = 0;
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f6, boost::ref( f) ) );
+    boost::thread t( set_later, boost::ref( p), 5);
+    // the cancelled task waits for the continuation before its
+    // stack is unwound
+    sched.run();
+    t.join();
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK_EQUAL( ( int) 0, value2);
+}
+
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+void f7( coro::reactor & r, int fd)
+{
+    char c = 0;
+    r.async_read( fd, & c, 1);
+    value2 = c;
+}
+
+void f9( coro::io_engine & e, int fd)
+{
+    char c = 0;
+    e.async_read( fd, & c, 1);
+    value2 = c;
+}
+
+void f8( boost::future< int > & f, int fd)
+{
+    value1 = coro::this_coroutine::await( f);
+    BOOST_CHECK_EQUAL( 1, ::write( fd, "x", 1) );
+}
+
+void test_reactor()
+{
+    value1 = 0;
+    value2 = 0;
+    int fds[2];
+    BOOST_CHECK_EQUAL( 0, ::pipe( fds) );
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    coro::scheduler sched;
+    coro::reactor r( sched);
+    r.add( fds[0]);
+    sched.spawn( boost::bind( f7, boost::ref( r), fds[0]) );
+    sched.spawn( boost::bind( f8, boost::ref( f), fds[1]) );
+    boost::thread t( set_later, boost::ref( p), 9);
+    // the reader blocks the scheduler in epoll_wait(), the
+    // remote wakeup interrupts it
+    sched.run();
+    t.join();
+    BOOST_CHECK_EQUAL( ( int) 9, value1);
+    BOOST_CHECK_EQUAL( ( int) 'x', value2);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_io_engine()
+{
+    value1 = 0;
+    value2 = 0;
+    int fds[2];
+    BOOST_CHECK_EQUAL( 0, ::pipe( fds) );
+    boost::promise< int > p;
+    boost::future< int > f( p.get_future() );
+    coro::scheduler sched;
+    coro::io_engine e( sched);
+    e.add( fds[0]);
+    sched.spawn( boost::bind( f9, boost::ref( e), fds[0]) );
+    sched.spawn( boost::bind( f8, boost::ref( f), fds[1]) );
+    boost::thread t( set_later, boost::ref( p), 9);
+    sched.run();
+    t.join();
+    BOOST_CHECK_EQUAL( ( int) 9, value1);
+    BOOST_CHECK_EQUAL( ( int) 'x', value2);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: await test suite");
+
+    test->add( BOOST_TEST_CASE( & test_ready) );
+    test->add( BOOST_TEST_CASE( & test_remote) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_many) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+    test->add( BOOST_TEST_CASE( & test_reactor) );
+    test->add( BOOST_TEST_CASE( & test_io_engine) );
+#endif
+
+    return test;
+}
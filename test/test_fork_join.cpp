@@ -0,0 +1,158 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/fork_join_pool.hpp>
+
+namespace coro = boost::coroutines;
+
+boost::atomic< int > value1( 0);
+
+void fib( int n, long & result)
+{
+    if ( n < 2)
+    {
+        result = n;
+        return;
+    }
+    long x = 0, y = 0;
+    coro::fork_join_pool::spawn( boost::bind( fib, n - 1, boost::ref( x) ) );
+    fib( n - 2, y);
+    coro::fork_join_pool::sync();
+    result = x + y;
+}
+
+long fib_serial( int n)
+{ return n < 2 ? n : fib_serial( n - 1) + fib_serial( n - 2); }
+
+void sum( std::vector< int > const& v, std::size_t b, std::size_t e, long & result)
+{
+    if ( e - b <= 16)
+    {
+        result = 0;
+        for ( std::size_t i = b; i < e; ++i) result += v[i];
+        return;
+    }
+    std::size_t m = b + ( e - b) / 2;
+    long l = 0, r = 0;
+    coro::fork_join_pool::spawn( boost::bind( sum, boost::cref( v), b, m, boost::ref( l) ) );
+    coro::fork_join_pool::spawn( boost::bind( sum, boost::cref( v), m, e, boost::ref( r) ) );
+    coro::fork_join_pool::sync();
+    result = l + r;
+}
+
+void f1()
+{ throw std::runtime_error("abc"); }
+
+void f2( bool & caught)
+{
+    coro::fork_join_pool::spawn( f1);
+    try
+    { coro::fork_join_pool::sync(); }
+    catch ( std::runtime_error const&)
+    { caught = true; }
+}
+
+void f3()
+{ coro::fork_join_pool::spawn( f1); }
+
+void f4()
+{ ++value1; }
+
+void f5( int n)
+{
+    // no explicit sync - joined when f5 returns
+    for ( int i = 0; i < n; ++i)
+        coro::fork_join_pool::spawn( f4);
+}
+
+void test_fib()
+{
+    coro::fork_join_pool pool( 4);
+    BOOST_CHECK_EQUAL( ( std::size_t) 4, pool.size() );
+    long result = 0;
+    pool.run( boost::bind( fib, 20, boost::ref( result) ) );
+    BOOST_CHECK_EQUAL( fib_serial( 20), result);
+    // pool is reusable
+    pool.run( boost::bind( fib, 15, boost::ref( result) ) );
+    BOOST_CHECK_EQUAL( fib_serial( 15), result);
+}
+
+void test_single_worker()
+{
+    coro::fork_join_pool pool( 1);
+    long result = 0;
+    pool.run( boost::bind( fib, 15, boost::ref( result) ) );
+    BOOST_CHECK_EQUAL( fib_serial( 15), result);
+}
+
+void test_sum()
+{
+    std::vector< int > v;
+    long expected = 0;
+    for ( int i = 0; i < 10000; ++i)
+    {
+        v.push_back( i);
+        expected += i;
+    }
+    coro::fork_join_pool pool( 3);
+    long result = 0;
+    pool.run( boost::bind( sum, boost::cref( v), 0, v.size(), boost::ref( result) ) );
+    BOOST_CHECK_EQUAL( expected, result);
+}
+
+void test_implicit_sync()
+{
+    value1 = 0;
+    coro::fork_join_pool pool( 4);
+    pool.run( boost::bind( f5, 1000) );
+    BOOST_CHECK_EQUAL( 1000, value1.load() );
+}
+
+void test_exceptions()
+{
+    coro::fork_join_pool pool( 2);
+    bool caught = false;
+    pool.run( boost::bind( f2, boost::ref( caught) ) );
+    BOOST_CHECK( caught);
+
+    bool thrown = false;
+    try
+    { pool.run( f1); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    BOOST_CHECK( thrown);
+
+    // exception of a child not joined explicitly
+    thrown = false;
+    try
+    { pool.run( f3); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    BOOST_CHECK( thrown);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: fork-join test suite");
+
+    test->add( BOOST_TEST_CASE( & test_fib) );
+    test->add( BOOST_TEST_CASE( & test_single_worker) );
+    test->add( BOOST_TEST_CASE( & test_sum) );
+    test->add( BOOST_TEST_CASE( & test_implicit_sync) );
+    test->add( BOOST_TEST_CASE( & test_exceptions) );
+
+    return test;
+}
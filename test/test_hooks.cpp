@@ -0,0 +1,228 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// built twice: with BOOST_COROUTINES_RUNTIME_HOOKS and with
+// BOOST_COROUTINES_HOOKS=::test_hooks
+
+#include <map>
+#include <string>
+
+#include <boost/coroutine/stack_context.hpp>
+
+namespace coro = boost::coroutines;
+
+// events per coroutine, in order
+std::map< void const*, std::string > events;
+std::size_t stacks = 0;
+
+void record( void const* c, char e)
+{ events[c] += e; }
+
+struct test_hooks
+{
+    static void on_create( void const* c, coro::stack_context const& stack)
+    {
+        record( c, 'c');
+        stacks += stack.size;
+    }
+
+    static void on_resume( void const* c)
+    { record( c, 'r'); }
+
+    static void on_suspend( void const* c)
+    { record( c, 's'); }
+
+    static void on_complete( void const* c)
+    { record( c, 'x'); }
+
+    static void on_destroy( void const* c, coro::stack_context const& stack)
+    {
+        record( c, 'd');
+        stacks -= stack.size;
+    }
+};
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/hooks.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+class runtime_hooks : public coro::coroutine_hooks
+{
+public:
+    void on_create( void const* c, coro::stack_context const& stack)
+    { test_hooks::on_create( c, stack); }
+
+    void on_resume( void const* c)
+    { test_hooks::on_resume( c); }
+
+    void on_suspend( void const* c)
+    { test_hooks::on_suspend( c); }
+
+    void on_complete( void const* c)
+    { test_hooks::on_complete( c); }
+
+    void on_destroy( void const* c, coro::stack_context const& stack)
+    { test_hooks::on_destroy( c, stack); }
+};
+
+runtime_hooks hooks;
+#endif
+
+void install()
+{
+    events.clear();
+    stacks = 0;
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+    coro::hooks::install( & hooks);
+    BOOST_CHECK( & hooks == coro::hooks::installed() );
+#endif
+}
+
+void uninstall()
+{
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+    coro::hooks::install( 0);
+#endif
+}
+
+// the only coroutine recorded
+std::string only()
+{
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 1, events.size() );
+    return events.begin()->second;
+}
+
+void f_pull( coro::asymmetric_coroutine< int >::push_type & sink)
+{
+    sink( 1);
+    sink( 2);
+}
+
+void f_push( coro::asymmetric_coroutine< int >::pull_type & source)
+{
+    while ( source)
+        source();
+}
+
+void f_loop( coro::asymmetric_coroutine< void >::push_type & sink)
+{
+    for (;;)
+        sink();
+}
+
+void f_sym( coro::symmetric_coroutine< void >::yield_type & yield)
+{ yield(); }
+
+coro::symmetric_coroutine< void >::call_type * other = 0;
+
+void f_sym_to( coro::symmetric_coroutine< void >::yield_type & yield)
+{ yield( * other); }
+
+void f_sym_other( coro::symmetric_coroutine< void >::yield_type &)
+{}
+
+void test_pull()
+{
+    install();
+    {
+        coro::asymmetric_coroutine< int >::pull_type source( f_pull);
+        source();
+        source();
+        BOOST_CHECK( ! source);
+    }
+    BOOST_CHECK_EQUAL( std::string("crsrsrxd"), only() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, stacks);
+    uninstall();
+}
+
+void test_push()
+{
+    install();
+    {
+        coro::asymmetric_coroutine< int >::push_type sink( f_push);
+        sink( 1);
+        sink( 2);
+    }
+    // not started until the first push; unwound when destroyed
+    BOOST_CHECK_EQUAL( std::string("crsrsrxd"), only() );
+    uninstall();
+}
+
+void test_unwind()
+{
+    install();
+    {
+        coro::asymmetric_coroutine< void >::pull_type source( f_loop);
+        source();
+    }
+    BOOST_CHECK_EQUAL( std::string("crsrsrxd"), only() );
+    uninstall();
+}
+
+void test_symmetric()
+{
+    install();
+    {
+        coro::symmetric_coroutine< void >::call_type c( f_sym);
+        c();
+        c();
+    }
+    BOOST_CHECK_EQUAL( std::string("crsrxd"), only() );
+    uninstall();
+}
+
+void test_yield_to()
+{
+    install();
+    {
+        coro::symmetric_coroutine< void >::call_type o( f_sym_other);
+        coro::symmetric_coroutine< void >::call_type c( f_sym_to);
+        other = & o;
+        c();
+    }
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 2, events.size() );
+    std::map< std::string, int > seen;
+    for ( std::map< void const*, std::string >::iterator i = events.begin(); i != events.end(); ++i)
+        ++seen[i->second];
+    // c suspends in favour of o, o completes; c is unwound when destroyed
+    BOOST_CHECK_EQUAL( 1, seen["crsrxd"]);
+    BOOST_CHECK_EQUAL( 1, seen["crxd"]);
+    uninstall();
+}
+
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+void test_uninstalled()
+{
+    install();
+    uninstall();
+    BOOST_CHECK( 0 == coro::hooks::installed() );
+    {
+        coro::asymmetric_coroutine< int >::pull_type source( f_pull);
+        source();
+    }
+    BOOST_CHECK( events.empty() );
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: hooks test suite");
+
+    test->add( BOOST_TEST_CASE( & test_pull) );
+    test->add( BOOST_TEST_CASE( & test_push) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+    test->add( BOOST_TEST_CASE( & test_symmetric) );
+    test->add( BOOST_TEST_CASE( & test_yield_to) );
+#if defined(BOOST_COROUTINES_RUNTIME_HOOKS)
+    test->add( BOOST_TEST_CASE( & test_uninstalled) );
+#endif
+
+    return test;
+}
@@ -0,0 +1,371 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/reactor.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+// the calls of the legacy code below are blocking calls of libc;
+// the test is linked with the interposition library
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+int value2 = 0;
+
+void f1( int fd, std::string & s)
+{
+    char buf[16];
+    ssize_t n = 0;
+    while ( 0 < ( n = ::read( fd, buf, sizeof( buf) ) ) )
+        s.append( buf, n);
+}
+
+void f2( int fd, std::string const& s)
+{
+    for ( std::size_t i = 0; i < s.size(); i += 7)
+    {
+        std::size_t n = std::min< std::size_t >( 7, s.size() - i);
+        BOOST_CHECK_EQUAL( ( ssize_t) n, ::write( fd, s.data() + i, n) );
+        coro::this_coroutine::yield();
+    }
+    ::shutdown( fd, SHUT_WR);
+}
+
+void f3( int fd, std::size_t & n)
+{
+    std::string s( 4 * 1024 * 1024, 'x');
+    ssize_t m = ::write( fd, s.data(), s.size() );
+    if ( 0 < m) n = m;
+    ::shutdown( fd, SHUT_WR);
+}
+
+void f4( int fd, std::size_t & n)
+{
+    char buf[4096];
+    ssize_t m = 0;
+    while ( 0 < ( m = ::read( fd, buf, sizeof( buf) ) ) )
+        n += m;
+}
+
+void f5( coro::reactor & r, int lfd)
+{
+    // non-blocking sockets keep their semantics
+    int fd = r.async_accept( lfd);
+    char buf[64];
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_read( fd, buf, sizeof( buf) ) ) )
+        r.async_write( fd, buf, n);
+    r.remove( fd);
+    ::close( fd);
+}
+
+void f6( sockaddr_in const& addr, std::string & s)
+{
+    int fd = ::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != fd);
+    BOOST_REQUIRE( 0 == ::connect( fd, reinterpret_cast< sockaddr const* >( & addr), sizeof( addr) ) );
+    BOOST_CHECK_EQUAL( ( ssize_t) 3, ::write( fd, "abc", 3) );
+    char buf[3];
+    std::size_t n = 0;
+    while ( n < sizeof( buf) )
+    {
+        ssize_t m = ::read( fd, buf + n, sizeof( buf) - n);
+        BOOST_REQUIRE( 0 < m);
+        n += m;
+    }
+    s.assign( buf, n);
+    ::close( fd);
+}
+
+void f7()
+{
+    ::usleep( 20000);
+    value1 = value2;
+}
+
+void f8()
+{
+    timespec ts = { 0, 1000000 };
+    for ( int i = 0; i < 5; ++i)
+    {
+        ::nanosleep( & ts, 0);
+        ++value2;
+    }
+}
+
+void f9( int fd, int & n1, int & n2, short & revents)
+{
+    pollfd p;
+    p.fd = fd;
+    p.events = POLLIN;
+    p.revents = 0;
+    n1 = ::poll( & p, 1, 10);
+    n2 = ::poll( & p, 1, -1);
+    revents = p.revents;
+}
+
+void f10( int fd)
+{
+    ::usleep( 30000);
+    BOOST_CHECK_EQUAL( ( ssize_t) 1, ::write( fd, "x", 1) );
+}
+
+void f11( int * fds, int & n)
+{
+    pollfd p[2];
+    for ( int i = 0; i < 2; ++i)
+    {
+        p[i].fd = fds[i];
+        p[i].events = POLLIN;
+        p[i].revents = 0;
+    }
+    n = ::poll( p, 2, 1000);
+    value1 = p[1].revents & POLLIN;
+}
+
+void f12( int fd)
+{
+    char c = 0;
+    BOOST_CHECK_EQUAL( ( ssize_t) 1, ::read( fd, & c, 1) );
+}
+
+void f13( int fd, int & err, int & n)
+{
+    // passed through - the state is kept after the first call
+    char c = 0;
+    for ( int i = 0; i < 2; ++i)
+        if ( -1 == ::read( fd, & c, 1) ) err = errno;
+    // added to the reactor for poll()
+    pollfd p;
+    p.fd = fd;
+    p.events = POLLIN;
+    p.revents = 0;
+    n = ::poll( & p, 1, 1000);
+}
+
+void write_later( int fd)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    BOOST_CHECK_EQUAL( ( ssize_t) 1, ::write( fd, "x", 1) );
+}
+
+void test_read_write()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::string in( "abcdefghijklmnopqrstuvwxyz0123456789"), out;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        // the reader would block the thread - the writer could never run
+        sched.spawn( boost::bind( f1, fds[0], boost::ref( out) ) );
+        sched.spawn( boost::bind( f2, fds[1], boost::cref( in) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( in, out);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_backpressure()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::size_t written = 0, read = 0;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f3, fds[1], boost::ref( written) ) );
+        sched.spawn( boost::bind( f4, fds[0], boost::ref( read) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    // a blocking write transfers all bytes
+    BOOST_CHECK_EQUAL( ( std::size_t) 4 * 1024 * 1024, written);
+    BOOST_CHECK_EQUAL( written, read);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_connect()
+{
+    int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != lfd);
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    BOOST_REQUIRE( 0 == ::bind( lfd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) );
+    socklen_t len = sizeof( addr);
+    BOOST_REQUIRE( 0 == ::getsockname( lfd, reinterpret_cast< sockaddr * >( & addr), & len) );
+    BOOST_REQUIRE( 0 == ::listen( lfd, 1) );
+    std::string s;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        r.add( lfd);
+        sched.spawn( boost::bind( f5, boost::ref( r), lfd) );
+        sched.spawn( boost::bind( f6, boost::cref( addr), boost::ref( s) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( std::string("abc"), s);
+    ::close( lfd);
+}
+
+void test_sleep()
+{
+    value1 = 0;
+    value2 = 0;
+    coro::scheduler sched;
+    // no reactor required
+    sched.spawn( f7);
+    sched.spawn( f8);
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( int) 5, value1);
+}
+
+void test_poll()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    int n1 = -1, n2 = -1;
+    short revents = 0;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f9, fds[0], boost::ref( n1), boost::ref( n2), boost::ref( revents) ) );
+        sched.spawn( boost::bind( f10, fds[1]) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( 0, n1);
+    BOOST_CHECK_EQUAL( 1, n2);
+    BOOST_CHECK( 0 != ( revents & POLLIN) );
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_poll_many()
+{
+    value1 = 0;
+    int fds1[2], fds2[2];
+    BOOST_REQUIRE( 0 == ::pipe( fds1) );
+    BOOST_REQUIRE( 0 == ::pipe( fds2) );
+    int fds[2] = { fds1[0], fds2[0] };
+    int n = -1;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f11, fds, boost::ref( n) ) );
+        sched.spawn( boost::bind( f10, fds2[1]) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( 1, n);
+    BOOST_CHECK( 0 != value1);
+    ::close( fds1[0]);
+    ::close( fds1[1]);
+    ::close( fds2[0]);
+    ::close( fds2[1]);
+}
+
+void test_nonblocking()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    BOOST_REQUIRE( 0 == ::fcntl( fds[0], F_SETFL, O_NONBLOCK) );
+    int err = 0, n = -1;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f13, fds[0], boost::ref( err), boost::ref( n) ) );
+        sched.spawn( boost::bind( f10, fds[1]) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK( EAGAIN == err || EWOULDBLOCK == err);
+    BOOST_CHECK_EQUAL( 1, n);
+    ::close( fds[0]);
+    ::close( fds[1]);
+
+    // close() forgets the state: the descriptors are reused by a
+    // socket in blocking mode
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f12, fds[0]) );
+        sched.spawn( boost::bind( f10, fds[1]) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_outside()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    BOOST_REQUIRE( 1 == ::write( fds[1], "x", 1) );
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        sched.spawn( boost::bind( f12, fds[0]) );
+        sched.run();
+    }
+    // switched to non-blocking mode by the task ...
+    BOOST_CHECK( 0 != ( ::fcntl( fds[0], F_GETFL, 0) & O_NONBLOCK) );
+    // ... still blocks the thread outside of tasks
+    boost::thread t( write_later, fds[1]);
+    char c = 0;
+    BOOST_CHECK_EQUAL( ( ssize_t) 1, ::read( fds[0], & c, 1) );
+    BOOST_CHECK_EQUAL( 'x', c);
+    t.join();
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: interpose test suite");
+
+    test->add( BOOST_TEST_CASE( & test_read_write) );
+    test->add( BOOST_TEST_CASE( & test_backpressure) );
+    test->add( BOOST_TEST_CASE( & test_connect) );
+    test->add( BOOST_TEST_CASE( & test_sleep) );
+    test->add( BOOST_TEST_CASE( & test_poll) );
+    test->add( BOOST_TEST_CASE( & test_poll_many) );
+    test->add( BOOST_TEST_CASE( & test_nonblocking) );
+    test->add( BOOST_TEST_CASE( & test_outside) );
+
+    return test;
+}
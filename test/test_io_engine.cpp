@@ -0,0 +1,317 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/io_engine.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void f1( coro::io_engine & e, int fd, std::string & s)
+{
+    char buf[16];
+    std::size_t n = 0;
+    while ( 0 != ( n = e.async_read( fd, buf, sizeof( buf) ) ) )
+        s.append( buf, n);
+}
+
+void f2( coro::io_engine & e, int fd, std::string const& s)
+{
+    for ( std::size_t i = 0; i < s.size(); i += 7)
+    {
+        e.async_write( fd, s.data() + i, ( std::min)( std::size_t( 7), s.size() - i) );
+        coro::this_coroutine::yield();
+    }
+    ::shutdown( fd, SHUT_WR);
+}
+
+void f3( coro::io_engine & e, int fd, std::string const& in, std::size_t & written,
+         char * buf, std::size_t size, std::size_t & n)
+{
+    written = e.async_write_at( fd, 0, in.data(), in.size() );
+    std::size_t m = 0;
+    while ( 0 != ( m = e.async_read_at( fd, n, buf + n, size - n) ) )
+        n += m;
+}
+
+void f4( coro::io_engine & e, int lfd)
+{
+    int fd = e.async_accept( lfd);
+    char buf[64];
+    std::size_t n = 0;
+    while ( 0 != ( n = e.async_read( fd, buf, sizeof( buf) ) ) )
+        e.async_write( fd, buf, n);
+    e.remove( fd);
+    ::close( fd);
+}
+
+void f5( coro::io_engine & e, sockaddr_in const& addr, std::string & s)
+{
+    int fd = ::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != fd);
+    e.add( fd);
+    e.async_connect( fd, reinterpret_cast< sockaddr const* >( & addr), sizeof( addr) );
+    e.async_write( fd, "abc", 3);
+    ::shutdown( fd, SHUT_WR);
+    char buf[3];
+    std::size_t n = 0, m = 0;
+    while ( 0 != ( m = e.async_read( fd, buf + n, sizeof( buf) - n) ) )
+        n += m;
+    s.assign( buf, n);
+    e.remove( fd);
+    ::close( fd);
+}
+
+void f6( coro::io_engine & e, int fd, boost::system::error_code & ec)
+{
+    char buf[16];
+    e.async_read( fd, buf, sizeof( buf), ec);
+}
+
+void f7( coro::io_engine & e, int fd)
+{
+    X x;
+    char buf[16];
+    e.async_read( fd, buf, sizeof( buf) );
+}
+
+void f8( boost::scoped_ptr< coro::io_engine > & e)
+{
+    coro::this_coroutine::yield();
+    // unwinds the task waiting in async_read()
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+    e.reset();
+}
+
+void read_write( coro::io_backend backend,
+                 coro::io_engine::clock_type::duration const& latency =
+                    coro::io_engine::clock_type::duration::max() )
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::string in( "abcdefghijklmnopqrstuvwxyz0123456789"), out;
+    {
+        coro::scheduler sched;
+        coro::io_engine e( sched, backend);
+        e.batch_latency( latency);
+        e.add( fds[0]);
+        e.add( fds[1]);
+        sched.spawn( boost::bind( f1, boost::ref( e), fds[0], boost::ref( out) ) );
+        sched.spawn( boost::bind( f2, boost::ref( e), fds[1], boost::cref( in) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( in, out);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void read_file( coro::io_backend backend)
+{
+    char path[] = "/tmp/test_io_engine_XXXXXX";
+    int fd = ::mkstemp( path);
+    BOOST_REQUIRE( -1 != fd);
+    ::unlink( path);
+    std::string in( 100000, 'x');
+    for ( std::size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast< char >( 'a' + i % 26);
+    std::vector< char > out( in.size() );
+    std::size_t written = 0, read = 0;
+    {
+        coro::scheduler sched;
+        coro::io_engine e( sched, backend);
+        // registered buffer and fixed file
+        iovec iov = { & out[0], out.size() };
+        e.register_buffers( & iov, 1);
+        e.register_files( & fd, 1);
+        sched.spawn( boost::bind( f3, boost::ref( e), fd, boost::cref( in), boost::ref( written),
+                                  & out[0], out.size(), boost::ref( read) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+        e.unregister_files();
+        e.unregister_buffers();
+    }
+    BOOST_CHECK_EQUAL( in.size(), written);
+    BOOST_CHECK_EQUAL( in.size(), read);
+    BOOST_CHECK( 0 == std::memcmp( in.data(), & out[0], in.size() ) );
+    ::close( fd);
+}
+
+void accept_connect( coro::io_backend backend)
+{
+    int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != lfd);
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    BOOST_REQUIRE( 0 == ::bind( lfd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) );
+    socklen_t len = sizeof( addr);
+    BOOST_REQUIRE( 0 == ::getsockname( lfd, reinterpret_cast< sockaddr * >( & addr), & len) );
+    BOOST_REQUIRE( 0 == ::listen( lfd, 1) );
+    std::string s;
+    {
+        coro::scheduler sched;
+        coro::io_engine e( sched, backend);
+        e.add( lfd);
+        sched.spawn( boost::bind( f4, boost::ref( e), lfd) );
+        sched.spawn( boost::bind( f5, boost::ref( e), boost::cref( addr), boost::ref( s) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( std::string("abc"), s);
+    ::close( lfd);
+}
+
+void f9( int fd)
+{ BOOST_CHECK_EQUAL( ( ssize_t) 1, ::write( fd, "x", 1) ); }
+
+void remove( coro::io_backend backend, bool registered)
+{
+    int fds1[2], fds2[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds1) );
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds2) );
+    boost::system::error_code ec1, ec2;
+    coro::scheduler sched;
+    coro::io_engine e( sched, backend);
+    e.add( fds1[0]);
+    e.add( fds2[0]);
+    if ( registered && e.uses_io_uring() )
+    {
+        int fds[2] = { fds1[0], fds2[0] };
+        e.register_files( fds, 2);
+    }
+    sched.spawn( boost::bind( f6, boost::ref( e), fds1[0], boost::ref( ec1) ) );
+    sched.spawn( boost::bind( f6, boost::ref( e), fds2[0], boost::ref( ec2) ) );
+    sched.spawn( boost::bind( & coro::io_engine::remove, boost::ref( e), fds1[0]) );
+    // the operations on other descriptors are not canceled
+    sched.spawn( boost::bind( f9, fds2[1]) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ECANCELED, ec1.value() );
+    BOOST_CHECK( ! ec2);
+    ::close( fds1[0]);
+    ::close( fds1[1]);
+    ::close( fds2[0]);
+    ::close( fds2[1]);
+}
+
+void unwind( coro::io_backend backend)
+{
+    value1 = 0;
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    coro::scheduler sched;
+    boost::scoped_ptr< coro::io_engine > e( new coro::io_engine( sched, backend) );
+    e->add( fds[0]);
+    sched.spawn( boost::bind( f7, boost::ref( * e), fds[0]) );
+    sched.spawn( boost::bind( f8, boost::ref( e) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( 0 == sched.poller() );
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_backend()
+{
+    {
+        coro::scheduler sched;
+        coro::io_engine e( sched, coro::io_backend_epoll);
+        BOOST_CHECK( ! e.uses_io_uring() );
+        BOOST_CHECK( 0 != sched.poller() );
+    }
+    coro::scheduler sched;
+    coro::io_engine e( sched);
+    BOOST_CHECK( 0 != sched.poller() );
+}
+
+void test_read_write()
+{
+    read_write( coro::io_backend_auto);
+    read_write( coro::io_backend_epoll);
+}
+
+void test_batch_latency()
+{
+    {
+        coro::scheduler sched;
+        coro::io_engine e( sched);
+        BOOST_CHECK( coro::io_engine::clock_type::duration::max() == e.batch_latency() );
+    }
+    // each entry submitted at once resp. batches bounded in time
+    read_write( coro::io_backend_auto, coro::io_engine::clock_type::duration::zero() );
+    read_write( coro::io_backend_auto, boost::chrono::microseconds( 10) );
+}
+
+void test_read_file()
+{
+    read_file( coro::io_backend_auto);
+    read_file( coro::io_backend_epoll);
+}
+
+void test_accept_connect()
+{
+    accept_connect( coro::io_backend_auto);
+    accept_connect( coro::io_backend_epoll);
+}
+
+void test_remove()
+{
+    remove( coro::io_backend_auto, false);
+    remove( coro::io_backend_auto, true);
+    remove( coro::io_backend_epoll, false);
+}
+
+void test_unwind()
+{
+    unwind( coro::io_backend_auto);
+    unwind( coro::io_backend_epoll);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: io_engine test suite");
+
+    test->add( BOOST_TEST_CASE( & test_backend) );
+    test->add( BOOST_TEST_CASE( & test_read_write) );
+    test->add( BOOST_TEST_CASE( & test_batch_latency) );
+    test->add( BOOST_TEST_CASE( & test_read_file) );
+    test->add( BOOST_TEST_CASE( & test_accept_connect) );
+    test->add( BOOST_TEST_CASE( & test_remove) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+
+    return test;
+}
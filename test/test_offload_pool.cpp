@@ -0,0 +1,160 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/offload_pool.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/task_group.hpp>
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+int value2 = 0;
+bool value3 = false;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+int sleep_and_return( int i)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    return i;
+}
+
+boost::thread::id worker_id()
+{ return boost::this_thread::get_id(); }
+
+void sleep_and_throw()
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 1) );
+    throw std::runtime_error("abc");
+}
+
+void f1( coro::offload_pool & p, int i)
+{ value1 += p.execute( boost::bind( sleep_and_return, i) ); }
+
+void f2( int & n)
+{
+    for ( int i = 0; i < 3; ++i)
+    {
+        ++n;
+        coro::this_coroutine::yield();
+    }
+}
+
+void f3( coro::offload_pool & p)
+{
+    try
+    { p.execute( sleep_and_throw); }
+    catch ( std::runtime_error const&)
+    { value3 = true; }
+}
+
+void f4( coro::offload_pool & p, boost::thread::id & id)
+{ id = p.execute( worker_id); }
+
+void f5( coro::offload_pool & p)
+{
+    X x;
+    p.execute( boost::bind( sleep_and_return, 1) );
+    value2 = 1;
+}
+
+void f6( coro::offload_pool & p)
+{
+    coro::task_group g;
+    g.spawn( boost::bind( f5, boost::ref( p) ) );
+    g.cancel_after( boost::chrono::milliseconds( 1) );
+    g.wait();
+}
+
+void test_execute()
+{
+    value1 = 0;
+    int n = 0;
+    coro::offload_pool p( 2);
+    BOOST_CHECK_EQUAL( ( std::size_t) 2, p.size() );
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f1, boost::ref( p), 3) );
+    sched.spawn( boost::bind( f1, boost::ref( p), 4) );
+    // keeps running while the others wait for the workers
+    sched.spawn( boost::bind( f2, boost::ref( n) ) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+}
+
+void test_worker()
+{
+    boost::thread::id id;
+    coro::offload_pool p( 1);
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f4, boost::ref( p), boost::ref( id) ) );
+    sched.run();
+    BOOST_CHECK( boost::thread::id() != id);
+    BOOST_CHECK( boost::this_thread::get_id() != id);
+    // outside of a task the call is executed inline
+    BOOST_CHECK( boost::this_thread::get_id() == p.execute( worker_id) );
+}
+
+void test_exception()
+{
+    value3 = false;
+    coro::offload_pool p( 1);
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f3, boost::ref( p) ) );
+    sched.run();
+    BOOST_CHECK( value3);
+}
+
+void test_many()
+{
+    value1 = 0;
+    // more calls than workers - the calls are queued
+    coro::offload_pool p( 2);
+    coro::scheduler sched;
+    for ( int i = 0; i < 20; ++i)
+        sched.spawn( boost::bind( f1, boost::ref( p), i) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( int) 190, value1);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    value2 = 0;
+    coro::offload_pool p( 1);
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f6, boost::ref( p) ) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK_EQUAL( ( int) 0, value2);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: offload_pool test suite");
+
+    test->add( BOOST_TEST_CASE( & test_execute) );
+    test->add( BOOST_TEST_CASE( & test_worker) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_many) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+
+    return test;
+}
@@ -0,0 +1,130 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/detail/probes.hpp>
+#include <boost/coroutine/pooled_stack_allocator.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/standard_stack_allocator.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+
+namespace coro = boost::coroutines;
+
+// linked statically: all probes are part of the executable
+
+int value = 0;
+
+void f_pull( coro::asymmetric_coroutine< int >::push_type & sink)
+{
+    sink( 1);
+    sink( 2);
+}
+
+void f_push( coro::asymmetric_coroutine< int >::pull_type & source)
+{
+    while ( source)
+    {
+        value = source.get();
+        source();
+    }
+}
+
+void f_loop( coro::asymmetric_coroutine< void >::push_type & sink)
+{
+    for (;;)
+        sink();
+}
+
+void f_sym( coro::symmetric_coroutine< int >::yield_type & yield)
+{
+    value = yield.get();
+    yield();
+}
+
+void f_task()
+{ ++value; }
+
+// the probed code paths run with the probes compiled in or out
+void test_run()
+{
+    value = 0;
+    {
+        coro::asymmetric_coroutine< int >::pull_type source( f_pull);
+        BOOST_CHECK_EQUAL( 1, source.get() );
+        source();
+        BOOST_CHECK_EQUAL( 2, source.get() );
+        source();
+        BOOST_CHECK( ! source);
+    }
+    {
+        coro::asymmetric_coroutine< int >::push_type sink(
+            f_push, coro::attributes(), coro::protected_stack_allocator() );
+        sink( 3);
+        BOOST_CHECK_EQUAL( 3, value);
+    }
+    {
+        // unwound when destroyed
+        coro::asymmetric_coroutine< void >::pull_type source(
+            f_loop, coro::attributes(), coro::pooled_stack_allocator() );
+        source();
+        BOOST_CHECK( source);
+    }
+    {
+        coro::symmetric_coroutine< int >::call_type c(
+            f_sym, coro::attributes(), coro::standard_stack_allocator() );
+        c( 4);
+        BOOST_CHECK_EQUAL( 4, value);
+    }
+    {
+        coro::scheduler sched;
+        sched.spawn( f_task);
+        sched.run();
+        BOOST_CHECK_EQUAL( 5, value);
+    }
+}
+
+#if defined(BOOST_COROUTINES_HAS_PROBES)
+// provider and name of each probe are stored as adjacent strings in the
+// .note.stapsdt section
+void test_notes()
+{
+    std::ifstream is( "/proc/self/exe", std::ios::binary);
+    BOOST_REQUIRE( is);
+    std::string image( ( std::istreambuf_iterator< char >( is) ), std::istreambuf_iterator< char >() );
+
+    char const* names[] = {
+        "create", "switch_out", "switch_in", "complete", "unwind",
+        "stack_allocate", "stack_deallocate" };
+    for ( std::size_t i = 0; i < sizeof( names) / sizeof( names[0]); ++i)
+    {
+        std::string note( "boost_coroutine");
+        note += '\0';
+        note += names[i];
+        note += '\0';
+        BOOST_CHECK_MESSAGE( std::string::npos != image.find( note), names[i]);
+    }
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: probes test suite");
+
+    test->add( BOOST_TEST_CASE( & test_run) );
+#if defined(BOOST_COROUTINES_HAS_PROBES)
+    test->add( BOOST_TEST_CASE( & test_notes) );
+#endif
+
+    return test;
+}
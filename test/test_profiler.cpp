@@ -0,0 +1,248 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <string>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/pooled_stack_allocator.hpp>
+#include <boost/coroutine/profiler.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/registry.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/standard_stack_allocator.hpp>
+
+namespace coro = boost::coroutines;
+
+// built with frame pointers and exported symbols (-rdynamic)
+
+volatile unsigned long sink = 0;
+
+BOOST_NOINLINE void spin( int ms)
+{
+    std::clock_t end = std::clock() + ms * ( CLOCKS_PER_SEC / 1000);
+    while ( std::clock() < end)
+        for ( int i = 0; i < 1000; ++i)
+            sink = sink + i;
+}
+
+BOOST_NOINLINE void inner( int ms)
+{
+    spin( ms);
+    sink = sink + 1;
+}
+
+BOOST_NOINLINE void outer( int ms)
+{
+    inner( ms);
+    sink = sink + 1;
+}
+
+// sum of the counts of the lines starting with `root`; `nested` counts
+// the lines in which outer() calls inner() calls spin()
+std::size_t count( std::string const& folded, std::string const& root, std::size_t * nested = 0)
+{
+    std::istringstream is( folded);
+    std::string line;
+    std::size_t n = 0;
+    while ( std::getline( is, line) )
+    {
+        std::string::size_type sp = line.rfind(' ');
+        BOOST_REQUIRE( std::string::npos != sp);
+        if ( ! root.empty() && 0 != line.compare( 0, root.size(), root) ) continue;
+        n += std::strtoul( line.c_str() + sp + 1, 0, 10);
+        std::string::size_type o = line.find(";outer");
+        std::string::size_type i = line.find(";inner");
+        std::string::size_type s = line.find(";spin");
+        if ( 0 != nested && std::string::npos != o && o < i && std::string::npos != i && i < s && std::string::npos != s)
+            ++( * nested);
+    }
+    return n;
+}
+
+// sum of the counts of the lines starting with `root` containing `frame`
+std::size_t count_frame( std::string const& folded, std::string const& root, std::string const& frame)
+{
+    std::istringstream is( folded);
+    std::string line;
+    std::size_t n = 0;
+    while ( std::getline( is, line) )
+    {
+        std::string::size_type sp = line.rfind(' ');
+        BOOST_REQUIRE( std::string::npos != sp);
+        if ( 0 != line.compare( 0, root.size(), root) ) continue;
+        if ( std::string::npos == line.find( frame) ) continue;
+        n += std::strtoul( line.c_str() + sp + 1, 0, 10);
+    }
+    return n;
+}
+
+std::string folded( bool by_coroutine = false)
+{
+    std::ostringstream os;
+    coro::profiler::write_folded( os, by_coroutine);
+    return os.str();
+}
+
+void labeled( char const* label)
+{
+    coro::this_coroutine::label( label);
+    outer( 150);
+}
+
+void generator( coro::asymmetric_coroutine< void >::push_type & sink)
+{
+    // labeled after the first suspension
+    sink();
+    outer( 150);
+}
+
+void values( coro::asymmetric_coroutine< int >::push_type & sink)
+{
+    for ( int i = 0; i < 3; ++i)
+        sink( i);
+}
+
+BOOST_NOINLINE void after( int ms)
+{
+    spin( ms);
+    sink = sink + 1;
+}
+
+// spins before and after it has used a generator
+void nesting()
+{
+    coro::this_coroutine::label( "nesting");
+    outer( 200);
+    coro::asymmetric_coroutine< int >::pull_type source( values);
+    while ( source)
+        source();
+    after( 200);
+}
+
+template< typename StackAllocator >
+void run( char const* label, StackAllocator alloc)
+{
+    coro::asymmetric_coroutine< void >::pull_type source(
+        generator, coro::attributes(), alloc);
+    source.label( label);
+    source();
+}
+
+void test_not_running()
+{
+    coro::profiler::clear();
+    BOOST_CHECK( ! coro::profiler::running() );
+    spin( 50);
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, coro::profiler::samples() );
+    BOOST_CHECK_EQUAL( std::string(), folded() );
+}
+
+void test_tasks()
+{
+    coro::profiler::clear();
+    coro::profiler::start( 1000);
+    BOOST_CHECK( coro::profiler::running() );
+    {
+        coro::scheduler sched;
+        sched.spawn( boost::bind( labeled, "alpha") );
+        sched.spawn( boost::bind( labeled, "beta") );
+        sched.run();
+    }
+    coro::profiler::stop();
+    BOOST_CHECK( ! coro::profiler::running() );
+
+    std::string s = folded();
+    std::size_t nested = 0;
+    BOOST_CHECK( 0 < count( s, "alpha;", & nested) );
+    BOOST_CHECK( 0 < count( s, "beta;", & nested) );
+    // the coroutine stacks were walked up to the task functions
+    BOOST_CHECK( 0 < nested);
+    BOOST_CHECK_EQUAL( coro::profiler::samples(), count( s, "") );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, coro::profiler::dropped() );
+
+    // stopped: no more samples
+    std::size_t n = coro::profiler::samples();
+    spin( 50);
+    BOOST_CHECK_EQUAL( n, coro::profiler::samples() );
+}
+
+void test_allocators()
+{
+    coro::profiler::clear();
+    coro::profiler::start( 1000);
+    run( "standard", coro::standard_stack_allocator() );
+    run( "protected", coro::protected_stack_allocator() );
+    run( "pooled", coro::pooled_stack_allocator() );
+    coro::profiler::stop();
+
+    std::string s = folded();
+    std::size_t nested = 0;
+    BOOST_CHECK( 0 < count( s, "standard;", & nested) );
+    BOOST_CHECK( 0 < count( s, "protected;", & nested) );
+    BOOST_CHECK( 0 < count( s, "pooled;", & nested) );
+    BOOST_CHECK( 0 < nested);
+}
+
+void test_nested()
+{
+    coro::profiler::clear();
+    coro::profiler::start( 1000);
+    {
+        coro::scheduler sched;
+        sched.spawn( nesting);
+        sched.run();
+    }
+    coro::profiler::stop();
+
+    // the task is attributed to its label again once the generator
+    // suspended
+    std::string s = folded();
+    BOOST_CHECK( 0 < count_frame( s, "nesting;", ";outer") );
+    BOOST_CHECK( 0 < count_frame( s, "nesting;", ";after") );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, count_frame( s, "[thread];", ";after") );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, count_frame( s, "[coroutine];", ";after") );
+}
+
+void test_unlabeled()
+{
+    coro::profiler::clear();
+    coro::profiler::start( 1000);
+    {
+        coro::scheduler sched;
+        sched.spawn( boost::bind( outer, 100) );
+        sched.run();
+    }
+    spin( 100);
+    coro::profiler::stop();
+
+    std::string s = folded();
+    BOOST_CHECK( 0 < count( s, "[coroutine];") );
+    BOOST_CHECK( 0 < count( s, "[thread];") );
+    // the root names the execution context
+    BOOST_CHECK( 0 < count( folded( true), "[coroutine] 0x") );
+    coro::profiler::clear();
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, coro::profiler::samples() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: profiler test suite");
+
+    test->add( BOOST_TEST_CASE( & test_not_running) );
+    test->add( BOOST_TEST_CASE( & test_tasks) );
+    test->add( BOOST_TEST_CASE( & test_allocators) );
+    test->add( BOOST_TEST_CASE( & test_nested) );
+    test->add( BOOST_TEST_CASE( & test_unlabeled) );
+
+    return test;
+}
@@ -0,0 +1,367 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/reactor.hpp>
+#include <boost/coroutine/scheduler.hpp>
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void f1( coro::reactor & r, int fd, std::string & s)
+{
+    char buf[16];
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_read( fd, buf, sizeof( buf) ) ) )
+        s.append( buf, n);
+}
+
+void f2( coro::reactor & r, int fd, std::string const& s)
+{
+    // small chunks - the reader suspends between them
+    for ( std::size_t i = 0; i < s.size(); i += 7)
+    {
+        r.async_write( fd, s.data() + i, std::min< std::size_t >( 7, s.size() - i) );
+        coro::this_coroutine::yield();
+    }
+    ::shutdown( fd, SHUT_WR);
+}
+
+void f3( coro::reactor & r, int fd, std::size_t & n)
+{
+    std::string s( 4 * 1024 * 1024, 'x');
+    n = r.async_write( fd, s.data(), s.size() );
+    ::shutdown( fd, SHUT_WR);
+}
+
+void f4( coro::reactor & r, int fd, std::size_t & n)
+{
+    char buf[4096];
+    std::size_t m = 0;
+    while ( 0 != ( m = r.async_read( fd, buf, sizeof( buf) ) ) )
+        n += m;
+}
+
+void f5( coro::reactor & r, int lfd)
+{
+    int fd = r.async_accept( lfd);
+    char buf[64];
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_read( fd, buf, sizeof( buf) ) ) )
+        r.async_write( fd, buf, n);
+    r.remove( fd);
+    ::close( fd);
+}
+
+void f6( coro::reactor & r, sockaddr_in const& addr, std::string & s)
+{
+    int fd = ::socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    BOOST_REQUIRE( -1 != fd);
+    r.add( fd);
+    r.async_connect( fd, reinterpret_cast< sockaddr const* >( & addr), sizeof( addr) );
+    r.async_write( fd, "abc", 3);
+    char buf[3];
+    std::size_t n = 0;
+    while ( n < sizeof( buf) )
+        n += r.async_read( fd, buf + n, sizeof( buf) - n);
+    s.assign( buf, n);
+    r.remove( fd);
+    ::close( fd);
+}
+
+void f7( coro::reactor & r, int fd, boost::system::error_code & ec)
+{
+    char buf[16];
+    r.async_read( fd, buf, sizeof( buf), ec);
+}
+
+void f8( coro::reactor & r, int fd)
+{
+    X x;
+    char buf[16];
+    r.async_read( fd, buf, sizeof( buf) );
+}
+
+void f9( boost::scoped_ptr< coro::reactor > & r)
+{
+    coro::this_coroutine::yield();
+    // unwinds the task waiting in async_read()
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+    r.reset();
+}
+
+void f10( coro::reactor & r, int fd, boost::system::error_code & ec1,
+          boost::system::error_code & ec2, std::size_t & n)
+{
+    char buf[16];
+    r.async_read( fd, buf, sizeof( buf),
+                  coro::reactor::clock_type::now() + boost::chrono::milliseconds( 10), ec1);
+    // completes before the deadline
+    n = r.async_read( fd, buf, sizeof( buf),
+                      coro::reactor::clock_type::now() + boost::chrono::seconds( 10), ec2);
+}
+
+void f11( int fd)
+{
+    coro::this_coroutine::sleep_for( boost::chrono::milliseconds( 30) );
+    BOOST_REQUIRE( 3 == ::write( fd, "abc", 3) );
+}
+
+void f12( coro::reactor & r, int out_fd, int in_fd, std::size_t & n)
+{
+    n = r.async_sendfile( out_fd, in_fd, 1000, 4 * 1024 * 1024);
+    ::shutdown( out_fd, SHUT_WR);
+}
+
+// socket -> pipe1 -> socket, duplicated to pipe2
+void f13( coro::reactor & r, int in_fd, int * pipe1, int * pipe2, int out_fd)
+{
+    std::size_t n = 0;
+    while ( 0 != ( n = r.async_splice( in_fd, pipe1[1], 7) ) )
+    {
+        BOOST_CHECK_EQUAL( n, r.async_tee( pipe1[0], pipe2[1], n) );
+        while ( 0 < n)
+            n -= r.async_splice( pipe1[0], out_fd, n);
+    }
+    ::shutdown( out_fd, SHUT_WR);
+    r.remove( pipe2[1]);
+    ::close( pipe2[1]);
+}
+
+void test_read_write()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::string in( "abcdefghijklmnopqrstuvwxyz0123456789"), out;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        r.add( fds[0]);
+        r.add( fds[1]);
+        sched.spawn( boost::bind( f1, boost::ref( r), fds[0], boost::ref( out) ) );
+        sched.spawn( boost::bind( f2, boost::ref( r), fds[1], boost::cref( in) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+        BOOST_CHECK( r.empty() );
+    }
+    BOOST_CHECK_EQUAL( in, out);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_backpressure()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::size_t written = 0, read = 0;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        r.add( fds[0]);
+        r.add( fds[1]);
+        sched.spawn( boost::bind( f3, boost::ref( r), fds[1], boost::ref( written) ) );
+        sched.spawn( boost::bind( f4, boost::ref( r), fds[0], boost::ref( read) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( ( std::size_t) 4 * 1024 * 1024, written);
+    BOOST_CHECK_EQUAL( written, read);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_accept_connect()
+{
+    int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != lfd);
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    BOOST_REQUIRE( 0 == ::bind( lfd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) );
+    socklen_t len = sizeof( addr);
+    BOOST_REQUIRE( 0 == ::getsockname( lfd, reinterpret_cast< sockaddr * >( & addr), & len) );
+    BOOST_REQUIRE( 0 == ::listen( lfd, 1) );
+    std::string s;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        r.add( lfd);
+        sched.spawn( boost::bind( f5, boost::ref( r), lfd) );
+        sched.spawn( boost::bind( f6, boost::ref( r), boost::cref( addr), boost::ref( s) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( std::string("abc"), s);
+    ::close( lfd);
+}
+
+void test_remove()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    boost::system::error_code ec;
+    coro::scheduler sched;
+    coro::reactor r( sched);
+    r.add( fds[0]);
+    sched.spawn( boost::bind( f7, boost::ref( r), fds[0], boost::ref( ec) ) );
+    // the reading task suspends first, remove() resumes it
+    sched.spawn( boost::bind( & coro::reactor::remove, boost::ref( r), fds[0]) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( r.empty() );
+    BOOST_CHECK_EQUAL( ECANCELED, ec.value() );
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    coro::scheduler sched;
+    boost::scoped_ptr< coro::reactor > r( new coro::reactor( sched) );
+    r->add( fds[0]);
+    sched.spawn( boost::bind( f8, boost::ref( * r), fds[0]) );
+    sched.spawn( boost::bind( f9, boost::ref( r) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( 0 == sched.poller() );
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_timeout()
+{
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    boost::system::error_code ec1, ec2;
+    std::size_t n = 0;
+    coro::scheduler sched;
+    coro::reactor r( sched);
+    r.add( fds[0]);
+    sched.spawn( boost::bind( f10, boost::ref( r), fds[0], boost::ref( ec1),
+                              boost::ref( ec2), boost::ref( n) ) );
+    sched.spawn( boost::bind( f11, fds[1]) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( r.empty() );
+    BOOST_CHECK_EQUAL( ETIMEDOUT, ec1.value() );
+    BOOST_CHECK( ! ec2);
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, n);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+void test_sendfile()
+{
+    char path[] = "/tmp/test_reactor_XXXXXX";
+    int fd = ::mkstemp( path);
+    BOOST_REQUIRE( -1 != fd);
+    ::unlink( path);
+    std::string in( 1024 * 1024, 'x');
+    for ( std::size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast< char >( 'a' + i % 26);
+    BOOST_REQUIRE( static_cast< ssize_t >( in.size() ) == ::write( fd, in.data(), in.size() ) );
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    std::string out;
+    std::size_t n = 0;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        r.add( fds[0]);
+        r.add( fds[1]);
+        // larger than the socket buffer - the sender suspends
+        sched.spawn( boost::bind( f12, boost::ref( r), fds[1], fd, boost::ref( n) ) );
+        sched.spawn( boost::bind( f1, boost::ref( r), fds[0], boost::ref( out) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    // stops at end of file
+    BOOST_CHECK_EQUAL( in.size() - 1000, n);
+    BOOST_CHECK( in.substr( 1000) == out);
+    ::close( fds[0]);
+    ::close( fds[1]);
+    ::close( fd);
+}
+
+void test_splice_tee()
+{
+    int in[2], out[2], pipe1[2], pipe2[2];
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, in) );
+    BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, out) );
+    BOOST_REQUIRE( 0 == ::pipe( pipe1) );
+    BOOST_REQUIRE( 0 == ::pipe( pipe2) );
+    std::string s( "abcdefghijklmnopqrstuvwxyz0123456789"), s1, s2;
+    {
+        coro::scheduler sched;
+        coro::reactor r( sched);
+        int fds[] = { in[0], in[1], out[0], out[1], pipe1[0], pipe1[1], pipe2[0], pipe2[1] };
+        for ( std::size_t i = 0; i < sizeof( fds) / sizeof( fds[0]); ++i)
+            r.add( fds[i]);
+        sched.spawn( boost::bind( f2, boost::ref( r), in[1], boost::cref( s) ) );
+        sched.spawn( boost::bind( f13, boost::ref( r), in[0], pipe1, pipe2, out[1]) );
+        sched.spawn( boost::bind( f1, boost::ref( r), out[0], boost::ref( s1) ) );
+        sched.spawn( boost::bind( f1, boost::ref( r), pipe2[0], boost::ref( s2) ) );
+        sched.run();
+        BOOST_CHECK( sched.empty() );
+    }
+    BOOST_CHECK_EQUAL( s, s1);
+    BOOST_CHECK_EQUAL( s, s2);
+    ::close( in[0]);
+    ::close( in[1]);
+    ::close( out[0]);
+    ::close( out[1]);
+    ::close( pipe1[0]);
+    ::close( pipe1[1]);
+    ::close( pipe2[0]);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: reactor test suite");
+
+    test->add( BOOST_TEST_CASE( & test_read_write) );
+    test->add( BOOST_TEST_CASE( & test_backpressure) );
+    test->add( BOOST_TEST_CASE( & test_accept_connect) );
+    test->add( BOOST_TEST_CASE( & test_remove) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+    test->add( BOOST_TEST_CASE( & test_timeout) );
+    test->add( BOOST_TEST_CASE( & test_sendfile) );
+    test->add( BOOST_TEST_CASE( & test_splice_tee) );
+
+    return test;
+}
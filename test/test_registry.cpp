@@ -0,0 +1,174 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <signal.h>
+}
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/registry.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+
+namespace coro = boost::coroutines;
+
+std::vector< coro::coroutine_info > infos;
+
+void f1( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    char buf[4096];
+    buf[0] = 1;
+    c( buf[0]);
+    c( 2);
+}
+
+void f2( coro::symmetric_coroutine< void >::yield_type &)
+{}
+
+void f3()
+{
+    coro::this_coroutine::label("worker");
+    coro::this_coroutine::yield();
+}
+
+void f4()
+{
+    // f3 is suspended
+    infos = coro::registry::snapshot();
+}
+
+void test_disabled()
+{
+    BOOST_CHECK( ! coro::registry::enabled() );
+    coro::asymmetric_coroutine< int >::pull_type c( f1);
+    BOOST_CHECK( coro::registry::snapshot().empty() );
+}
+
+void test_asymmetric()
+{
+    coro::registry::enable();
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1);
+        c.label("parser");
+        std::vector< coro::coroutine_info > v( coro::registry::snapshot() );
+        // the push_type passed to f1 is not a coroutine of its own
+        BOOST_REQUIRE_EQUAL( ( std::size_t) 1, v.size() );
+        BOOST_CHECK_EQUAL( coro::coroutine_info::pull, v[0].kind);
+        BOOST_CHECK( v[0].started);
+        BOOST_CHECK( ! v[0].running);
+        BOOST_CHECK( ! v[0].complete);
+        BOOST_CHECK_EQUAL( std::string("parser"), v[0].label);
+        BOOST_CHECK( 0 != v[0].stack);
+        BOOST_CHECK( 0 < v[0].stack_size);
+        BOOST_CHECK( v[0].stack_used <= v[0].stack_size);
+        BOOST_CHECK( v[0].created <= boost::chrono::steady_clock::now() );
+        while ( c) c();
+        v = coro::registry::snapshot();
+        BOOST_REQUIRE_EQUAL( ( std::size_t) 1, v.size() );
+        BOOST_CHECK( v[0].complete);
+    }
+    // unlinked by the destruction
+    BOOST_CHECK( coro::registry::snapshot().empty() );
+    coro::registry::disable();
+}
+
+void test_symmetric()
+{
+    coro::registry::enable();
+    {
+        coro::symmetric_coroutine< void >::call_type c( f2);
+        std::vector< coro::coroutine_info > v( coro::registry::snapshot() );
+        BOOST_REQUIRE_EQUAL( ( std::size_t) 1, v.size() );
+        BOOST_CHECK_EQUAL( coro::coroutine_info::symmetric, v[0].kind);
+        BOOST_CHECK( ! v[0].started);
+    }
+    BOOST_CHECK( coro::registry::snapshot().empty() );
+    coro::registry::disable();
+}
+
+void test_tasks()
+{
+    infos.clear();
+    coro::registry::enable();
+    {
+        coro::scheduler sched;
+        sched.spawn( f3);
+        sched.spawn( f4);
+        sched.run();
+    }
+    coro::registry::disable();
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 2, infos.size() );
+    // oldest first
+    BOOST_CHECK_EQUAL( coro::coroutine_info::task, infos[0].kind);
+    BOOST_CHECK_EQUAL( std::string("worker"), infos[0].label);
+    BOOST_CHECK( infos[0].started && ! infos[0].running);
+    BOOST_CHECK( 0 < infos[0].stack_used);
+    BOOST_CHECK( infos[1].running);
+    BOOST_CHECK( infos[0].created <= infos[1].created);
+    BOOST_CHECK( coro::registry::snapshot().empty() );
+}
+
+void run( coro::asymmetric_coroutine< int >::pull_type * & c)
+{ c = new coro::asymmetric_coroutine< int >::pull_type( f1); }
+
+void test_threads()
+{
+    coro::registry::enable();
+    coro::asymmetric_coroutine< int >::pull_type * c1 = 0, * c2 = 0;
+    boost::thread t1( run, boost::ref( c1) ), t2( run, boost::ref( c2) );
+    t1.join();
+    t2.join();
+    std::vector< coro::coroutine_info > v( coro::registry::snapshot() );
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 2, v.size() );
+    BOOST_CHECK( v[0].thread != v[1].thread);
+    // destroyed by another thread
+    delete c1;
+    delete c2;
+    BOOST_CHECK( coro::registry::snapshot().empty() );
+    coro::registry::disable();
+}
+
+void test_dump()
+{
+    coro::registry::enable();
+    coro::asymmetric_coroutine< int >::pull_type c( f1);
+    c.label("parser");
+    std::ostringstream os;
+    coro::registry::dump( os);
+    std::string s( os.str() );
+    BOOST_CHECK_EQUAL( std::string("live coroutines: 1,"), s.substr( 0, 19) );
+    BOOST_CHECK( std::string::npos != s.find("suspended") );
+    BOOST_CHECK( std::string::npos != s.find("parser") );
+    // the summary goes to stderr
+    coro::registry::dump_on_signal( SIGUSR1);
+    BOOST_CHECK_EQUAL( 0, ::raise( SIGUSR1) );
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 50) );
+    coro::registry::disable();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: registry test suite");
+
+    test->add( BOOST_TEST_CASE( & test_disabled) );
+    test->add( BOOST_TEST_CASE( & test_asymmetric) );
+    test->add( BOOST_TEST_CASE( & test_symmetric) );
+    test->add( BOOST_TEST_CASE( & test_tasks) );
+    test->add( BOOST_TEST_CASE( & test_threads) );
+    test->add( BOOST_TEST_CASE( & test_dump) );
+
+    return test;
+}
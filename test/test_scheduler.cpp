@@ -0,0 +1,570 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/barrier.hpp>
+#include <boost/coroutine/coroutine_condition_variable.hpp>
+#include <boost/coroutine/coroutine_mutex.hpp>
+#include <boost/coroutine/counting_semaphore.hpp>
+#include <boost/coroutine/latch.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/task_group.hpp>
+#include <boost/coroutine/wait_group.hpp>
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+std::string value2 = "";
+
+struct X : private boost::noncopyable
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void f1( std::string & s, char c)
+{
+    for ( int i = 0; i < 3; ++i)
+    {
+        s += c;
+        coro::this_coroutine::yield();
+    }
+}
+
+void f2( coro::coroutine_mutex & mtx, std::vector< int > & v, int id)
+{
+    boost::unique_lock< coro::coroutine_mutex > lk( mtx);
+    v.push_back( id);
+    // holding the mutex across a suspension
+    coro::this_coroutine::yield();
+    v.push_back( id);
+}
+
+void f3( coro::coroutine_mutex & mtx, coro::coroutine_condition_variable & cond, bool & ready)
+{
+    boost::unique_lock< coro::coroutine_mutex > lk( mtx);
+    while ( ! ready)
+        cond.wait( lk);
+    ++value1;
+}
+
+void f4( coro::coroutine_mutex & mtx, coro::coroutine_condition_variable & cond, bool & ready)
+{
+    coro::this_coroutine::yield();
+    boost::unique_lock< coro::coroutine_mutex > lk( mtx);
+    ready = true;
+    cond.notify_all();
+}
+
+void f5( coro::counting_semaphore & sem, std::vector< int > & v, int id)
+{
+    sem.acquire();
+    v.push_back( id);
+}
+
+void f6( coro::counting_semaphore & sem)
+{
+    X x;
+    sem.acquire();
+}
+
+void f7()
+{ throw std::runtime_error("abc"); }
+
+void f8( coro::wait_group & wg, std::vector< int > & v, int id)
+{
+    for ( int i = 0; i < id; ++i)
+        coro::this_coroutine::yield();
+    v.push_back( id);
+    wg.done();
+}
+
+void f9( coro::wait_group & wg, std::vector< int > & v)
+{
+    coro::scheduler * sched = coro::scheduler::instance();
+    for ( int i = 3; 0 < i; --i)
+    {
+        wg.add();
+        sched->spawn( boost::bind( f8, boost::ref( wg), boost::ref( v), i) );
+    }
+    wg.wait();
+    v.push_back( 0);
+}
+
+void f10( coro::latch & l, std::vector< int > & v, int id)
+{
+    l.arrive_and_wait();
+    v.push_back( id);
+}
+
+void f11( coro::barrier & b, std::vector< int > & v, int id)
+{
+    for ( int i = 0; i < 2; ++i)
+    {
+        v.push_back( id);
+        if ( b.arrive_and_wait() ) v.push_back( -1);
+    }
+}
+
+void f12( coro::counting_semaphore & sem, int & n)
+{
+    X x;
+    ++n;
+    sem.acquire();
+    ++n;
+}
+
+void f13( std::vector< int > & v, int id)
+{
+    v.push_back( id);
+    coro::this_coroutine::yield();
+    if ( 0 == id) throw std::runtime_error("abc");
+    coro::this_coroutine::yield();
+    v.push_back( id);
+}
+
+void f14( std::vector< int > & v, bool & thrown)
+{
+    coro::task_group tg;
+    for ( int i = 0; i < 3; ++i)
+        tg.spawn( boost::bind( f13, boost::ref( v), i) );
+    try
+    { tg.wait(); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    BOOST_CHECK( tg.is_cancelled() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, tg.size() );
+}
+
+void f15( int & n)
+{
+    for (;;)
+    {
+        ++n;
+        coro::this_coroutine::yield();
+    }
+}
+
+void f16( int & n, bool & requested)
+{
+    coro::task_group tg;
+    tg.cancel_after( boost::chrono::milliseconds( 10) );
+    tg.spawn( boost::bind( f15, boost::ref( n) ) );
+    tg.wait();
+    requested = coro::this_coroutine::cancellation_requested();
+}
+
+void f17( std::vector< int > & v, int id, int ms)
+{
+    coro::this_coroutine::sleep_for( boost::chrono::milliseconds( ms) );
+    v.push_back( id);
+}
+
+void f18()
+{
+    X x;
+    coro::this_coroutine::sleep_for( boost::chrono::hours( 1) );
+}
+
+void f19( coro::latch & l, std::vector< int > & v, bool & waiting)
+{
+    // the other two tasks wait at the latch
+    waiting = v.empty() && ! l.try_wait() && 3 == coro::scheduler::instance()->size();
+    f10( l, v, 2);
+}
+
+void f20( coro::wait_group & wg, int & n)
+{
+    coro::this_coroutine::yield();
+    ++n;
+    wg.done();
+}
+
+void f21( coro::wait_group & wg, int & n, int & joined)
+{
+    wg.wait();
+    joined = n;
+}
+
+void f22( coro::barrier & b, boost::atomic< int > & arrived,
+          boost::atomic< int > & completed, boost::atomic< int > & errors)
+{
+    for ( int i = 1; i <= 1000; ++i)
+    {
+        arrived.fetch_add( 1);
+        if ( b.arrive_and_wait() ) completed.fetch_add( 1);
+        // every participant arrived before the phase completed
+        if ( arrived.load() < 4 * i) errors.fetch_add( 1);
+    }
+}
+
+void f23( int & n)
+{
+    for ( int i = 0; i < 200; ++i)
+    {
+        // the completing thread must not touch the objects after the
+        // joiner was released
+        coro::wait_group * wg = new coro::wait_group( 1);
+        boost::thread t( boost::bind( & coro::wait_group::done, wg) );
+        wg->wait();
+        delete wg;
+        coro::latch * l = new coro::latch( 1);
+        boost::thread u( boost::bind( & coro::latch::count_down, l, 1) );
+        l->wait();
+        delete l;
+        t.join();
+        u.join();
+        ++n;
+    }
+}
+
+// children of a joiner on another thread
+void run_children( coro::wait_group & wg, int & n)
+{
+    coro::scheduler sched;
+    for ( int i = 0; i < 100; ++i)
+        sched.spawn( boost::bind( f20, boost::ref( wg), boost::ref( n) ) );
+    sched.run();
+}
+
+void run_barrier( coro::barrier & b, boost::atomic< int > & arrived,
+                  boost::atomic< int > & completed, boost::atomic< int > & errors)
+{
+    coro::scheduler sched;
+    for ( int i = 0; i < 2; ++i)
+        sched.spawn( boost::bind( f22, boost::ref( b), boost::ref( arrived),
+                                  boost::ref( completed), boost::ref( errors) ) );
+    sched.run();
+}
+
+void expired( coro::detail::timer_node * n)
+{ n->fn = 0; }
+
+void test_yield()
+{
+    value2 = "";
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f1, boost::ref( value2), 'a') );
+    sched.spawn( boost::bind( f1, boost::ref( value2), 'b') );
+    BOOST_CHECK_EQUAL( ( std::size_t) 2, sched.size() );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( std::string("ababab"), value2);
+}
+
+void test_mutex()
+{
+    coro::coroutine_mutex mtx;
+    std::vector< int > v;
+    coro::scheduler sched;
+    for ( int i = 0; i < 3; ++i)
+        sched.spawn( boost::bind( f2, boost::ref( mtx), boost::ref( v), i) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    // mutual exclusion and FIFO hand-off
+    int expected[] = { 0, 0, 1, 1, 2, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 6);
+}
+
+void test_condition_variable()
+{
+    value1 = 0;
+    coro::coroutine_mutex mtx;
+    coro::coroutine_condition_variable cond;
+    bool ready = false;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f3, boost::ref( mtx), boost::ref( cond), boost::ref( ready) ) );
+    sched.spawn( boost::bind( f3, boost::ref( mtx), boost::ref( cond), boost::ref( ready) ) );
+    sched.spawn( boost::bind( f4, boost::ref( mtx), boost::ref( cond), boost::ref( ready) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( int) 2, value1);
+}
+
+void test_semaphore()
+{
+    coro::counting_semaphore sem( 1);
+    std::vector< int > v;
+    coro::scheduler sched;
+    for ( int i = 0; i < 3; ++i)
+        sched.spawn( boost::bind( f5, boost::ref( sem), boost::ref( v), i) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( std::size_t) 1, v.size() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 2, sched.size() );
+    sem.release( 2);
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, sem.value() );
+    int expected[] = { 0, 1, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    coro::counting_semaphore sem;
+    {
+        coro::scheduler sched;
+        sched.spawn( boost::bind( f6, boost::ref( sem) ) );
+        sched.run();
+        BOOST_CHECK_EQUAL( ( std::size_t) 1, sched.size() );
+        BOOST_CHECK_EQUAL( ( int) 7, value1);
+    }
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+}
+
+void test_exceptions()
+{
+    bool thrown = false;
+    coro::scheduler sched;
+    sched.spawn( f7);
+    try
+    { sched.run(); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    BOOST_CHECK( thrown);
+    BOOST_CHECK( sched.empty() );
+}
+
+void test_wait_group()
+{
+    coro::wait_group wg;
+    std::vector< int > v;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f9, boost::ref( wg), boost::ref( v) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, wg.count() );
+    // the joiner runs after the last child
+    int expected[] = { 1, 2, 3, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 4);
+}
+
+void test_wait_group_threads()
+{
+    coro::wait_group wg( 100);
+    int n = 0, joined = -1;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f21, boost::ref( wg), boost::ref( n), boost::ref( joined) ) );
+    boost::thread t( run_children, boost::ref( wg), boost::ref( n) );
+    // does not return before the joiner was woken from the other thread
+    sched.run();
+    t.join();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( 100, joined);
+}
+
+void test_destroy_after_wait()
+{
+    int n = 0;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f23, boost::ref( n) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( 200, n);
+}
+
+void test_latch()
+{
+    coro::latch l( 3);
+    std::vector< int > v;
+    bool waiting = false;
+    coro::scheduler sched;
+    for ( int i = 0; i < 2; ++i)
+        sched.spawn( boost::bind( f10, boost::ref( l), boost::ref( v), i) );
+    sched.spawn( boost::bind( f19, boost::ref( l), boost::ref( v), boost::ref( waiting) ) );
+    sched.run();
+    BOOST_CHECK( waiting);
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( l.try_wait() );
+    int expected[] = { 2, 0, 1 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_barrier()
+{
+    coro::barrier b( 3);
+    std::vector< int > v;
+    coro::scheduler sched;
+    for ( int i = 0; i < 3; ++i)
+        sched.spawn( boost::bind( f11, boost::ref( b), boost::ref( v), i) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    // two phases, the last arriving task completes each
+    int expected[] = { 0, 1, 2, -1, 2, 0, 1, -1 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 8);
+}
+
+void test_barrier_threads()
+{
+    coro::barrier b( 4);
+    boost::atomic< int > arrived( 0), completed( 0), errors( 0);
+    // two tasks on each of two schedulers
+    boost::thread t( run_barrier, boost::ref( b), boost::ref( arrived),
+                     boost::ref( completed), boost::ref( errors) );
+    run_barrier( b, arrived, completed, errors);
+    t.join();
+    BOOST_CHECK_EQUAL( 4000, arrived.load() );
+    BOOST_CHECK_EQUAL( 1000, completed.load() );
+    BOOST_CHECK_EQUAL( 0, errors.load() );
+}
+
+void test_task_group_cancel()
+{
+    value1 = 0;
+    int n = 0;
+    coro::counting_semaphore sem;
+    coro::scheduler sched;
+    coro::task_group tg( sched);
+    for ( int i = 0; i < 3; ++i)
+        tg.spawn( boost::bind( f12, boost::ref( sem), boost::ref( n) ) );
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, tg.size() );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+    // all children unwound in one pass
+    tg.cancel();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, tg.size() );
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    // spawning on a cancelled group is ignored
+    tg.spawn( boost::bind( f12, boost::ref( sem), boost::ref( n) ) );
+    BOOST_CHECK( sched.empty() );
+}
+
+void test_task_group_exception()
+{
+    bool thrown = false;
+    std::vector< int > v;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f14, boost::ref( v), boost::ref( thrown) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( thrown);
+    // the siblings never reach their second step
+    int expected[] = { 0, 1, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_task_group_deadline()
+{
+    int n = 0;
+    bool requested = true;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f16, boost::ref( n), boost::ref( requested) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( 0 < n);
+    // the cancellation does not propagate to the parent
+    BOOST_CHECK( ! requested);
+}
+
+void test_sleep()
+{
+    std::vector< int > v;
+    coro::scheduler sched;
+    coro::scheduler::clock_type::time_point start( coro::scheduler::clock_type::now() );
+    sched.spawn( boost::bind( f17, boost::ref( v), 0, 30) );
+    sched.spawn( boost::bind( f17, boost::ref( v), 1, 10) );
+    sched.spawn( boost::bind( f17, boost::ref( v), 2, 20) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK( start + boost::chrono::milliseconds( 30) <= coro::scheduler::clock_type::now() );
+    int expected[] = { 1, 2, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_sleep_unwind()
+{
+    value1 = 0;
+    coro::scheduler sched;
+    coro::task_group tg( sched);
+    tg.spawn( boost::bind( f18) );
+    tg.cancel_after( boost::chrono::milliseconds( 10) );
+    // unwinding the sleeping task removes its deadline
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+}
+
+void test_timer_queue()
+{
+    typedef coro::detail::clock_type clock_type;
+    // deadlines spread over all levels of the wheel
+    std::vector< coro::detail::timer_node > nodes( 20000);
+    coro::detail::timer_queue q;
+    clock_type::time_point start( clock_type::now() );
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        nodes[i].deadline = start + boost::chrono::milliseconds( ( i * i * 7919) % 100000000);
+        nodes[i].fn = & expired;
+        q.push( & nodes[i]);
+    }
+    for ( std::size_t i = 0; i < nodes.size(); i += 3)
+        q.erase( & nodes[i]);
+    BOOST_CHECK_EQUAL( nodes.size() - ( nodes.size() + 2) / 3, q.size() );
+    // advance in growing steps; no node fires early or is missed
+    for ( clock_type::time_point now( start); ! q.empty(); now += ( now - start) / 2 + boost::chrono::milliseconds( 1) )
+    {
+        clock_type::time_point earliest( clock_type::time_point::max() );
+        for ( std::size_t i = 0; i < nodes.size(); ++i)
+            if ( nodes[i].is_linked() && nodes[i].deadline < earliest) earliest = nodes[i].deadline;
+        BOOST_CHECK( q.deadline() < earliest + boost::chrono::microseconds( BOOST_COROUTINES_TIMER_RESOLUTION_US) );
+        q.expire( now);
+        for ( std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if ( 0 == i % 3) continue;
+            bool due = nodes[i].deadline <= now;
+            bool fired = 0 == nodes[i].fn;
+            if ( fired && ! due) BOOST_FAIL("timer expired early");
+            if ( due && ! fired &&
+                 nodes[i].deadline + boost::chrono::microseconds( BOOST_COROUTINES_TIMER_RESOLUTION_US) <= now)
+                BOOST_FAIL("timer not expired");
+        }
+    }
+    for ( std::size_t i = 0; i < nodes.size(); ++i)
+        BOOST_CHECK( ( 0 == i % 3) == ( 0 != nodes[i].fn) );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: scheduler test suite");
+
+    test->add( BOOST_TEST_CASE( & test_yield) );
+    test->add( BOOST_TEST_CASE( & test_mutex) );
+    test->add( BOOST_TEST_CASE( & test_condition_variable) );
+    test->add( BOOST_TEST_CASE( & test_semaphore) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+    test->add( BOOST_TEST_CASE( & test_exceptions) );
+    test->add( BOOST_TEST_CASE( & test_wait_group) );
+    test->add( BOOST_TEST_CASE( & test_wait_group_threads) );
+    test->add( BOOST_TEST_CASE( & test_destroy_after_wait) );
+    test->add( BOOST_TEST_CASE( & test_latch) );
+    test->add( BOOST_TEST_CASE( & test_barrier) );
+    test->add( BOOST_TEST_CASE( & test_barrier_threads) );
+    test->add( BOOST_TEST_CASE( & test_task_group_cancel) );
+    test->add( BOOST_TEST_CASE( & test_task_group_exception) );
+    test->add( BOOST_TEST_CASE( & test_task_group_deadline) );
+    test->add( BOOST_TEST_CASE( & test_sleep) );
+    test->add( BOOST_TEST_CASE( & test_sleep_unwind) );
+    test->add( BOOST_TEST_CASE( & test_timer_queue) );
+
+    return test;
+}
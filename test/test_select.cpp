@@ -0,0 +1,224 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/channel.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/select.hpp>
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+coro::channel_op_status value2 = coro::channel_op_success;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void f1( coro::channel< int > & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL( coro::channel_op_success, ch.push( i) );
+    ch.close();
+}
+
+void f2( coro::channel< int > & ch, std::vector< int > & v)
+{
+    int i = 0;
+    while ( coro::channel_op_success == ch.pop( i) )
+        v.push_back( i);
+}
+
+void f3( coro::channel< int > & ch1, coro::channel< int > & ch2, std::vector< int > & v)
+{
+    int i = 0, j = 0;
+    for (;;)
+    {
+        coro::select sel;
+        std::size_t c1 = sel.pop( ch1, i);
+        std::size_t c2 = sel.pop( ch2, j);
+        std::size_t idx = sel.wait();
+        if ( coro::channel_op_closed == sel.status() ) return;
+        if ( c1 == idx) v.push_back( i);
+        else if ( c2 == idx) v.push_back( 100 + j);
+    }
+}
+
+void f4( coro::channel< int > & ch, int i)
+{ ch.push( i); }
+
+void f5( coro::channel< int > & ch)
+{
+    int i = 0;
+    coro::select sel;
+    sel.pop( ch, i);
+    std::size_t t = sel.timeout( boost::chrono::milliseconds( 10) );
+    value1 = sel.wait() == t ? 1 : 0;
+    value2 = sel.status();
+}
+
+void f6( coro::channel< int > & ch1, coro::channel< int > & ch2)
+{
+    int i = 0, j = 7;
+    coro::select sel;
+    sel.push( ch1, j);
+    sel.pop( ch2, i);
+    sel.timeout( boost::chrono::seconds( 60) );
+    value1 = static_cast< int >( sel.wait() );
+    value2 = sel.status();
+}
+
+void f7( coro::channel< int > & ch, int & i)
+{
+    coro::this_coroutine::yield();
+    ch.pop( i);
+}
+
+void f8( coro::channel< int > & ch1, coro::channel< int > & ch2)
+{
+    X x;
+    int i = 0, j = 7;
+    coro::select sel;
+    sel.push( ch1, j);
+    sel.pop( ch2, i);
+    sel.wait();
+}
+
+void test_channel()
+{
+    coro::channel< int > ch( 2);
+    std::vector< int > v;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f1, boost::ref( ch), 5) );
+    sched.spawn( boost::bind( f2, boost::ref( ch), boost::ref( v) ) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    int expected[] = { 0, 1, 2, 3, 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 5);
+}
+
+void test_channel_rendezvous()
+{
+    coro::channel< int > ch;
+    std::vector< int > v;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f2, boost::ref( ch), boost::ref( v) ) );
+    sched.spawn( boost::bind( f1, boost::ref( ch), 3) );
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    int expected[] = { 0, 1, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_try_ops()
+{
+    coro::channel< int > ch( 1);
+    int i = 0;
+    BOOST_CHECK_EQUAL( coro::channel_op_empty, ch.try_pop( i) );
+    BOOST_CHECK_EQUAL( coro::channel_op_success, ch.try_push( 1) );
+    BOOST_CHECK_EQUAL( coro::channel_op_full, ch.try_push( 2) );
+    ch.close();
+    BOOST_CHECK_EQUAL( coro::channel_op_closed, ch.try_push( 3) );
+    BOOST_CHECK_EQUAL( coro::channel_op_success, ch.try_pop( i) );
+    BOOST_CHECK_EQUAL( 1, i);
+    BOOST_CHECK_EQUAL( coro::channel_op_closed, ch.try_pop( i) );
+}
+
+void test_select()
+{
+    coro::channel< int > ch1, ch2;
+    std::vector< int > v;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f3, boost::ref( ch1), boost::ref( ch2), boost::ref( v) ) );
+    sched.spawn( boost::bind( f4, boost::ref( ch2), 1) );
+    sched.spawn( boost::bind( f4, boost::ref( ch1), 2) );
+    sched.spawn( boost::bind( f4, boost::ref( ch2), 3) );
+    sched.run();
+    BOOST_CHECK_EQUAL( ( std::size_t) 1, sched.size() );
+    ch1.close();
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    int expected[] = { 101, 2, 103 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( v.begin(), v.end(), expected, expected + 3);
+}
+
+void test_select_timeout()
+{
+    value1 = 0;
+    value2 = coro::channel_op_success;
+    coro::channel< int > ch;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f5, boost::ref( ch) ) );
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    sched.run();
+    BOOST_CHECK( boost::chrono::milliseconds( 10) <= boost::chrono::steady_clock::now() - start);
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( 1, value1);
+    BOOST_CHECK_EQUAL( coro::channel_op_timeout, value2);
+    // the timed out pop case has been unlinked
+    BOOST_CHECK_EQUAL( coro::channel_op_full, ch.try_push( 1) );
+}
+
+void test_select_cancel()
+{
+    value1 = -1;
+    value2 = coro::channel_op_timeout;
+    int i = 0;
+    coro::channel< int > ch1, ch2;
+    coro::scheduler sched;
+    sched.spawn( boost::bind( f6, boost::ref( ch1), boost::ref( ch2) ) );
+    sched.spawn( boost::bind( f7, boost::ref( ch1), boost::ref( i) ) );
+    // returns without waiting for the deadline of f6
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( 7, i);
+    BOOST_CHECK_EQUAL( 0, value1);
+    BOOST_CHECK_EQUAL( coro::channel_op_success, value2);
+    // the other cases have been unlinked
+    BOOST_CHECK_EQUAL( coro::channel_op_full, ch2.try_push( 1) );
+}
+
+void test_select_unwind()
+{
+    value1 = 0;
+    coro::channel< int > ch1, ch2;
+    {
+        coro::scheduler sched;
+        sched.spawn( boost::bind( f8, boost::ref( ch1), boost::ref( ch2) ) );
+        sched.run();
+        BOOST_CHECK_EQUAL( ( std::size_t) 1, sched.size() );
+        BOOST_CHECK_EQUAL( 7, value1);
+    }
+    BOOST_CHECK_EQUAL( 0, value1);
+    // the cases of the unwound select have been unlinked
+    int i = 0;
+    BOOST_CHECK_EQUAL( coro::channel_op_empty, ch1.try_pop( i) );
+    BOOST_CHECK_EQUAL( coro::channel_op_full, ch2.try_push( 1) );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: select test suite");
+
+    test->add( BOOST_TEST_CASE( & test_channel) );
+    test->add( BOOST_TEST_CASE( & test_channel_rendezvous) );
+    test->add( BOOST_TEST_CASE( & test_try_ops) );
+    test->add( BOOST_TEST_CASE( & test_select) );
+    test->add( BOOST_TEST_CASE( & test_select_timeout) );
+    test->add( BOOST_TEST_CASE( & test_select_cancel) );
+    test->add( BOOST_TEST_CASE( & test_select_unwind) );
+
+    return test;
+}
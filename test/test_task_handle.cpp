@@ -0,0 +1,218 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/task_group.hpp>
+#include <boost/coroutine/task_handle.hpp>
+
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+extern "C" {
+#include <unistd.h>
+}
+
+#include <boost/coroutine/reactor.hpp>
+#endif
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+int value2 = 0;
+boost::thread::id value3;
+boost::thread * resumer = 0;
+std::vector< coro::task_handle > handles;
+
+struct X
+{
+    X() { value1 = 7; }
+    ~X() { value1 = 0; }
+};
+
+void resume_later( coro::task_handle h)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10) );
+    coro::resume_on_owner( h);
+}
+
+void resume_all()
+{
+    for ( std::size_t i = 0; i < handles.size(); ++i)
+        coro::resume_on_owner( handles[i]);
+}
+
+void start_later( coro::task_handle h)
+{ resumer = new boost::thread( resume_later, h); }
+
+void push( coro::task_handle h)
+{
+    handles.push_back( h);
+    // the last task starts the resuming thread
+    if ( 100 == handles.size() ) resumer = new boost::thread( resume_all);
+}
+
+void f1()
+{
+    coro::this_coroutine::suspend_until_resumed( start_later);
+    value1 = 1;
+    value3 = boost::this_thread::get_id();
+}
+
+void f2( int & n)
+{
+    // keeps running while the other task is suspended
+    for ( int i = 0; i < 3; ++i)
+    {
+        ++n;
+        coro::this_coroutine::yield();
+    }
+}
+
+void f3()
+{
+    // resumed before the suspension
+    coro::this_coroutine::suspend_until_resumed( coro::resume_on_owner);
+    value1 = 2;
+}
+
+void f4()
+{
+    coro::this_coroutine::suspend_until_resumed( push);
+    ++value2;
+}
+
+void f5()
+{
+    X x;
+    coro::this_coroutine::suspend_until_resumed( start_later);
+    value2 = 1;
+}
+
+void f6()
+{
+    coro::task_group g;
+    g.spawn( f5);
+    g.cancel_after( boost::chrono::milliseconds( 1) );
+    g.wait();
+}
+
+void join_resumer()
+{
+    resumer->join();
+    delete resumer;
+    resumer = 0;
+}
+
+void test_remote()
+{
+    value1 = 0;
+    int n = 0;
+    coro::scheduler sched;
+    sched.spawn( f1);
+    sched.spawn( boost::bind( f2, boost::ref( n) ) );
+    // returns not before the suspended task is complete
+    sched.run();
+    join_resumer();
+    BOOST_CHECK_EQUAL( ( int) 1, value1);
+    BOOST_CHECK_EQUAL( ( int) 3, n);
+    // resumed on the thread of its scheduler
+    BOOST_CHECK( boost::this_thread::get_id() == value3);
+}
+
+void test_inline()
+{
+    value1 = 0;
+    coro::scheduler sched;
+    sched.spawn( f3);
+    sched.run();
+    BOOST_CHECK( sched.empty() );
+    BOOST_CHECK_EQUAL( ( int) 2, value1);
+}
+
+void test_many()
+{
+    value2 = 0;
+    handles.clear();
+    coro::scheduler sched;
+    for ( int i = 0; i < 100; ++i)
+        sched.spawn( f4);
+    sched.run();
+    join_resumer();
+    BOOST_CHECK_EQUAL( ( int) 100, value2);
+}
+
+void test_unwind()
+{
+    value1 = 0;
+    value2 = 0;
+    coro::scheduler sched;
+    sched.spawn( f6);
+    // the cancelled task waits for its resumption before its stack
+    // is unwound
+    sched.run();
+    join_resumer();
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK_EQUAL( ( int) 0, value2);
+}
+
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+void f7( coro::reactor & r, int fd)
+{
+    char c = 0;
+    r.async_read( fd, & c, 1);
+    value2 = c;
+}
+
+void f8( int fd)
+{
+    coro::this_coroutine::suspend_until_resumed( start_later);
+    value1 = 1;
+    BOOST_CHECK_EQUAL( 1, ::write( fd, "x", 1) );
+}
+
+void test_reactor()
+{
+    value1 = 0;
+    value2 = 0;
+    int fds[2];
+    BOOST_CHECK_EQUAL( 0, ::pipe( fds) );
+    coro::scheduler sched;
+    coro::reactor r( sched);
+    r.add( fds[0]);
+    sched.spawn( boost::bind( f7, boost::ref( r), fds[0]) );
+    sched.spawn( boost::bind( f8, fds[1]) );
+    // the reader blocks the scheduler in epoll_wait(), the
+    // resumption interrupts it
+    sched.run();
+    join_resumer();
+    BOOST_CHECK_EQUAL( ( int) 1, value1);
+    BOOST_CHECK_EQUAL( ( int) 'x', value2);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: task_handle test suite");
+
+    test->add( BOOST_TEST_CASE( & test_remote) );
+    test->add( BOOST_TEST_CASE( & test_inline) );
+    test->add( BOOST_TEST_CASE( & test_many) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+#if defined(BOOST_COROUTINES_HAS_EPOLL)
+    test->add( BOOST_TEST_CASE( & test_reactor) );
+#endif
+
+    return test;
+}
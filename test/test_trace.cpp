@@ -0,0 +1,113 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+#include <string>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/trace.hpp>
+
+namespace coro = boost::coroutines;
+
+std::size_t count( std::string const& s, std::string const& what)
+{
+    std::size_t n = 0;
+    for ( std::string::size_type i = s.find( what); std::string::npos != i; i = s.find( what, i + 1) )
+        ++n;
+    return n;
+}
+
+std::string dump()
+{
+    std::ostringstream os;
+    coro::trace::write_chrome_json( os);
+    return os.str();
+}
+
+void f1()
+{
+    for ( int i = 0; i < 3; ++i)
+        coro::this_coroutine::yield();
+}
+
+void run()
+{
+    coro::scheduler sched;
+    sched.spawn( f1);
+    sched.spawn( f1);
+    sched.run();
+}
+
+void test_disabled()
+{
+    coro::trace::clear();
+    BOOST_CHECK( ! coro::trace::enabled() );
+    run();
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, count( dump(), "\"ph\":\"X\"") );
+}
+
+void test_events()
+{
+    coro::trace::clear();
+    coro::trace::start();
+    BOOST_CHECK( coro::trace::enabled() );
+    run();
+    coro::trace::stop();
+    std::string s = dump();
+    // each task is resumed 4 times
+    BOOST_CHECK_EQUAL( ( std::size_t) 8, count( s, "\"ph\":\"X\"") );
+    BOOST_CHECK_EQUAL( ( std::size_t) 2, count( s, "\"name\":\"create\"") );
+    BOOST_CHECK_EQUAL( ( std::size_t) 2, count( s, "\"name\":\"complete\"") );
+    BOOST_CHECK_EQUAL( std::string("{\"displayTimeUnit\""), s.substr( 0, 18) );
+    BOOST_CHECK_EQUAL( std::string("]}\n"), s.substr( s.size() - 3) );
+    // discarded
+    coro::trace::clear();
+    BOOST_CHECK_EQUAL( ( std::size_t) 0, count( dump(), "\"ph\":\"X\"") );
+}
+
+void test_threads()
+{
+    coro::trace::clear();
+    coro::trace::start();
+    boost::thread t1( run), t2( run);
+    t1.join();
+    t2.join();
+    coro::trace::stop();
+    std::string s = dump();
+    BOOST_CHECK_EQUAL( ( std::size_t) 16, count( s, "\"ph\":\"X\"") );
+    // the buffers of terminated threads are kept
+    BOOST_CHECK( 3 <= count( s, "\"name\":\"thread_name\"") );
+}
+
+void test_wrap()
+{
+    coro::trace::clear();
+    coro::trace::start();
+    for ( int i = 0; i < 2000; ++i)
+        run();
+    coro::trace::stop();
+    std::string s = dump();
+    // only the most recent records are kept
+    std::size_t n = count( s, "\"ph\":\"X\"");
+    BOOST_CHECK( 0 < n);
+    BOOST_CHECK( n < 2000 * 8);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: trace test suite");
+
+    test->add( BOOST_TEST_CASE( & test_disabled) );
+    test->add( BOOST_TEST_CASE( & test_events) );
+    test->add( BOOST_TEST_CASE( & test_threads) );
+    test->add( BOOST_TEST_CASE( & test_wrap) );
+
+    return test;
+}
@@ -0,0 +1,174 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/symmetric_coroutine.hpp>
+#include <boost/coroutine/unwind.hpp>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) )
+# define ENTRY_FRAME
+# include <unwind.h>
+#endif
+
+namespace coro = boost::coroutines;
+
+// built with frame pointers
+
+#if defined(ENTRY_FRAME)
+struct walk
+{
+    // frames within the coroutine stack
+    std::size_t frames;
+    // the chain ended with a null frame pointer inside the stack
+    bool        terminated;
+    // the frame of the resumer was reached
+    bool        linked;
+    // _Unwind_Backtrace() reached the end of the stack
+    bool        end_of_stack;
+    std::size_t dwarf_frames;
+
+    walk() :
+        frames( 0), terminated( false), linked( false),
+        end_of_stack( false), dwarf_frames( 0)
+    {}
+};
+
+walk result;
+void * resumer = 0;
+
+_Unwind_Reason_Code count_frame( _Unwind_Context *, void * n)
+{
+    ++( * static_cast< std::size_t * >( n) );
+    return _URC_NO_REASON;
+}
+
+BOOST_NOINLINE void inspect()
+{
+    coro::detail::coroutine_context * ctx = coro::detail::coroutine_context::active();
+    BOOST_REQUIRE( 0 != ctx);
+    char * top = static_cast< char * >( ctx->stack_ctx().sp);
+    char * bottom = top - ctx->stack_ctx().size;
+
+    walk w;
+    void ** fp = static_cast< void ** >( __builtin_frame_address( 0) );
+    for ( std::size_t i = 0; i < 64; ++i)
+    {
+        if ( reinterpret_cast< char * >( fp) < bottom || reinterpret_cast< char * >( fp) >= top)
+        {
+            // left the coroutine stack (only through the parent link):
+            // followed up to the frame of resume()
+            for ( std::size_t j = 0; j < 8 && 0 != fp && ! w.linked; ++j)
+            {
+                w.linked = fp == resumer;
+                fp = static_cast< void ** >( fp[0]);
+            }
+            break;
+        }
+        ++w.frames;
+        void ** next = static_cast< void ** >( fp[0]);
+        if ( 0 == next)
+        {
+            w.terminated = 0 == fp[1];
+            break;
+        }
+        fp = next;
+    }
+    w.end_of_stack = _URC_END_OF_STACK == _Unwind_Backtrace( count_frame, & w.dwarf_frames);
+    result = w;
+}
+
+void pull_fn( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    inspect();
+    c();
+    inspect();
+}
+
+void task_fn()
+{ inspect(); }
+
+void symmetric_fn( coro::symmetric_coroutine< void >::yield_type &)
+{ inspect(); }
+
+BOOST_NOINLINE void resume( coro::asymmetric_coroutine< void >::pull_type & source)
+{
+    resumer = __builtin_frame_address( 0);
+    source();
+}
+
+void test_clean_root()
+{
+    BOOST_CHECK( ! coro::unwind::parent_linked() );
+    // inspect() takes the bounds of the stack from the active context
+    coro::detail::coroutine_context::track_active( true);
+
+    result = walk();
+    coro::asymmetric_coroutine< void >::pull_type source( pull_fn);
+    BOOST_CHECK( 0 < result.frames);
+    BOOST_CHECK( result.terminated);
+    BOOST_CHECK( result.end_of_stack);
+    BOOST_CHECK( result.dwarf_frames < 32);
+
+    // resumed: still ends within the coroutine stack
+    result = walk();
+    resume( source);
+    BOOST_CHECK( result.terminated);
+    BOOST_CHECK( ! result.linked);
+    BOOST_CHECK( result.end_of_stack);
+
+    result = walk();
+    coro::symmetric_coroutine< void >::call_type other( symmetric_fn);
+    other();
+    BOOST_CHECK( result.terminated);
+    BOOST_CHECK( result.end_of_stack);
+
+    result = walk();
+    coro::scheduler sched;
+    sched.spawn( task_fn);
+    sched.run();
+    BOOST_CHECK( result.terminated);
+    BOOST_CHECK( result.end_of_stack);
+
+    coro::detail::coroutine_context::track_active( false);
+}
+
+void test_parent_link()
+{
+    coro::unwind::link_parent( true);
+    BOOST_CHECK( coro::unwind::parent_linked() );
+    coro::detail::coroutine_context::track_active( true);
+
+    coro::asymmetric_coroutine< void >::pull_type source( pull_fn);
+    result = walk();
+    resume( source);
+    BOOST_CHECK( 0 < result.frames);
+    BOOST_CHECK( ! result.terminated);
+    BOOST_CHECK( result.linked);
+    // DWARF unwinders keep the clean root
+    BOOST_CHECK( result.end_of_stack);
+
+    coro::detail::coroutine_context::track_active( false);
+    coro::unwind::link_parent( false);
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: unwind test suite");
+
+#if defined(ENTRY_FRAME)
+    test->add( BOOST_TEST_CASE( & test_clean_root) );
+    test->add( BOOST_TEST_CASE( & test_parent_link) );
+#endif
+
+    return test;
+}
@@ -0,0 +1,193 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/registry.hpp>
+#include <boost/coroutine/scheduler.hpp>
+#include <boost/coroutine/watchdog.hpp>
+
+namespace coro = boost::coroutines;
+
+// built with frame pointers and exported symbols (-rdynamic)
+
+std::vector< coro::coroutine_stall > reported;
+
+void collect( coro::coroutine_stall const& stall)
+{ reported.push_back( stall); }
+
+volatile unsigned long sink = 0;
+
+BOOST_NOINLINE void spin( int ms)
+{
+    std::clock_t end = std::clock() + ms * ( CLOCKS_PER_SEC / 1000);
+    while ( std::clock() < end)
+        for ( int i = 0; i < 1000; ++i)
+            sink = sink + i;
+}
+
+BOOST_NOINLINE void busy( int ms)
+{
+    spin( ms);
+    sink = sink + 1;
+}
+
+void stalling( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    // labeled after the first suspension
+    c();
+    busy( 300);
+}
+
+void cooperative( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    for ( int i = 0; i < 60; ++i)
+    {
+        spin( 5);
+        c();
+    }
+}
+
+void task( int ms)
+{
+    coro::this_coroutine::label( "task");
+    busy( ms);
+}
+
+void values( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    for ( int i = 0; i < 3; ++i)
+        c( i);
+}
+
+// stalls after it has used a generator
+void nesting()
+{
+    coro::this_coroutine::label( "nesting");
+    coro::asymmetric_coroutine< int >::pull_type source( values);
+    while ( source)
+        source();
+    busy( 300);
+}
+
+bool has_frame( coro::coroutine_stall const& stall, std::string const& name)
+{
+    for ( std::size_t i = 0; i < stall.frames.size(); ++i)
+        if ( std::string::npos != stall.frames[i].find( name) ) return true;
+    return false;
+}
+
+void test_stall()
+{
+    reported.clear();
+    std::size_t n = coro::watchdog::stalls();
+    coro::watchdog::start( boost::chrono::milliseconds( 50), collect);
+    BOOST_CHECK( coro::watchdog::running() );
+    {
+        coro::asymmetric_coroutine< void >::pull_type source( stalling);
+        source.label("stalling");
+        source();
+    }
+    coro::watchdog::stop();
+    BOOST_CHECK( ! coro::watchdog::running() );
+
+    // reported once per stall
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 1, reported.size() );
+    BOOST_CHECK_EQUAL( n + 1, coro::watchdog::stalls() );
+    coro::coroutine_stall const& stall = reported[0];
+    BOOST_CHECK( 0 != stall.coroutine);
+    BOOST_CHECK_EQUAL( std::string("stalling"), stall.label);
+    BOOST_CHECK( 50 <= stall.held.count() );
+    // spin() may be skipped - interrupted in a leaf without frame pointer
+    BOOST_CHECK( has_frame( stall, "busy") );
+    BOOST_CHECK( has_frame( stall, "stalling") );
+}
+
+void test_task()
+{
+    reported.clear();
+    coro::watchdog::start( boost::chrono::milliseconds( 50), collect);
+    {
+        coro::scheduler sched;
+        sched.spawn( boost::bind( task, 300) );
+        sched.run();
+    }
+    coro::watchdog::stop();
+
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 1, reported.size() );
+    BOOST_CHECK_EQUAL( std::string("task"), reported[0].label);
+    BOOST_CHECK( has_frame( reported[0], "busy") );
+}
+
+void test_nested()
+{
+    reported.clear();
+    coro::watchdog::start( boost::chrono::milliseconds( 50), collect);
+    {
+        coro::scheduler sched;
+        sched.spawn( nesting);
+        sched.run();
+    }
+    coro::watchdog::stop();
+
+    // the task holds the thread again once the generator suspended
+    BOOST_REQUIRE_EQUAL( ( std::size_t) 1, reported.size() );
+    BOOST_CHECK_EQUAL( std::string("nesting"), reported[0].label);
+    BOOST_CHECK( 50 <= reported[0].held.count() );
+    BOOST_CHECK( has_frame( reported[0], "busy") );
+}
+
+void test_no_stall()
+{
+    reported.clear();
+    coro::watchdog::start( boost::chrono::milliseconds( 50), collect);
+    {
+        // suspends every few milliseconds
+        coro::asymmetric_coroutine< void >::pull_type source( cooperative);
+        while ( source)
+            source();
+    }
+    // outside of coroutines
+    spin( 200);
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 100) );
+    coro::watchdog::stop();
+
+    BOOST_CHECK( reported.empty() );
+}
+
+void test_not_running()
+{
+    reported.clear();
+    std::size_t n = coro::watchdog::stalls();
+    {
+        coro::asymmetric_coroutine< void >::pull_type source( stalling);
+        source();
+    }
+    BOOST_CHECK( reported.empty() );
+    BOOST_CHECK_EQUAL( n, coro::watchdog::stalls() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: watchdog test suite");
+
+    test->add( BOOST_TEST_CASE( & test_stall) );
+    test->add( BOOST_TEST_CASE( & test_task) );
+    test->add( BOOST_TEST_CASE( & test_nested) );
+    test->add( BOOST_TEST_CASE( & test_no_stall) );
+    test->add( BOOST_TEST_CASE( & test_not_running) );
+
+    return test;
+}